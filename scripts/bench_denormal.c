@@ -0,0 +1,49 @@
+// bench_denormal.c - time the engine on a subnormal tail, natively
+//
+// Built against the engine sources by make bench-denormal / build-c.sh
+// --bench-denormal, always with -DCONV_NO_SILENCE_GATING so subnormal blocks
+// are processed instead of skipped, and once more with
+// -DCONV_NO_DENORMAL_PROTECTION. Each build runs benchmark_denormal_decay() on
+// one IR type and prints how much slower a callback gets once the signal is
+// subnormal: about 1 with the protection, the cost of subnormal arithmetic on
+// this machine without it.
+//
+// Usage: bench_denormal [type] [sample_rate]
+//        (default: hall 48000)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "denormal.h"
+#include "sample_type.h"
+
+// Engine entry points (see wasm_bridge.c)
+void init_convolution_engine_(int* sr);
+void set_param_float_(int* param_id, float* value);
+void set_ir_type_(char* ir_type_str, int ir_type_len);
+double benchmark_denormal_decay(void);
+
+int main(int argc, char** argv) {
+    char* type = argc > 1 ? argv[1] : "hall";
+    int sample_rate = argc > 2 ? atoi(argv[2]) : 48000;
+    if (sample_rate <= 0) {
+        fprintf(stderr, "bench_denormal: bad sample rate %s\n", argv[2]);
+        return 1;
+    }
+
+    // The engine logs to stdout, which is not ours to fill
+    if (!freopen("/dev/null", "w", stdout)) return 1;
+
+    init_convolution_engine_(&sample_rate);
+    int mix_id = 6;
+    float wet = 100.0f;
+    set_param_float_(&mix_id, &wet);
+    set_ir_type_(type, (int)strlen(type));
+
+    double ratio = benchmark_denormal_decay();
+
+    fprintf(stderr, "%s @ %d Hz, %s, denormal protection %s: subnormal/normal callback time %.2f\n",
+            type, sample_rate, CONV_PRECISION_NAME, DENORMAL_PROTECTION ? "on " : "off", ratio);
+    return 0;
+}
@@ -1,7 +1,7 @@
 #!/bin/bash
 
 # build-c.sh - Simplified build script for C-only WebAssembly compilation
-# Usage: ./build-c.sh [--deploy] [--force]
+# Usage: ./build-c.sh [--deploy] [--force] [--float32] [--threads] [--no-codelets] [--simd] [--no-default-irs] [--bench-denormal]
 
 set -e
 
@@ -23,6 +23,12 @@ NC='\033[0m' # No Color
 # Parse command line arguments
 DEPLOY=false
 FORCE_BUILD=false
+PRECISION_FLAGS=""
+THREAD_FLAGS=""
+CODELETS=true
+SIMD_FLAGS=""
+DEFAULT_IRS=true
+BENCH_DENORMAL=false
 
 while [[ $# -gt 0 ]]; do
     case $1 in
@@ -34,12 +40,42 @@ while [[ $# -gt 0 ]]; do
             FORCE_BUILD=true
             shift
             ;;
+        --float32)
+            PRECISION_FLAGS="-DCONV_FLOAT32"
+            shift
+            ;;
+        --threads)
+            THREAD_FLAGS="-DCONV_THREADS -pthread -s PTHREAD_POOL_SIZE=4"
+            shift
+            ;;
+        --no-codelets)
+            CODELETS=false
+            shift
+            ;;
+        --simd)
+            SIMD_FLAGS="-msimd128"
+            shift
+            ;;
+        --no-default-irs)
+            DEFAULT_IRS=false
+            shift
+            ;;
+        --bench-denormal)
+            BENCH_DENORMAL=true
+            shift
+            ;;
         --help)
-            echo "Usage: $0 [--deploy] [--force]"
+            echo "Usage: $0 [--deploy] [--force] [--float32] [--threads] [--no-codelets] [--simd] [--no-default-irs] [--bench-denormal]"
             echo ""
             echo "Options:"
             echo "  --deploy  Deploy to server after building"
             echo "  --force   Force rebuild even if artifacts exist"
+            echo "  --float32 Build the float32 engine variant (float spectra and FFTs)"
+            echo "  --threads Run tail partitions on pthreads (needs cross-origin isolation)"
+            echo "  --no-codelets Use the generic FFT passes instead of generated codelets"
+            echo "  --simd    Build with WebAssembly SIMD (vectorized modal engine)"
+            echo "  --no-default-irs Synthesize the default IRs at startup instead of building them in"
+            echo "  --bench-denormal Time the engine on subnormals with and without denormal protection (native, no build)"
             echo "  --help    Show this help message"
             exit 0
             ;;
@@ -121,20 +157,46 @@ compile_wasm() {
 EMBEDDED_C_CODE
     fi
     
+    # Straight-line FFT kernels for the small butterfly stages
+    CODELET_FLAGS=""
+    if [ "$CODELETS" = true ]; then
+        print_message $BLUE "Generating FFT codelets..."
+        mkdir -p "$BUILD_DIR/generated"
+        python3 "$SCRIPT_DIR/gen_fft_codelets.py" -o "$BUILD_DIR/generated/fft_codelets.h"
+        CODELET_FLAGS="-DHAVE_FFT_CODELETS -I$BUILD_DIR/generated"
+    fi
+    
+    # Default IRs synthesized by a native build of the engine, linked in as data
+    DEFAULT_IR_FLAGS=""
+    if [ "$DEFAULT_IRS" = true ]; then
+        print_message $BLUE "Generating default impulse responses..."
+        mkdir -p "$BUILD_DIR/generated"
+        ${HOST_CC:-cc} -O2 -I"$SRC_DIR/c" "$SCRIPT_DIR/gen_default_irs.c" \
+            "$SRC_DIR/c/convolution_engine.c" "$SRC_DIR/c/arena.c" "$SRC_DIR/c/fft.c" \
+            "$SRC_DIR/c/fft_convolver.c" "$SRC_DIR/c/tail_stage.c" "$SRC_DIR/c/multirate_tail.c" \
+            "$SRC_DIR/c/fdn_tail.c" "$SRC_DIR/c/modal_bank.c" "$SRC_DIR/c/velvet_tail.c" \
+            "$SRC_DIR/c/wisdom.c" "$SRC_DIR/c/ir_cache.c" -lm -o "$BUILD_DIR/generated/gen_default_irs"
+        "$BUILD_DIR/generated/gen_default_irs" -o "$BUILD_DIR/generated/default_irs.h"
+        DEFAULT_IR_FLAGS="-DHAVE_DEFAULT_IRS -I$BUILD_DIR/generated"
+    fi
+    
     # Compile with Emscripten
     print_message $BLUE "Compiling with Emscripten..."
     
     emcc "$SRC_DIR/c/wasm_bridge.c" "$SRC_DIR/c/convolution_engine.c" \
-        -I"$SRC_DIR/c" \
+        "$SRC_DIR/c/arena.c" "$SRC_DIR/c/fft.c" "$SRC_DIR/c/fft_convolver.c" \
+        "$SRC_DIR/c/tail_stage.c" "$SRC_DIR/c/multirate_tail.c" "$SRC_DIR/c/fdn_tail.c" \
+        "$SRC_DIR/c/modal_bank.c" "$SRC_DIR/c/velvet_tail.c" "$SRC_DIR/c/wisdom.c" "$SRC_DIR/c/ir_cache.c" \
+        -I"$SRC_DIR/c" $PRECISION_FLAGS $THREAD_FLAGS $CODELET_FLAGS $SIMD_FLAGS $DEFAULT_IR_FLAGS \
         -s WASM=1 \
-        -s EXPORTED_FUNCTIONS='["_init_engine","_process_audio","_set_parameter","_set_ir_type","_cleanup_engine","_allocate_double_array","_free_double_array","_is_initialized","_get_sample_rate","_get_version","_process_audio_with_mix"]' \
+        -s EXPORTED_FUNCTIONS='["_init_engine","_init_engine_async","_continue_init","_get_init_progress","_process_audio","_set_parameter","_set_ir_type","_cleanup_engine","_allocate_double_array","_free_double_array","_is_initialized","_get_sample_rate","_get_version","_process_audio_with_mix","_get_ir_length","_get_effective_ir_length","_get_tail_samples","_get_memory_usage","_process_audio_f32","_allocate_float_array","_free_float_array","_get_input_buffer","_get_output_buffer","_get_io_buffer_frames","_process_io_buffers","_calibrate_partitions","_get_wisdom_buffer","_get_wisdom_capacity","_save_wisdom","_load_wisdom","_get_ir_cache_key","_get_ir_cache_buffer","_reserve_ir_cache","_save_ir_cache","_load_ir_cache","_get_ir_upload_buffer","_get_ir_upload_capacity","_begin_ir_samples","_append_ir_samples","_load_ir_samples"]' \
         -s EXPORTED_RUNTIME_METHODS='["ccall","cwrap","stringToUTF8","UTF8ToString"]' \
         -s ALLOW_MEMORY_GROWTH=1 \
-        -s INITIAL_MEMORY=33554432 \
+        -s INITIAL_MEMORY=16777216 \
         -s MAXIMUM_MEMORY=2147483648 \
         -s MODULARIZE=1 \
         -s EXPORT_NAME='ConvolutionModule' \
-        -s ENVIRONMENT='web' \
+        -s ENVIRONMENT='web,worker' \
         -s SINGLE_FILE=0 \
         -O3 \
         -o "$BUILD_DIR/convolution_reverb.js" 2>&1 | tee "$BUILD_DIR/compile.log"
@@ -161,6 +223,9 @@ copy_web_files() {
     cp "$SRC_DIR/js/convolution-module.js" "$BUILD_DIR/"
     cp "$SRC_DIR/js/audio-processor.js" "$BUILD_DIR/"
     [ -f "$SRC_DIR/js/convolution-worklet.js" ] && cp "$SRC_DIR/js/convolution-worklet.js" "$BUILD_DIR/"
+    cp "$SRC_DIR/js/sab-ring-buffer.js" "$BUILD_DIR/"
+    cp "$SRC_DIR/js/convolution-dsp-worker.js" "$BUILD_DIR/"
+    cp "$SRC_DIR/js/convolution-warm-worker.js" "$BUILD_DIR/"
     
     # Setup audio directory
     mkdir -p "$BUILD_DIR/audio"
@@ -334,6 +399,26 @@ deploy_to_server() {
     print_message $CYAN "  🧪 https://convolution.musicsian.com/test.html"
 }
 
+# Native benchmark of the denormal protection (scripts/bench_denormal.c): the
+# engine built with and without it, silence gating off in both
+bench_denormal() {
+    print_message $BLUE "=== Denormal Protection Benchmark ==="
+    mkdir -p "$BUILD_DIR/bench"
+    
+    local flags="-O2 -I$SRC_DIR/c -DCONV_NO_SILENCE_GATING $PRECISION_FLAGS"
+    local sources="$SRC_DIR/c/convolution_engine.c $SRC_DIR/c/arena.c $SRC_DIR/c/fft.c \
+        $SRC_DIR/c/fft_convolver.c $SRC_DIR/c/tail_stage.c $SRC_DIR/c/multirate_tail.c \
+        $SRC_DIR/c/fdn_tail.c $SRC_DIR/c/modal_bank.c $SRC_DIR/c/velvet_tail.c \
+        $SRC_DIR/c/wisdom.c $SRC_DIR/c/ir_cache.c"
+    ${HOST_CC:-cc} $flags "$SCRIPT_DIR/bench_denormal.c" $sources -lm -o "$BUILD_DIR/bench/bench_denormal"
+    ${HOST_CC:-cc} $flags -DCONV_NO_DENORMAL_PROTECTION "$SCRIPT_DIR/bench_denormal.c" $sources \
+        -lm -o "$BUILD_DIR/bench/bench_denormal_unprotected"
+    
+    "$BUILD_DIR/bench/bench_denormal"
+    print_message $YELLOW "Without protection (takes about half a minute)..."
+    "$BUILD_DIR/bench/bench_denormal_unprotected"
+}
+
 # Main build process
 build_project() {
     print_message $BLUE "=== Convolution Reverb C Build ==="
@@ -356,6 +441,11 @@ build_project() {
 
 # Main entry point
 main() {
+    if [ "$BENCH_DENORMAL" = true ]; then
+        bench_denormal
+        exit 0
+    fi
+    
     if ! build_project; then
         exit 1
     fi
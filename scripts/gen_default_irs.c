@@ -0,0 +1,206 @@
+// gen_default_irs.c - synthesize the default IRs at build time
+//
+// Built natively against the engine sources and run by make / build-c.sh.
+// For each preset (IR type at a sample rate, at the default slider settings
+// of web/index.html) it runs the generator exactly as a freshly started
+// engine would and writes the result to default_irs.h as packed ir_cache
+// blobs. convolution_engine.c built with -DHAVE_DEFAULT_IRS publishes a
+// matching blob instead of synthesizing.
+//
+// Only the IR is stored, 16-bit block floating point (about half the size of
+// floats): the partition spectra depend on the block size and the measured
+// layout of the machine the engine runs on, and are rebuilt at load.
+//
+// Usage: gen_default_irs [-o default_irs.h] [type:rate ...]
+//        (default presets: hall:44100 hall:48000)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "ir_cache.h"
+
+// Engine entry points (see wasm_bridge.c)
+void init_convolution_engine_(int* sr);
+void set_param_float_(int* param_id, float* value);
+void set_ir_type_(char* ir_type_str, int ir_type_len);
+int  save_ir_cache_(void);
+unsigned char* get_ir_cache_buffer_(void);
+
+// convolution_engine.c's MAX_EARLY_TAPS and 2 * MAX_ER_SPREAD + 1
+#define MAX_EARLY_TAPS 64
+#define MAX_KERNEL     33
+
+// Slider defaults in web/index.html, in set_param_float_ ids, applied in the
+// order the app applies them
+static const struct {
+    int id;
+    float value;
+} default_parameters[] = {
+    { 0, 50.0f },   // roomSize
+    { 1, 2.5f },    // decayTime
+    { 2, 20.0f },   // preDelay
+    { 3, 50.0f },   // damping
+    { 4, 50.0f },   // lowFreq
+    { 5, 80.0f },   // diffusion
+    { 6, 30.0f },   // mix
+    { 7, 50.0f },   // earlyReflections
+};
+
+static const char* default_presets[] = { "hall:44100", "hall:48000" };
+
+// Run in a child process: the engine is one static instance whose random
+// state must start fresh for every preset. Writes the packed blob to fd
+static int synthesize(const char* type, int sample_rate, int fd) {
+    // The engine logs to stdout, which is not ours to fill
+    if (!freopen("/dev/null", "w", stdout)) return -1;
+
+    init_convolution_engine_(&sample_rate);
+    for (size_t i = 0; i < sizeof(default_parameters) / sizeof(default_parameters[0]); i++) {
+        int id = default_parameters[i].id;
+        float value = default_parameters[i].value;
+        set_param_float_(&id, &value);
+    }
+    set_ir_type_((char*)type, (int)strlen(type));
+
+    int size = save_ir_cache_();
+    IRCacheInfo info;
+    if (size <= 0 || ir_cache_parse(get_ir_cache_buffer_(), (size_t)size, &info) != 0) return -1;
+
+    double* ir = (double*)malloc(info.ir_length * sizeof(double));
+    double kernel[MAX_KERNEL];
+    IRCacheTap taps[MAX_EARLY_TAPS];
+    if (!ir || 2 * info.early_spread + 1 > MAX_KERNEL || info.num_early_taps > MAX_EARLY_TAPS) {
+        return -1;
+    }
+    ir_cache_read(get_ir_cache_buffer_(), &info, kernel, taps, ir);
+
+    // Repacked without spectra
+    info.packed = 1;
+    size_t bytes = ir_cache_bytes(&info, NULL);
+    unsigned char* blob = (unsigned char*)malloc(bytes);
+    if (!blob) return -1;
+    ir_cache_serialize(&info, kernel, taps, ir, NULL, blob);
+
+    for (size_t done = 0; done < bytes;) {
+        ssize_t written = write(fd, blob + done, bytes - done);
+        if (written <= 0) return -1;
+        done += (size_t)written;
+    }
+    return 0;
+}
+
+// Blob for one preset, or NULL
+static unsigned char* run_preset(const char* type, int sample_rate, size_t* size) {
+    int pipe_fd[2];
+    if (pipe(pipe_fd) != 0) return NULL;
+
+    fflush(NULL);
+    pid_t child = fork();
+    if (child < 0) return NULL;
+    if (child == 0) {
+        close(pipe_fd[0]);
+        _exit(synthesize(type, sample_rate, pipe_fd[1]) == 0 ? 0 : 1);
+    }
+    close(pipe_fd[1]);
+
+    size_t capacity = 1 << 20, length = 0;
+    unsigned char* blob = (unsigned char*)malloc(capacity);
+    for (;;) {
+        if (!blob) break;
+        if (length == capacity) {
+            capacity *= 2;
+            unsigned char* grown = (unsigned char*)realloc(blob, capacity);
+            if (!grown) {
+                free(blob);
+                blob = NULL;
+                break;
+            }
+            blob = grown;
+        }
+        ssize_t got = read(pipe_fd[0], blob + length, capacity - length);
+        if (got <= 0) break;
+        length += (size_t)got;
+    }
+    close(pipe_fd[0]);
+
+    int status = 0;
+    waitpid(child, &status, 0);
+    if (!blob || !WIFEXITED(status) || WEXITSTATUS(status) != 0 || length == 0) {
+        free(blob);
+        return NULL;
+    }
+    *size = length;
+    return blob;
+}
+
+int main(int argc, char** argv) {
+    const char* output = NULL;
+    const char** presets = default_presets;
+    int num_presets = sizeof(default_presets) / sizeof(default_presets[0]);
+
+    int first = 1;
+    if (argc > 2 && strcmp(argv[1], "-o") == 0) {
+        output = argv[2];
+        first = 3;
+    }
+    if (argc > first) {
+        presets = (const char**)(argv + first);
+        num_presets = argc - first;
+    }
+
+    FILE* out = output ? fopen(output, "w") : stdout;
+    if (!out) {
+        fprintf(stderr, "gen_default_irs: cannot write %s\n", output);
+        return 1;
+    }
+
+    fprintf(out, "// default_irs.h - generated by scripts/gen_default_irs.c, do not edit\n");
+    fprintf(out, "// Packed ir_cache blobs of the default IRs, see convolution_engine.c\n\n");
+
+    size_t total = 0;
+    for (int p = 0; p < num_presets; p++) {
+        char type[32];
+        int sample_rate = 0;
+        if (sscanf(presets[p], "%31[^:]:%d", type, &sample_rate) != 2 || sample_rate <= 0) {
+            fprintf(stderr, "gen_default_irs: bad preset '%s' (want type:rate)\n", presets[p]);
+            return 1;
+        }
+
+        size_t size = 0;
+        unsigned char* blob = run_preset(type, sample_rate, &size);
+        if (!blob) {
+            fprintf(stderr, "gen_default_irs: synthesis failed for %s\n", presets[p]);
+            return 1;
+        }
+
+        fprintf(out, "// %s at %d Hz\n", type, sample_rate);
+        fprintf(out, "static const unsigned char default_ir_%d[%zu] = {", p, size);
+        for (size_t i = 0; i < size; i++) {
+            fprintf(out, "%s0x%02x,", i % 16 == 0 ? "\n    " : "", blob[i]);
+        }
+        fprintf(out, "\n};\n\n");
+
+        fprintf(stderr, "  %s at %d Hz: %zu bytes\n", type, sample_rate, size);
+        total += size;
+        free(blob);
+    }
+
+    fprintf(out, "#define DEFAULT_IR_COUNT %d\n\n", num_presets);
+    fprintf(out, "static const unsigned char* const default_ir_data[DEFAULT_IR_COUNT] = {");
+    for (int p = 0; p < num_presets; p++) {
+        fprintf(out, "%s default_ir_%d", p ? "," : "", p);
+    }
+    fprintf(out, " };\n\n");
+    fprintf(out, "static const size_t default_ir_size[DEFAULT_IR_COUNT] = {");
+    for (int p = 0; p < num_presets; p++) {
+        fprintf(out, "%s sizeof(default_ir_%d)", p ? "," : "", p);
+    }
+    fprintf(out, " };\n");
+
+    if (output) fclose(out);
+    fprintf(stderr, "  %d default IRs, %zu bytes\n", num_presets, total);
+    return 0;
+}
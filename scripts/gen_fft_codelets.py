@@ -0,0 +1,131 @@
+#!/usr/bin/env python3
+"""gen_fft_codelets.py - generate straight-line FFT kernels for fft.c
+
+Writes fft_codelets.h: one fully unrolled complex radix-2 DIT FFT per
+power-of-two size from 2 up to --max-size, forward and inverse. Each codelet
+does exactly what the generic butterfly passes in fft.c do to one block of
+its size (input already in bit-reversed order, in place, unscaled), but with
+every loop unrolled, the data held in locals and every twiddle factor a
+literal - trivial ones (1, -i) turn into plain adds and swaps.
+
+fft.c runs the largest codelet that fits over each block of the half-length
+complex FFT, then finishes with the generic passes. Build with
+-DHAVE_FFT_CODELETS and the output directory on the include path; without
+them fft.c uses the generic passes alone.
+
+Usage: gen_fft_codelets.py [--max-size N] [-o fft_codelets.h]
+"""
+
+import argparse
+import math
+import sys
+
+
+def literal(value):
+    # repr() round-trips doubles exactly
+    if value == 0.0:
+        return "(conv_sample_t)0.0"
+    return "(conv_sample_t)%r" % value
+
+
+def butterfly(a, b, j, length, inverse):
+    """One DIT butterfly on locals a and b with twiddle e^(-+2*pi*i*j/length)."""
+    if j == 0:
+        tr, ti = "r%d" % b, "i%d" % b
+        twiddled = "conv_sample_t tr = %s, ti = %s;" % (tr, ti)
+    elif 4 * j == length:
+        # w = -i (forward) or +i (inverse)
+        if inverse:
+            twiddled = "conv_sample_t tr = -i%d, ti = r%d;" % (b, b)
+        else:
+            twiddled = "conv_sample_t tr = i%d, ti = -r%d;" % (b, b)
+    else:
+        angle = 2.0 * math.pi * j / length
+        wr = math.cos(angle)
+        wi = math.sin(angle) if inverse else -math.sin(angle)
+        twiddled = ("conv_sample_t tr = r%d * %s - i%d * %s, ti = r%d * %s + i%d * %s;"
+                    % (b, literal(wr), b, literal(wi), b, literal(wi), b, literal(wr)))
+
+    return ("    { %s r%d = r%d - tr; i%d = i%d - ti; r%d += tr; i%d += ti; }"
+            % (twiddled, b, a, b, a, a, a))
+
+
+def codelet(n, inverse):
+    name = "fft_codelet_%d_%s" % (n, "inverse" if inverse else "forward")
+    lines = ["static void %s(conv_sample_t* re, conv_sample_t* im) {" % name]
+
+    for k in range(n):
+        lines.append("    conv_sample_t r%d = re[%d], i%d = im[%d];" % (k, k, k, k))
+
+    length = 2
+    while length <= n:
+        half_length = length // 2
+        for start in range(0, n, length):
+            for j in range(half_length):
+                lines.append(butterfly(start + j, start + j + half_length, j, length, inverse))
+        length *= 2
+
+    for k in range(n):
+        lines.append("    re[%d] = r%d; im[%d] = i%d;" % (k, k, k, k))
+
+    lines.append("}")
+    return name, "\n".join(lines)
+
+
+def generate(max_size):
+    max_log2 = int(math.log2(max_size))
+    out = [
+        "// fft_codelets.h - generated by scripts/gen_fft_codelets.py, do not edit",
+        "// Straight-line radix-2 DIT kernels for blocks of 2 to %d points" % max_size,
+        "",
+        "#ifndef FFT_CODELETS_H",
+        "#define FFT_CODELETS_H",
+        "",
+        '#include "sample_type.h"',
+        "",
+        "#define FFT_CODELET_MAX_LOG2 %d" % max_log2,
+        "",
+        "typedef void (*FFTCodelet)(conv_sample_t* re, conv_sample_t* im);",
+        "",
+    ]
+
+    tables = {False: ["0"], True: ["0"]}
+    for log2 in range(1, max_log2 + 1):
+        for inverse in (False, True):
+            name, body = codelet(1 << log2, inverse)
+            out.append(body)
+            out.append("")
+            tables[inverse].append(name)
+
+    for inverse in (False, True):
+        out.append("// Indexed by log2 of the block size")
+        out.append("static const FFTCodelet fft_codelets_%s[FFT_CODELET_MAX_LOG2 + 1] = {"
+                   % ("inverse" if inverse else "forward"))
+        out.append("    " + ",\n    ".join(tables[inverse]))
+        out.append("};")
+        out.append("")
+
+    out.append("#endif // FFT_CODELETS_H")
+    return "\n".join(out) + "\n"
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Generate straight-line FFT codelets")
+    parser.add_argument("--max-size", type=int, default=32,
+                        help="largest codelet, a power of two >= 2 (default 32)")
+    parser.add_argument("-o", "--output", help="output file (default: stdout)")
+    args = parser.parse_args()
+
+    if args.max_size < 2 or args.max_size & (args.max_size - 1):
+        parser.error("--max-size must be a power of two >= 2")
+
+    source = generate(args.max_size)
+    if args.output:
+        with open(args.output, "w") as f:
+            f.write(source)
+    else:
+        sys.stdout.write(source)
+
+
+if __name__ == "__main__":
+    main()
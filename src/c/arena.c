@@ -0,0 +1,106 @@
+// arena.c
+// Aligned bump allocator backing all engine state
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "arena.h"
+
+#if defined(ARENA_MLOCK) && !defined(__EMSCRIPTEN__)
+#include <sys/mman.h>
+#endif
+
+int arena_init(Arena* arena, size_t size) {
+    if (arena_reserve(arena, size) != 0) {
+        return -1;
+    }
+    arena_prefault(arena, arena->size);
+    return 0;
+}
+
+int arena_reserve(Arena* arena, size_t size) {
+    memset(arena, 0, sizeof(Arena));
+
+    size = arena_round_up(size > 0 ? size : ARENA_ALIGNMENT);
+
+    arena->base = (unsigned char*)aligned_alloc(ARENA_ALIGNMENT, size);
+    if (!arena->base) {
+        return -1;
+    }
+    arena->size = size;
+    return 0;
+}
+
+size_t arena_prefault(Arena* arena, size_t max_bytes) {
+    size_t left = arena->size - arena->prefaulted;
+    size_t bytes = left < max_bytes ? left : max_bytes;
+
+    // Writing every byte faults the pages in now instead of on the audio thread
+    memset(arena->base + arena->prefaulted, 0, bytes);
+    arena->prefaulted += bytes;
+
+#if defined(ARENA_MLOCK) && !defined(__EMSCRIPTEN__)
+    // Best effort: RLIMIT_MEMLOCK may refuse, the arena still works unlocked
+    if (bytes > 0 && arena->prefaulted == arena->size) {
+        arena->locked = mlock(arena->base, arena->size) == 0;
+    }
+#endif
+
+    return arena->size - arena->prefaulted;
+}
+
+void arena_free(Arena* arena) {
+#if defined(ARENA_MLOCK) && !defined(__EMSCRIPTEN__)
+    if (arena->locked) {
+        munlock(arena->base, arena->size);
+    }
+#endif
+    free(arena->base);
+    memset(arena, 0, sizeof(Arena));
+}
+
+void* arena_alloc(Arena* arena, size_t bytes) {
+    bytes = arena_round_up(bytes);
+    if (!arena->base || bytes > arena->size - arena->used) {
+        return NULL;
+    }
+
+    unsigned char* ptr = arena->base + arena->used;
+    size_t clean = arena->cleared > arena->used ? arena->cleared - arena->used : 0;
+    arena->used += bytes;
+
+    // Rewound regions still hold old data
+    if (clean < bytes) {
+        memset(ptr + clean, 0, bytes - clean);
+    }
+    return ptr;
+}
+
+void arena_rewind(Arena* arena, size_t mark) {
+    if (mark <= arena->used) {
+        arena->used = mark;
+        arena->cleared = mark;
+    }
+}
+
+int arena_seek(Arena* arena, size_t mark) {
+    if (mark < arena->used || mark > arena->size) {
+        return -1;
+    }
+    arena->used = mark;
+    return 0;
+}
+
+size_t arena_clear_ahead(Arena* arena, size_t bytes, size_t max_bytes) {
+    size_t left = arena->size - arena->used;
+    size_t end = arena->used + (bytes < left ? bytes : left);
+    size_t from = arena->cleared > arena->used ? arena->cleared : arena->used;
+    if (from >= end) {
+        return 0;
+    }
+
+    size_t count = end - from < max_bytes ? end - from : max_bytes;
+    memset(arena->base + from, 0, count);
+    arena->cleared = from + count;
+    return end - arena->cleared;
+}
@@ -0,0 +1,65 @@
+// arena.h
+// One aligned block holding every per-instance buffer of the engine
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Every allocation starts on a cache line, which also satisfies any SIMD width
+#define ARENA_ALIGNMENT 64
+
+// Bytes an allocation of count elements of type takes inside an arena
+#define ARENA_BYTES(count, type) arena_round_up((size_t)(count) * sizeof(type))
+
+// Bump allocator over a single block. Memory is handed out in order and only
+// returned all at once (arena_rewind / arena_free), so the audio thread never
+// calls into the system allocator. Native builds touch every page up front and
+// lock the block in RAM when compiled with -DARENA_MLOCK.
+typedef struct {
+    unsigned char* base;
+    size_t size;        // Bytes reserved
+    size_t used;        // Bytes handed out
+    size_t prefaulted;  // Bytes from base already written once
+    size_t cleared;     // [used, cleared) is known to be zero (arena_clear_ahead)
+    int locked;         // Pages are mlock()ed
+} Arena;
+
+static inline size_t arena_round_up(size_t bytes) {
+    return (bytes + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1);
+}
+
+// Reserve and prefault size bytes. Returns 0 on success, -1 on allocation failure
+int  arena_init(Arena* arena, size_t size);
+void arena_free(Arena* arena);
+
+// arena_init in installments: arena_reserve only allocates, then each
+// arena_prefault call faults in up to max_bytes more. Returns the bytes still
+// to prefault; the block is locked once the last one is in
+int    arena_reserve(Arena* arena, size_t size);
+size_t arena_prefault(Arena* arena, size_t max_bytes);
+
+// Zeroed, ARENA_ALIGNMENT-aligned memory, or NULL when the arena is full
+void* arena_alloc(Arena* arena, size_t bytes);
+
+// Hand everything allocated after a mark back (contents are not cleared)
+static inline size_t arena_mark(const Arena* arena) { return arena->used; }
+void arena_rewind(Arena* arena, size_t mark);
+
+// Allocate from a later mark on, leaving the bytes before it as they are.
+// Returns 0, or -1 if the mark lies before the last allocation or past the end
+int  arena_seek(Arena* arena, size_t mark);
+
+// Zero up to max_bytes more of the next bytes past the last allocation, so
+// allocations there need not clear them again. Returns the bytes still to zero
+size_t arena_clear_ahead(Arena* arena, size_t bytes, size_t max_bytes);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ARENA_H
@@ -7,11 +7,33 @@
 #include <string.h>
 #include <stdio.h>
 #include <stdint.h>
+#include <time.h>
+#include <limits.h>
+#include <float.h>
+
+#ifdef __EMSCRIPTEN__
+#include <emscripten.h>
+#endif
+
+#include "arena.h"
+#include "denormal.h"
+#include "fft_convolver.h"
+#include "tail_stage.h"
+#include "multirate_tail.h"
+#include "fdn_tail.h"
+#include "velvet_tail.h"
+#include "modal_bank.h"
+#include "wisdom.h"
+#include "ir_cache.h"
+
+// Default IRs synthesized at build time (scripts/gen_default_irs.c)
+#ifdef HAVE_DEFAULT_IRS
+#include "default_irs.h"
+#endif
 
 // Constants
 #define MAX_IR_SECONDS   15
 #define MAX_IR_SIZE      (MAX_IR_SECONDS * 48000)
-#define MAX_BUFFER_SIZE  (MAX_IR_SIZE * 2)
 
 #define PI      3.14159265358979323846
 #define TWO_PI  (2.0 * PI)
@@ -21,6 +43,141 @@
 #define MAX_FFT_SIZE 65536
 #define BLOCK_SIZE 128
 
+// IR trimming - tails below this much remaining energy are dropped
+#define DEFAULT_IR_TRIM_DB  -90.0
+#define MIN_IR_TRIM_DB      -200.0
+#define MAX_IR_TRIM_DB      -20.0
+
+// Hybrid processing: sparse early-reflection taps + partitioned FFT tail
+#define MAX_EARLY_TAPS       64
+#define MAX_ER_SPREAD        16
+#define ER_MOD_INTERVAL      32     // Samples between tap modulation updates
+#define ER_MAX_TAP_MS        113.3  // Last entry of the early tap time table
+#define ER_MAX_MOD_MS        0.6    // Deepest tap modulation (Doppler)
+#define WET_CHUNK_SIZE       1024   // Samples convolved per wet scratch block
+
+// Two-stage convolution (tailThreads > 0): the 128-sample convolver keeps the
+// first 2 * TAIL_STAGE_BLOCK taps, the rest runs in TAIL_STAGE_BLOCK partitions
+#define TAIL_STAGE_BLOCK     2048
+
+// Multi-rate late tail (lateTailRate 2 or 4): the convolved IR from
+// MULTIRATE_SPLIT_MS after the pre-delay on runs at 1/2 or 1/4 of the sample
+// rate, crossfaded over MULTIRATE_FADE taps. lateTailRate 0 picks the lowest
+// rate whose band limit removes at most MULTIRATE_MAX_LOSS_DB of the wet energy
+#define MULTIRATE_SPLIT_MS    100.0
+#define MULTIRATE_FADE        256
+#define MULTIRATE_MAX_LOSS_DB -40.0
+
+// Hybrid FDN tail (fdnCrossover > 0): the convolved IR stops fdnCrossover ms
+// after the pre-delay, fading out over FDN_FADE_MS while a feedback delay
+// network fitted to its decay takes over - the cost no longer grows with the
+// decay time
+#define FDN_MIN_CROSSOVER_MS  100.0
+#define FDN_MAX_CROSSOVER_MS  1000.0
+#define FDN_FADE_MS           40.0
+
+// Velvet-noise tail (velvetDensity > 0): from VELVET_SPLIT_MS after the
+// pre-delay the IR is replaced by velvetDensity sparse +-1 taps per second
+// under a gain envelope of VELVET_SEGMENT_MS segments that follows the IR's
+// energy, crossfaded over VELVET_FADE_MS. Convolving it takes one add per tap
+// and sample, no spectra and no latency. An FDN crossover takes precedence
+#define VELVET_SPLIT_MS       50.0
+#define VELVET_FADE_MS        10.0
+#define VELVET_SEGMENT_MS     10.0
+#define VELVET_MIN_DENSITY    200.0
+#define VELVET_MAX_DENSITY    4000.0
+
+// Modal engine (modalEngine = 1): Plate and Spring render through a bank of
+// damped resonators laid out from the parameters - no IR, no FFT, and
+// parameter changes retune the running bank. Plate modes are spread evenly
+// (with jitter) from MODAL_PLATE_LOWEST_HZ, scaled down by the room size, to
+// MODAL_PLATE_TOP_HZ. Spring modes are harmonics of the round trip whose
+// spacing shrinks by MODAL_SPRING_DISPERSION towards the top mode. The
+// MODAL_*_LEVEL gains match the normalized IR's energy at the default settings
+#define MODAL_PLATE_MODES         256
+#define MODAL_PLATE_LOWEST_HZ     40.0
+#define MODAL_PLATE_TOP_HZ        12000.0
+#define MODAL_PLATE_LEVEL           0.53
+#define MODAL_SPRING_MODES        128
+#define MODAL_SPRING_ROUND_TRIP_MS 30.0
+#define MODAL_SPRING_DISPERSION   0.35
+#define MODAL_SPRING_LEVEL          0.42
+
+// Progressive IR generation: a regeneration publishes the IR up to
+// IR_GEN_FIRST_MS past the start of the tail straight away, then every process
+// call draws the reflections of the next IR_GEN_LEAD call lengths of delay (at
+// most IR_GEN_STEP_REFLECTIONS per 128 samples), which keeps the published IR
+// ahead of the audio that reaches it. The level starts from a pilot estimate
+// of the final peak, follows the peak found so far and glides to the exact one
+// over IR_GEN_RAMP_MS once the whole tail is known
+#define IR_GEN_FIRST_MS          20.0
+#define IR_GEN_LEAD              2
+#define IR_GEN_STEP_REFLECTIONS  512
+#define IR_GEN_RAMP_MS           50.0
+
+// Peak pilot: every IR_PILOT_STRIDE-th reflection over the whole tail, then
+// full density in the IR_PILOT_CELLS loudest IR_PILOT_CELL-sample cells. The
+// redraw reaches IR_PILOT_PAD samples (plus the type's reach) past a cell, for
+// the reflections that land in it from next door and the tone filter's memory
+#define IR_PILOT_STRIDE          64
+#define IR_PILOT_CELL            512
+#define IR_PILOT_CELLS           16
+#define IR_PILOT_PAD             64
+
+// Asynchronous start-up (init_engine_async_): each continue_init_ call draws
+// the reflections of the next INIT_SLICE_MS of tail delay, at most
+// INIT_SLICE_REFLECTIONS of them, so the host can yield between calls
+#define INIT_SLICE_MS            25.0
+#define INIT_SLICE_REFLECTIONS   2048
+#define INIT_ARENA_CHUNK         (1 << 20)   // Arena bytes faulted in per call
+
+// Layout rebuilds of a playing IR (mix crossing 30%, a new trim point): per
+// 128 samples processed, a linear pass over REBUILD_STEP_SAMPLES taps, the FFTs
+// of REBUILD_STEP_PARTITIONS partitions, clearing REBUILD_STEP_BYTES of arena or
+// faulting in REBUILD_FAULT_BYTES of a fresh rebuild_arena.
+// The old convolver is faded out over REBUILD_FADE_MS once the new one is in
+#define REBUILD_STEP_SAMPLES     8192
+#define REBUILD_STEP_PARTITIONS  32
+#define REBUILD_STEP_BYTES       (1 << 19)
+#define REBUILD_FAULT_BYTES      (1 << 17)
+#define REBUILD_FADE_MS          5.0
+
+// Sampled IRs (load_ir_samples_): mixed down to mono and resampled to the
+// engine rate with a Blackman-windowed sinc of IR_RESAMPLE_ZEROS zero crossings
+// a side, tabulated at IR_RESAMPLE_PHASES points per crossing. Uploads arrive in
+// chunks of up to IR_UPLOAD_FLOATS interleaved samples. The IR is normalized to
+// SAMPLED_IR_ENERGY - about the default Hall's - so it plays at the presets' level
+#define IR_RESAMPLE_ZEROS        16
+#define IR_RESAMPLE_PHASES       256
+#define IR_RESAMPLE_RING         2048   // Source frames kept for the kernel (power of two)
+#define IR_UPLOAD_FLOATS         8192
+#define MIN_IR_SAMPLE_RATE       8000
+#define MAX_IR_SAMPLE_RATE       384000
+#define SAMPLED_IR_ENERGY        1e5
+
+// Partition calibration: every candidate layout runs TUNING_PASSES timed passes
+// of at least TUNING_MIN_SAMPLES (several boundaries of the largest tail
+// partition) after a warm-up that fills its delay lines. A layout qualifies when
+// its slowest call takes at most TUNING_PEAK_BUDGET of the callback period
+#define TUNING_PASSES        3
+#define TUNING_MIN_SAMPLES   32768
+#define TUNING_PEAK_BUDGET   0.5
+
+// Engine-owned host I/O buffers (Float32, stable addresses for JS views)
+#define MAX_IO_CHANNELS      2
+#define IO_BUFFER_FRAMES     16384  // Largest ScriptProcessor block
+
+// Auto-bypass: output contributions below this level (-140 dBFS) are silence.
+// -DCONV_NO_SILENCE_GATING: nothing is, so benchmarks time the DSP itself
+#ifdef CONV_NO_SILENCE_GATING
+#define BYPASS_NOISE_FLOOR   -1.0
+#else
+#define BYPASS_NOISE_FLOOR   1e-7
+#endif
+
+// Recursive state below this (~-600 dB) is flushed to zero before it can go subnormal
+#define DENORMAL_FLOOR       1e-30
+
 // Reverb types - ULTIMATE COLLECTION OF SONIC INSANITY!
 #define IR_TYPE_HALL 0
 #define IR_TYPE_CATHEDRAL 1
@@ -52,12 +209,8 @@
 // Global state structure
 typedef struct {
     double* impulse_response;
-    double* overlap_buffer;
-    double* fft_buffer;
-    double* temp_buffer;
     int ir_length;
-    int buffer_size;
-    int overlap_size;
+    int ir_effective_length;   // ir_length after energy-based trimming
     
     // Parameters
     double room_size;
@@ -70,6 +223,13 @@ typedef struct {
     double early_reflections;
     double late_mix;
     double mix_level;
+    double ir_trim_db;         // Remaining-energy threshold for trimming (dB)
+    int tail_threads;          // 0: uniform partitions, >0: two-stage (worker threads if built in)
+    int host_block;            // Samples per process call the partition layout is tuned for
+    int late_tail_rate;        // 1: full rate, 2/4: late tail decimated, 0: lowest rate within budget
+    double fdn_crossover_ms;   // 0: convolve the whole IR, >0: FDN from this long after the pre-delay
+    int modal_engine;          // 1: Plate and Spring run on the modal resonator bank
+    double velvet_density;     // 0: convolve the whole IR, >0: velvet-noise taps per second past the split
     
     // State
     int sample_rate;
@@ -93,6 +253,13 @@ static ConvolutionEngine engine = {
     .early_reflections = 50.0,
     .late_mix = 50.0,
     .mix_level = 30.0,
+    .ir_trim_db = DEFAULT_IR_TRIM_DB,
+    .tail_threads = 0,
+    .host_block = BLOCK_SIZE,
+    .late_tail_rate = 1,
+    .fdn_crossover_ms = 0.0,
+    .modal_engine = 0,
+    .velvet_density = 0.0,
     .sample_rate = 48000,
     .ir_type = IR_TYPE_HALL,
     .ir_needs_update = 1,
@@ -100,15 +267,233 @@ static ConvolutionEngine engine = {
     .rand_state = 123456789
 };
 
-// Static buffer for convolution history
+// Every per-instance buffer lives in one aligned arena, laid out by
+// configure_engine_memory() whenever the IR size changes:
+//   [IR][tap history] | mark | [tail IR][early IR][FFT convolver][tail stage]
+// prepare_convolution() rebuilds everything after the mark in place. A layout
+// rebuild of a playing uniform convolver builds the next one past the live
+// one, in the space the hybrid stages would take, or else in rebuild_arena
+static Arena engine_arena;
+static size_t arena_conv_mark = 0;
+
+// Second convolver slot, reserved only while a layout rebuild needs it: from
+// the rebuild's plan until a copy in engine_arena has taken over again
+static Arena rebuild_arena;
+
+// Input history for the early reflection taps - a power of two just long
+// enough for the longest tap
 static double* conv_history = NULL;
+static int history_size = 0;
 static int history_pos = 0;
 
+// One early reflection rendered as a (possibly modulated) delay-line tap
+typedef struct {
+    int delay;            // Kernel centre in samples
+    double gain;
+    double mod_depth;     // Delay modulation depth in samples (0 = static)
+    double mod_phase;     // Current LFO phase (radians)
+    double mod_step;      // LFO phase advance per ER_MOD_INTERVAL block
+    double mod_offset;    // Delay offset held for the current interval
+} EarlyTap;
+
+// Time-domain early reflection path: sparse taps -> diffusion kernel ->
+// the same tone filter apply_spectral_shaping() puts on the IR -> IR gain.
+// Its exact impulse response is subtracted from the IR handed to the FFT
+// convolver, so the two paths together reproduce the generated IR.
+typedef struct {
+    EarlyTap taps[MAX_EARLY_TAPS];
+    int num_taps;
+    int spread;                                  // Diffusion kernel half-width
+    double kernel[2 * MAX_ER_SPREAD + 1];
+    double spread_line[2 * MAX_ER_SPREAD + 1];   // Tap sum history for the kernel
+    int spread_pos;
+    double lp_coeff, hp_coeff;
+    double lp_state, hp_state;
+    double gain;                                 // IR normalization factor
+    int modulated;
+    int mod_counter;
+} EarlyReflectionPath;
+
+static EarlyReflectionPath early = { .gain = 1.0 };
+
+// Late tail (everything the early path does not cover)
+static FFTConvolver tail_convolver;
+static int tail_convolver_ready = 0;
+static int tail_layered = 0;   // Tail IR includes the mix > 30 thickening layers
+
+// Large-partition stage behind tail_convolver in two-stage mode
+static TailStage tail_stage;
+static int tail_stage_ready = 0;
+
+// Late segment at a decimated rate in multi-rate mode (tail_convolver then only
+// holds the taps up to the crossfade, in 128-sample partitions)
+static MultirateTail late_tail;
+static int late_tail_ready = 0;
+
+// Feedback delay network standing in for the IR past the crossover in hybrid
+// FDN mode (the convolvers then only hold the taps up to the crossfade)
+static FDNTail fdn_tail;
+static int fdn_tail_ready = 0;
+
+// Velvet-noise stand-in for the late IR
+static VelvetTail velvet_tail;
+static int velvet_tail_ready = 0;
+
+// Rebuild of the uniform layout while it plays (mix crossing 30%, a new trim
+// point). The next tail IR and convolver are built a slice per process call
+// next to the live convolver; the new one then carries on from the live one's
+// input history and takes its place. One built in rebuild_arena is rebuilt
+// into engine_arena the same way once the old one has faded out, so the side
+// slot can go
+enum { REBUILD_MEASURE, REBUILD_TRIM, REBUILD_PLAN, REBUILD_CLEAR, REBUILD_BUILD,
+       REBUILD_LOAD, REBUILD_SWAP };
+
+typedef struct {
+    int active;
+    int stage;
+    int trim;               // The effective length is measured again first
+    int layered;            // Thickening layers folded into the new tail IR
+    int length;             // Effective length of the new layout
+    int conv_length;
+    int pos;                // Taps of the current stage done
+    double energy;          // Of the IR while measuring, then of the new tail IR
+    double limit;           // Energy left past the trim point
+    size_t bytes;           // Arena bytes the new layout takes
+    Arena* arena;           // Arena it is built in
+    double* tail_ir;
+    double* early_ir;
+    double lp_state, hp_state;
+    int steps;
+    FFTConvolver convolver;
+} LayoutRebuild;
+
+static LayoutRebuild rebuild;
+
+// The convolver a rebuild replaced, faded out against the new one
+typedef struct {
+    FFTConvolver convolver;
+    double scale;           // wet_correction it played at
+    int fade_length;
+    int fade_left;
+} RetiredConvolver;
+
+static RetiredConvolver retired;
+
+// Resonator bank of the modal engine, laid out for modal_bank_type (-1: none)
+static ModalBank modal_bank;
+static int modal_bank_type = -1;
+
+// Resumable IR generation. Tail reflections are drawn in increasing base
+// delay (ascending order statistics of the sqrt-distributed delays), so once
+// the draw has passed tap d + reach, every tap before d is final. That prefix
+// is tone-shaped, normalized and loaded into the running convolver while the
+// rest of the tail is still being drawn
+typedef struct {
+    int active;             // A generation is under way
+    int progressive;        // The prefix is published while generating
+    int tail_start;
+    int reach;              // reflection_reach() of the type
+    int num_reflections;
+    int next_reflection;
+    int next_base;          // Base delay of next_reflection (already drawn)
+    double remaining;       // 1 - u of the last order statistic drawn
+    long long target;       // Draw up to this base delay
+    int shaped;             // IR taps [0, shaped) are final and tone-shaped
+    double lp_state, hp_state;
+    double peak;            // Peak of the shaped taps
+    double peak_estimate;   // Pilot estimate of the complete IR's peak
+    double norm;            // Normalization of the published taps (0: not set)
+    int published;          // Tail IR taps [0, published) built and loaded
+    double published_energy;
+    int steps;
+} IRGenerator;
+
+static IRGenerator ir_gen;
+static double* gen_tail_ir = NULL;      // Tail IR being published (arena, after the mark)
+static double* gen_early_ir = NULL;
+
+// Sampled IR upload. Source frames are mixed into a ring, and each IR tap is
+// resampled as soon as the ring holds every frame its kernel reads. With the
+// uniform layout the taps go into the running convolver as they arrive, so
+// convolution starts long before a multi-second IR is complete
+typedef struct {
+    int active;             // Frames still expected
+    int loaded;             // The IR in use came from samples (no regeneration)
+    int source_rate;
+    int channels;
+    int source_frames;      // Frames announced
+    int received;           // Frames mixed into the ring so far
+    int direct;             // Same rate: the taps are the frames themselves
+    double step;            // Source frames per IR tap
+    double cutoff;          // Kernel cutoff relative to the source Nyquist (<= 1)
+    double half_width;      // Kernel half-width in source frames
+    double ring[IR_RESAMPLE_RING];
+    int written;            // IR taps [0, written) resampled
+    double energy;          // Energy of the taps written
+    int progressive;        // Taps are published while uploading
+    double norm;            // Scale of the published taps (0: not set yet)
+    int published;
+    double published_energy;
+} IRSampleUpload;
+
+static IRSampleUpload ir_upload;
+static double resample_kernel[IR_RESAMPLE_ZEROS * IR_RESAMPLE_PHASES + 2];
+static int resample_kernel_ready = 0;
+
+// Upload chunks from the host, like the wisdom blob a fixed engine buffer
+static float ir_upload_buffer[IR_UPLOAD_FLOATS];
+
+// Normalization of the last complete IR, and the gain ramp that corrects a
+// progressively published IR to it
+static double ir_norm_factor = 1.0;
+static double wet_correction = 1.0;
+static double wet_correction_target = 1.0;
+static double wet_correction_step = 0.0;
+
+// Measured partition layouts ("wisdom"). While calibrating, tuning_tail_block
+// forces the candidate under test (-1: none)
+static Wisdom partition_wisdom;
+static int tuning_active = 0;
+static int tuning_tail_block = -1;
+static const int tuning_candidates[] = { 0, 1024, 2048, 4096, 8192 };
+#define TUNING_CANDIDATES ((int)(sizeof(tuning_candidates) / sizeof(tuning_candidates[0])))
+
+// Serialized wisdom, shared with the host in both directions
+static unsigned char wisdom_blob[WISDOM_MAX_BYTES];
+
+// Precomputed IR blobs (ir_cache.c) are written and read through one heap
+// buffer the engine owns, grown on demand - they run to megabytes
+static unsigned char* ir_cache_buffer = NULL;
+static size_t ir_cache_capacity = 0;
+static size_t ir_cache_staged = 0;      // Blob in the buffer waiting for its settings
+
+// Input/output silence tracking for the tail-aware auto-bypass
+typedef struct {
+    int bypassed;             // Only dry audio is copied while set
+    long long silent_samples; // Input samples since the last non-silent one
+    double last_wet_peak;     // Wet peak (before wet gain) of the last processed call
+} SilenceTracker;
+
+static SilenceTracker silence = { 0, 0, 0.0 };
+
+// Static, so their addresses never change - not even when the arena is
+// replaced or the WASM heap grows (JS only has to re-create its views)
+static float io_input_buffers[MAX_IO_CHANNELS][IO_BUFFER_FRAMES];
+static float io_output_buffers[MAX_IO_CHANNELS][IO_BUFFER_FRAMES];
+
 // Debug counter for periodic logging
 static int process_counter = 0;
 
-// Forward declaration
+// Set by init_engine_async_ until continue_init_ has the first IR ready (or
+// audio arrives first). Parameter and type changes meanwhile only mark the IR
+// stale, so the host's settings cost nothing before the IR is built for them
+static int init_pending = 0;
+
+// Forward declarations
 static void generate_impulse_response();
+static int load_prepared_ir();
+static void prepare_convolution();
+static void apply_partition_layout();
 
 // Fast random number generator
 static inline double fast_rand() {
@@ -118,9 +503,9 @@ static inline double fast_rand() {
 
 // Fast sine approximation
 static inline double fast_sin(double x) {
-    // Wrap to [-pi, pi]
-    while (x > PI) x -= TWO_PI;
-    while (x < -PI) x += TWO_PI;
+    // Wrap to [-pi, pi] in constant time - callers pass phases in the tens of
+    // thousands of radians
+    x -= TWO_PI * floor((x + PI) / TWO_PI);
     
     // Bhaskara I's sine approximation
     double x2 = x * x;
@@ -131,38 +516,26 @@ static inline double fast_sin(double x) {
     }
 }
 
+// Zero anything too small to hear before it decays into the subnormal range.
+// WebAssembly always computes with IEEE subnormals, so this is the only
+// protection there; native builds also get FTZ/DAZ (denormal.h).
+static inline double flush_denormal(double x) {
+    return DENORMAL_PROTECTION && fabs(x) < DENORMAL_FLOOR ? 0.0 : x;
+}
+
 // Initialize engine with corrected function name
 void init_convolution_engine_(int* sr) {
     engine.sample_rate = *sr;
     engine.ir_needs_update = 1;
+    init_pending = 0;
     
-    // Allocate buffers
-    int buffer_size = MAX_IR_SIZE * 2;
-    
-    if (!engine.impulse_response) {
-        engine.impulse_response = (double*)calloc(MAX_IR_SIZE, sizeof(double));
-    }
-    if (!engine.overlap_buffer) {
-        engine.overlap_buffer = (double*)calloc(buffer_size, sizeof(double));
-    }
-    if (!engine.fft_buffer) {
-        engine.fft_buffer = (double*)calloc(buffer_size, sizeof(double));
-    }
-    if (!engine.temp_buffer) {
-        engine.temp_buffer = (double*)calloc(buffer_size, sizeof(double));
-    }
-    
-    // Allocate convolution history
-    if (!conv_history) {
-        conv_history = (double*)calloc(MAX_IR_SIZE, sizeof(double));
-    }
-    
-    engine.buffer_size = buffer_size;
+    // Nothing large is allocated here: the IR, tap history and FFT partitions
+    // are sized to the actual IR when it is generated
     engine.initialized = 1;
     
     printf("WebAssembly Convolution Reverb Engine v2.0.3-C initialized\n");
-    printf("Sample rate: %d Hz | Max IR length: %.1fs\n", 
-           *sr, (float)MAX_IR_SIZE / *sr);
+    printf("Sample rate: %d Hz | Max IR length: %.1fs | Precision: %s\n", 
+           *sr, (float)MAX_IR_SIZE / *sr, CONV_PRECISION_NAME);
 }
 
 // Generate early reflections using delay network
@@ -178,6 +551,15 @@ static void generate_early_reflections(double* ir, int ir_length, int pre_delay_
     double room_scale = 1.0 + (engine.room_size / 20.0) * 4.0;  // GIGANTIC rooms!
     double er_gain = engine.early_reflections / 3.0;  // THUNDEROUS early reflections!
     
+    // Diffusion kernel shared by every tap (matches the spreading loop below)
+    early.num_taps = 0;
+    early.spread = (int)(10 * (engine.diffusion / 80.0));
+    if (early.spread >= 0 && early.spread <= MAX_ER_SPREAD) {
+        for (int j = -early.spread; j <= early.spread; j++) {
+            early.kernel[j + early.spread] = exp(-abs(j) * 0.15) * 1.5 / (early.spread + 1);
+        }
+    }
+    
     printf("  🏛️ EARLY REFLECTIONS: room_scale=%.2f (MASSIVE!), gain=%.2f (THUNDEROUS!) 🏛️\n", 
            room_scale, er_gain);
     
@@ -345,6 +727,15 @@ static void generate_early_reflections(double* ir, int ir_length, int pre_delay_
             // Apply diffusion with EXTREME spreading
             double diffusion_spread = engine.diffusion / 80.0;  // More aggressive spread
             int spread = (int)(10 * diffusion_spread);  // Double the spread range
+            
+            // Full-width taps also go to the time-domain early reflection path
+            if (spread <= MAX_ER_SPREAD &&
+                delay - spread >= 0 && delay + spread < ir_length &&
+                early.num_taps < MAX_EARLY_TAPS) {
+                early.taps[early.num_taps].delay = delay;
+                early.taps[early.num_taps].gain = amplitude;
+                early.num_taps++;
+            }
             for (int j = -spread; j <= spread && delay + j < ir_length && delay + j >= 0; j++) {
                 ir[delay + j] += amplitude * exp(-abs(j) * 0.15) * 1.5 / (spread + 1);  // Less decay, more amplitude
             }
@@ -353,310 +744,1592 @@ static void generate_early_reflections(double* ir, int ir_length, int pre_delay_
 }
 
 // Generate reverb tail using statistical model
-static void generate_reverb_tail(double* ir, int ir_length, int start_sample) {
-    double decay_rate = 2.0 / engine.decay_time; // ULTRA slow decay - reverb that NEVER DIES
+// Reflections in the reverb tail of an ir_length-sample IR
+static int reverb_reflection_count(int ir_length) {
     double density = 5.0 + (engine.room_size / 20.0) * 50.0;  // QUANTUM DENSITY!
     int num_reflections = (int)(ir_length * 0.5 * density);  // HALF THE SAMPLES ARE REFLECTIONS!
     
-    double hf_damping = engine.damping / 200.0;  // Less damping = MORE SHIMMER
-    double lf_boost = (engine.low_freq / 25.0) * 3.0;  // TRIPLE the bass resonance!
-    
     // INSANE reflection counts for ULTIMATE DENSITY
     if (num_reflections < 50000) num_reflections = 50000;  // MINIMUM 50K!
     if (num_reflections > 200000) num_reflections = 200000;  // Cap at 200K for CPU survival
+    return num_reflections;
+}
+
+// Farthest before its base delay a reflection of the current type can land
+// (type jitter plus diffusion smear), or -1 when it can land anywhere
+static int reflection_reach(int ir_length) {
+    int reach;
+    switch (engine.ir_type) {
+        case IR_TYPE_PLATE:       reach = 30; break;
+        case IR_TYPE_SPRING:      reach = 200; break;
+        case IR_TYPE_SHIMMER:     reach = (int)(50.0 * ir_length / engine.sample_rate) + 1; break;
+        case IR_TYPE_CHORUS:      reach = 35; break;
+        case IR_TYPE_ALIEN:       reach = 50; break;
+        case IR_TYPE_UNDERWATER:  reach = 40; break;
+        case IR_TYPE_FREEZE:      // Clustered at a fixed delay
+        case IR_TYPE_PSYCHEDELIC: // Delays rescaled at random
+            return -1;
+        default:                  reach = 0; break;
+    }
+    if (engine.diffusion > 50) reach += (int)((engine.diffusion - 50) * 0.2);
+    return reach + 1;
+}
+
+// A reverb tail reflection at base delay delay (not yet moved by the type).
+// The IR generator draws the delays in increasing order, so the draw order
+// would follow the delay; the types that vary per reflection take i from
+// reflection_index() instead, uncorrelated with the delay as in a one-pass draw
+static void add_reverb_reflection(double* ir, int ir_length, int start_sample, int i, int delay) {
+    double decay_rate = 2.0 / engine.decay_time; // ULTRA slow decay - reverb that NEVER DIES
+    double lf_boost = (engine.low_freq / 25.0) * 3.0;  // TRIPLE the bass resonance!
     
-    printf("  🌟 GENERATING %d QUANTUM REFLECTIONS FOR INFINITE TAIL 🌟\n", num_reflections);
-    
-    for (int i = 0; i < num_reflections; i++) {
-        double progress = (double)i / num_reflections;
-        int delay = start_sample + (int)(pow(fast_rand(), 0.5) * (ir_length - start_sample));
+    if (delay < ir_length) {
+        double t = (double)delay / engine.sample_rate;
+        double amplitude = exp(-decay_rate * t);
         
-        if (delay < ir_length) {
-            double t = (double)delay / engine.sample_rate;
-            double amplitude = exp(-decay_rate * t);
-            
-            if (engine.damping > 50) {
-                double damping_factor = (engine.damping - 50.0) / 50.0;
-                amplitude *= exp(-damping_factor * damping_factor * t * 10.0);
-            }
-            
-            // Room-specific coloration with EXTREME CHARACTER - NOW WITH NEW TYPES!
-            switch (engine.ir_type) {
-                case IR_TYPE_CATHEDRAL:
-                    amplitude *= (1.0 + lf_boost * 5.0 * exp(-t * 0.05));  // MASSIVE bass, ultra-slow decay
-                    if (i % 2 == 0) {
-                        amplitude *= 5.0;  // QUINTUPLE every other reflection!
-                    }
-                    amplitude *= (1.0 + 2.0 * fast_sin(t * 250.0));  // Deep resonances
-                    amplitude *= (1.0 + 1.5 * fast_sin(t * 666.0));  // Mystical harmonics!
-                    amplitude *= (1.0 + fast_sin(t * 50.0));  // Sub-bass rumble
-                    break;
-                    
-                case IR_TYPE_ROOM:
-                    amplitude *= exp(-t * 5.0);  // Still fast but not as extreme
-                    amplitude *= (1.0 + 2.0 * exp(-pow(t - 0.05, 2) * 50));  // Strong early energy
-                    // Add room modes
-                    amplitude *= (1.0 + fast_sin(t * 1000.0) + 0.5 * fast_sin(t * 2137.0));
-                    break;
-                    
-                case IR_TYPE_PLATE:
-                    amplitude *= (1.0 + 3.0 * fast_sin(t * 3000.0 + i * 0.5));  // EXTREME shimmer
-                    amplitude *= (1.0 + 2.0 * fast_sin(t * 7000.0));  // High frequency madness
-                    amplitude *= (1.0 + 1.5 * fast_sin(t * 11000.0));  // Ultra-high sparkle
-                    amplitude *= (1.0 + fast_sin(t * 15000.0));  // Dog-whistle frequencies!
-                    delay += (int)(30 * fast_sin(i * 0.2));  // Wider dispersion
-                    if (delay >= ir_length) continue;
-                    break;
-                    
-                case IR_TYPE_SPRING:
-                    // MAXIMUM BOING - Multiple spring oscillations
-                    delay += (int)(100 * fast_sin(t * 200.0) + 60 * fast_sin(t * 77.0));
-                    delay += (int)(40 * fast_sin(t * 333.0));  // Triple spring madness!
-                    if (delay >= ir_length || delay < 0) continue;
-                    amplitude *= (1.0 + 4.0 * fast_sin(t * 600.0));  // MEGA oscillation
-                    amplitude *= (1.0 + 2.0 * exp(-t * 1.0) * fast_sin(t * 2000.0));
-                    amplitude *= (1.0 + fast_sin(t * 4567.0));  // Chaotic harmonics
-                    break;
-                    
-                case IR_TYPE_CAVE:
-                    // Deep, boomy cave resonances
-                    amplitude *= (1.0 + lf_boost * 8.0);  // MASSIVE low end
-                    amplitude *= exp(-t * 1.5);  // Very slow decay
-                    // Stalactite drips
-                    if ((int)(t * 1000) % 500 < 50) amplitude *= 3.0;
-                    // Echo flutter
-                    amplitude *= (1.0 + 2.0 * fast_sin(t * 100.0));
-                    break;
-                    
-                case IR_TYPE_SHIMMER:
-                    // Ethereal ascending effect
-                    amplitude *= exp(-t * 2.0);
-                    // Pitch shifting simulation
-                    delay -= (int)(t * 50.0);  // Delays get shorter over time
-                    if (delay < 0) continue;
-                    // Octave harmonics
-                    amplitude *= (1.0 + 2.0 * fast_sin(t * 2000.0 * (1.0 + t)));
-                    amplitude *= (1.0 + 1.5 * fast_sin(t * 4000.0 * (1.0 + t * 0.5)));
-                    break;
-                    
-                case IR_TYPE_FREEZE:
-                    // Infinite sustain effect
-                    amplitude *= 2.0;  // No decay!
-                    // Clustered delays
-                    delay = start_sample + (int)((fast_rand() * 0.1 + 0.45) * engine.sample_rate);
-                    // Add harmonics
-                    amplitude *= (1.0 + fast_sin(t * 1000.0) + fast_sin(t * 2000.0));
-                    break;
-                    
-                case IR_TYPE_REVERSE:
-                    // Backwards envelope
-                    amplitude *= (1.0 - exp(-t * 5.0));  // Grows over time!
-                    amplitude *= exp(-(engine.decay_time - t) * 3.0);  // Then fades
-                    // Psychedelic modulation
-                    amplitude *= (1.0 + 2.0 * fast_sin(t * 500.0));
-                    break;
-                    
-                case IR_TYPE_GATED:
-                    // 80s gated reverb on steroids
-                    if (t > 0.5) amplitude = 0;  // Hard gate
-                    else amplitude *= 10.0;  // LOUD when open
-                    // Add some character
-                    amplitude *= (1.0 + fast_sin(t * 5000.0));
-                    break;
-                    
-                case IR_TYPE_CHORUS:
-                    // Modulated delays
-                    amplitude *= exp(-t * 3.0);
-                    // LFO modulation
-                    delay += (int)(20.0 * fast_sin(t * 5.0 + i * 0.1));
-                    delay += (int)(15.0 * fast_sin(t * 7.0));
-                    if (delay >= ir_length || delay < 0) continue;
-                    // Detuning effect
-                    amplitude *= (1.0 + fast_sin(t * 1000.0 + i * 0.5));
-                    break;
-                    
-                case IR_TYPE_ALIEN:
-                    // Non-euclidean space reverb
-                    amplitude *= exp(-t * 2.0 * (1.0 + fast_sin(t * 0.5)));  // Varying decay
-                    // Weird resonances
-                    amplitude *= (1.0 + 3.0 * fast_sin(t * 666.0));
-                    amplitude *= (1.0 + 2.0 * fast_sin(t * 1337.0));
-                    amplitude *= (1.0 + 1.5 * fast_sin(t * 3141.0));  // Pi frequency!
-                    // Phase warping
-                    delay += (int)(50.0 * fast_sin(t * 10.0) * fast_sin(t * 0.1));
-                    if (delay >= ir_length || delay < 0) continue;
-                    break;
-                    
-                case IR_TYPE_UNDERWATER:
-                    // Subaquatic filtering
-                    amplitude *= exp(-t * 4.0);  // Medium decay
-                    amplitude *= (1.0 + lf_boost * 4.0);  // Muffled highs
-                    // Bubble oscillations
-                    amplitude *= (1.0 + 2.0 * fast_sin(t * 200.0 + fast_rand() * 100.0));
-                    amplitude *= (1.0 + fast_sin(t * 77.0));
-                    // Current movement
-                    delay += (int)(40.0 * fast_sin(t * 0.3));
-                    break;
-                    
-                case IR_TYPE_METALLIC:
-                    // Inside a metal tank
-                    amplitude *= exp(-t * 3.5);
-                    // Metallic ring
-                    amplitude *= (1.0 + 4.0 * fast_sin(t * 2500.0) * exp(-t * 5.0));
-                    amplitude *= (1.0 + 3.0 * fast_sin(t * 5700.0) * exp(-t * 8.0));
-                    amplitude *= (1.0 + 2.0 * fast_sin(t * 8900.0) * exp(-t * 10.0));
-                    // Resonant nodes
-                    if ((int)(t * 5000) % 1000 < 100) amplitude *= 5.0;
-                    break;
-                    
-                case IR_TYPE_PSYCHEDELIC:
-                    // Complete chaos!
-                    amplitude *= exp(-t * (1.0 + 3.0 * fast_rand()));  // Random decay
-                    // Random resonances
-                    for (int h = 0; h < 5; h++) {
-                        amplitude *= (1.0 + fast_sin(t * (100.0 + fast_rand() * 10000.0)));
-                    }
-                    // Delay chaos
-                    delay += (int)(100.0 * fast_sin(t * fast_rand() * 100.0));
-                    delay = (int)(delay * (0.5 + fast_rand()));
-                    if (delay >= ir_length || delay < 0) continue;
-                    // Random amplitude bursts
-                    if (fast_rand() > 0.95) amplitude *= 10.0;
-                    break;
-                    
-                default: // HALL - Make it SYMPHONIC
-                    amplitude *= (1.0 + lf_boost * 2.0 * exp(-t * 0.3));
-                    double size_factor = (100.0 - engine.room_size) / 100.0;
-                    amplitude *= exp(-size_factor * size_factor * t * 1.0);  // Slower decay
-                    // Add concert hall resonances
-                    amplitude *= (1.0 + 0.5 * fast_sin(t * 440.0));   // A440 resonance
-                    amplitude *= (1.0 + 0.3 * fast_sin(t * 880.0));   // Octave
-                    amplitude *= (1.0 + 0.2 * fast_sin(t * 1320.0));  // Fifth
-                    break;
-            }
-            
-            // Apply diffusion
-            if (engine.diffusion > 50) {
-                int smear = (int)((engine.diffusion - 50) * 0.2);
-                for (int s = -smear; s <= smear && delay + s < ir_length && delay + s >= 0; s++) {
-                    ir[delay + s] += amplitude * (2.0 * fast_rand() - 1.0) * 
-                                    exp(-abs(s) * 0.3) / (smear + 1);
+        if (engine.damping > 50) {
+            double damping_factor = (engine.damping - 50.0) / 50.0;
+            amplitude *= exp(-damping_factor * damping_factor * t * 10.0);
+        }
+        
+        // Room-specific coloration with EXTREME CHARACTER - NOW WITH NEW TYPES!
+        switch (engine.ir_type) {
+            case IR_TYPE_CATHEDRAL:
+                amplitude *= (1.0 + lf_boost * 5.0 * exp(-t * 0.05));  // MASSIVE bass, ultra-slow decay
+                if (i % 2 == 0) {
+                    amplitude *= 5.0;  // QUINTUPLE every other reflection!
+                }
+                amplitude *= (1.0 + 2.0 * fast_sin(t * 250.0));  // Deep resonances
+                amplitude *= (1.0 + 1.5 * fast_sin(t * 666.0));  // Mystical harmonics!
+                amplitude *= (1.0 + fast_sin(t * 50.0));  // Sub-bass rumble
+                break;
+                
+            case IR_TYPE_ROOM:
+                amplitude *= exp(-t * 5.0);  // Still fast but not as extreme
+                amplitude *= (1.0 + 2.0 * exp(-pow(t - 0.05, 2) * 50));  // Strong early energy
+                // Add room modes
+                amplitude *= (1.0 + fast_sin(t * 1000.0) + 0.5 * fast_sin(t * 2137.0));
+                break;
+                
+            case IR_TYPE_PLATE:
+                amplitude *= (1.0 + 3.0 * fast_sin(t * 3000.0 + i * 0.5));  // EXTREME shimmer
+                amplitude *= (1.0 + 2.0 * fast_sin(t * 7000.0));  // High frequency madness
+                amplitude *= (1.0 + 1.5 * fast_sin(t * 11000.0));  // Ultra-high sparkle
+                amplitude *= (1.0 + fast_sin(t * 15000.0));  // Dog-whistle frequencies!
+                delay += (int)(30 * fast_sin(i * 0.2));  // Wider dispersion
+                if (delay >= ir_length) return;
+                break;
+                
+            case IR_TYPE_SPRING:
+                // MAXIMUM BOING - Multiple spring oscillations
+                delay += (int)(100 * fast_sin(t * 200.0) + 60 * fast_sin(t * 77.0));
+                delay += (int)(40 * fast_sin(t * 333.0));  // Triple spring madness!
+                if (delay >= ir_length || delay < 0) return;
+                amplitude *= (1.0 + 4.0 * fast_sin(t * 600.0));  // MEGA oscillation
+                amplitude *= (1.0 + 2.0 * exp(-t * 1.0) * fast_sin(t * 2000.0));
+                amplitude *= (1.0 + fast_sin(t * 4567.0));  // Chaotic harmonics
+                break;
+                
+            case IR_TYPE_CAVE:
+                // Deep, boomy cave resonances
+                amplitude *= (1.0 + lf_boost * 8.0);  // MASSIVE low end
+                amplitude *= exp(-t * 1.5);  // Very slow decay
+                // Stalactite drips
+                if ((int)(t * 1000) % 500 < 50) amplitude *= 3.0;
+                // Echo flutter
+                amplitude *= (1.0 + 2.0 * fast_sin(t * 100.0));
+                break;
+                
+            case IR_TYPE_SHIMMER:
+                // Ethereal ascending effect
+                amplitude *= exp(-t * 2.0);
+                // Pitch shifting simulation
+                delay -= (int)(t * 50.0);  // Delays get shorter over time
+                if (delay < 0) return;
+                // Octave harmonics
+                amplitude *= (1.0 + 2.0 * fast_sin(t * 2000.0 * (1.0 + t)));
+                amplitude *= (1.0 + 1.5 * fast_sin(t * 4000.0 * (1.0 + t * 0.5)));
+                break;
+                
+            case IR_TYPE_FREEZE:
+                // Infinite sustain effect
+                amplitude *= 2.0;  // No decay!
+                // Clustered delays
+                delay = start_sample + (int)((fast_rand() * 0.1 + 0.45) * engine.sample_rate);
+                // Add harmonics
+                amplitude *= (1.0 + fast_sin(t * 1000.0) + fast_sin(t * 2000.0));
+                break;
+                
+            case IR_TYPE_REVERSE:
+                // Backwards envelope
+                amplitude *= (1.0 - exp(-t * 5.0));  // Grows over time!
+                amplitude *= exp(-(engine.decay_time - t) * 3.0);  // Then fades
+                // Psychedelic modulation
+                amplitude *= (1.0 + 2.0 * fast_sin(t * 500.0));
+                break;
+                
+            case IR_TYPE_GATED:
+                // 80s gated reverb on steroids
+                if (t > 0.5) amplitude = 0;  // Hard gate
+                else amplitude *= 10.0;  // LOUD when open
+                // Add some character
+                amplitude *= (1.0 + fast_sin(t * 5000.0));
+                break;
+                
+            case IR_TYPE_CHORUS:
+                // Modulated delays
+                amplitude *= exp(-t * 3.0);
+                // LFO modulation
+                delay += (int)(20.0 * fast_sin(t * 5.0 + i * 0.1));
+                delay += (int)(15.0 * fast_sin(t * 7.0));
+                if (delay >= ir_length || delay < 0) return;
+                // Detuning effect
+                amplitude *= (1.0 + fast_sin(t * 1000.0 + i * 0.5));
+                break;
+                
+            case IR_TYPE_ALIEN:
+                // Non-euclidean space reverb
+                amplitude *= exp(-t * 2.0 * (1.0 + fast_sin(t * 0.5)));  // Varying decay
+                // Weird resonances
+                amplitude *= (1.0 + 3.0 * fast_sin(t * 666.0));
+                amplitude *= (1.0 + 2.0 * fast_sin(t * 1337.0));
+                amplitude *= (1.0 + 1.5 * fast_sin(t * 3141.0));  // Pi frequency!
+                // Phase warping
+                delay += (int)(50.0 * fast_sin(t * 10.0) * fast_sin(t * 0.1));
+                if (delay >= ir_length || delay < 0) return;
+                break;
+                
+            case IR_TYPE_UNDERWATER:
+                // Subaquatic filtering
+                amplitude *= exp(-t * 4.0);  // Medium decay
+                amplitude *= (1.0 + lf_boost * 4.0);  // Muffled highs
+                // Bubble oscillations
+                amplitude *= (1.0 + 2.0 * fast_sin(t * 200.0 + fast_rand() * 100.0));
+                amplitude *= (1.0 + fast_sin(t * 77.0));
+                // Current movement
+                delay += (int)(40.0 * fast_sin(t * 0.3));
+                break;
+                
+            case IR_TYPE_METALLIC:
+                // Inside a metal tank
+                amplitude *= exp(-t * 3.5);
+                // Metallic ring
+                amplitude *= (1.0 + 4.0 * fast_sin(t * 2500.0) * exp(-t * 5.0));
+                amplitude *= (1.0 + 3.0 * fast_sin(t * 5700.0) * exp(-t * 8.0));
+                amplitude *= (1.0 + 2.0 * fast_sin(t * 8900.0) * exp(-t * 10.0));
+                // Resonant nodes
+                if ((int)(t * 5000) % 1000 < 100) amplitude *= 5.0;
+                break;
+                
+            case IR_TYPE_PSYCHEDELIC:
+                // Complete chaos!
+                amplitude *= exp(-t * (1.0 + 3.0 * fast_rand()));  // Random decay
+                // Random resonances
+                for (int h = 0; h < 5; h++) {
+                    amplitude *= (1.0 + fast_sin(t * (100.0 + fast_rand() * 10000.0)));
                 }
-            } else {
-                // Low diffusion = MASSIVE discrete echoes
-                ir[delay] += amplitude * (2.0 * fast_rand() - 1.0) * 10.0;  // 10X louder!
+                // Delay chaos
+                delay += (int)(100.0 * fast_sin(t * fast_rand() * 100.0));
+                delay = (int)(delay * (0.5 + fast_rand()));
+                if (delay >= ir_length || delay < 0) return;
+                // Random amplitude bursts
+                if (fast_rand() > 0.95) amplitude *= 10.0;
+                break;
+                
+            default: // HALL - Make it SYMPHONIC
+                amplitude *= (1.0 + lf_boost * 2.0 * exp(-t * 0.3));
+                double size_factor = (100.0 - engine.room_size) / 100.0;
+                amplitude *= exp(-size_factor * size_factor * t * 1.0);  // Slower decay
+                // Add concert hall resonances
+                amplitude *= (1.0 + 0.5 * fast_sin(t * 440.0));   // A440 resonance
+                amplitude *= (1.0 + 0.3 * fast_sin(t * 880.0));   // Octave
+                amplitude *= (1.0 + 0.2 * fast_sin(t * 1320.0));  // Fifth
+                break;
+        }
+        
+        // Several types move the delay around - never write outside the IR
+        if (delay >= ir_length || delay < 0) return;
+        
+        // Apply diffusion
+        if (engine.diffusion > 50) {
+            int smear = (int)((engine.diffusion - 50) * 0.2);
+            for (int s = -smear; s <= smear && delay + s < ir_length && delay + s >= 0; s++) {
+                ir[delay + s] += amplitude * (2.0 * fast_rand() - 1.0) * 
+                                exp(-abs(s) * 0.3) / (smear + 1);
             }
+        } else {
+            // Low diffusion = MASSIVE discrete echoes
+            ir[delay] += amplitude * (2.0 * fast_rand() - 1.0) * 10.0;  // 10X louder!
         }
     }
 }
 
-// Apply spectral shaping
-static void apply_spectral_shaping(double* ir, int ir_length) {
-    double lp_state = 0.0;
-    double hp_state = 0.0;
+// One-pole tone filter coefficients shared by the IR and the early path
+static void spectral_shaping_coefficients(double* lp_cutoff, double* hp_cutoff) {
+    *lp_cutoff = 0.1 + (engine.high_freq / 100.0) * 0.4;
+    *hp_cutoff = 0.001 + (100.0 - engine.low_freq) / 100.0 * 0.05;
+}
+
+// Apply spectral shaping to ir[from, to), carrying the filter state over
+static void apply_spectral_shaping_span(double* ir, int from, int to, double* lp, double* hp) {
+    double lp_state = *lp;
+    double hp_state = *hp;
     
-    double lp_cutoff = 0.1 + (engine.high_freq / 100.0) * 0.4;
-    double hp_cutoff = 0.001 + (100.0 - engine.low_freq) / 100.0 * 0.05;
+    double lp_cutoff, hp_cutoff;
+    spectral_shaping_coefficients(&lp_cutoff, &hp_cutoff);
     
-    for (int i = 0; i < ir_length; i++) {
+    for (int i = from; i < to; i++) {
         // Low-pass filter
-        lp_state += (ir[i] - lp_state) * lp_cutoff;
+        lp_state = flush_denormal(lp_state + (ir[i] - lp_state) * lp_cutoff);
         ir[i] = lp_state;
         
         // High-pass filter
-        hp_state += (ir[i] - hp_state) * hp_cutoff;
-        ir[i] -= hp_state;
+        hp_state = flush_denormal(hp_state + (ir[i] - hp_state) * hp_cutoff);
+        ir[i] = flush_denormal(ir[i] - hp_state);
     }
+    *lp = lp_state;
+    *hp = hp_state;
 }
 
-// Generate complete impulse response
-static void generate_impulse_response() {
-    printf("\n=== GENERATING NEW IMPULSE RESPONSE ===\n");
+// Apply spectral shaping
+static void apply_spectral_shaping(double* ir, int ir_length) {
+    double lp_state = 0.0;
+    double hp_state = 0.0;
+    apply_spectral_shaping_span(ir, 0, ir_length, &lp_state, &hp_state);
+}
+
+// Find where the IR becomes inaudible using the backward-integrated energy
+// decay curve (Schroeder integral). Returns the number of samples to keep:
+// everything after it carries less than threshold_db of the total energy.
+static int compute_effective_length(const double* ir, int ir_length, double threshold_db) {
+    double total = 0.0;
+    for (int i = 0; i < ir_length; i++) {
+        total += ir[i] * ir[i];
+    }
+    if (total <= 0.0) return 1;
     
-    // Clear the IR buffer
-    memset(engine.impulse_response, 0, MAX_IR_SIZE * sizeof(double));
+    double limit = total * pow(10.0, threshold_db / 10.0);
+    double remaining = 0.0;
     
-    // Calculate IR length
-    engine.ir_length = (int)(engine.decay_time * engine.sample_rate);
-    if (engine.ir_length > MAX_IR_SIZE) {
-        engine.ir_length = MAX_IR_SIZE;
-    }
-    if (engine.ir_length < engine.sample_rate / 2) {
-        engine.ir_length = engine.sample_rate / 2;
+    for (int i = ir_length - 1; i >= 0; i--) {
+        remaining += ir[i] * ir[i];
+        if (remaining >= limit) {
+            return i + 1;
+        }
     }
+    return ir_length;
+}
+
+// Take a new effective length and report the trim
+static void set_effective_length(int length) {
+    engine.ir_effective_length = length;
     
-    int pre_delay_samples = (int)(engine.pre_delay * engine.sample_rate / 1000.0);
+    printf("  ✂️ IR trimmed at %.0f dB: %d -> %d samples (%.2fs, %.0f%% of full length)\n",
+           engine.ir_trim_db, engine.ir_length, engine.ir_effective_length,
+           (double)engine.ir_effective_length / engine.sample_rate,
+           100.0 * engine.ir_effective_length / engine.ir_length);
+}
+
+// Re-derive the effective length from the current IR (no regeneration)
+static void update_effective_length() {
+    set_effective_length(compute_effective_length(engine.impulse_response, engine.ir_length,
+                                                  engine.ir_trim_db));
+}
+
+// Generate complete impulse response
+// Longest lag the early taps can read with the current room size and
+// pre-delay, rounded up to a power of two so the ring index is a mask
+static int early_history_samples(int ir_length) {
+    double room_scale = 1.0 + (engine.room_size / 20.0) * 4.0;  // As in generate_early_reflections()
+    int longest = (int)((engine.pre_delay + ER_MAX_TAP_MS * room_scale) * engine.sample_rate / 1000.0);
+    if (longest > ir_length) longest = ir_length;
+    longest += (int)ceil(ER_MAX_MOD_MS * engine.sample_rate / 1000.0) + 2;
     
-    // Generate early reflections
-    generate_early_reflections(engine.impulse_response, engine.ir_length, pre_delay_samples);
+    int size = BLOCK_SIZE;
+    while (size < longest) size <<= 1;
+    return size;
+}
+
+// Stop the tail stages' worker threads, and drop any layout rebuild and
+// retired convolver (and free rebuild_arena), before their arena memory is reused
+static void release_tail_stage() {
+    rebuild.active = 0;
+    retired.fade_left = 0;
+    arena_free(&rebuild_arena);
+    if (tail_stage_ready) {
+        tail_stage_destroy(&tail_stage);
+        tail_stage_ready = 0;
+    }
+    if (late_tail_ready) {
+        multirate_tail_destroy(&late_tail);
+        late_tail_ready = 0;
+    }
+    fdn_tail_ready = 0;
+    velvet_tail_ready = 0;
+}
+
+// The mix > 30 thickening layers are folded into generated IRs only; a
+// sampled IR is convolved as recorded
+static int thickening_layers() {
+    return engine.mix_level > 30 && !ir_upload.loaded;
+}
+
+// Samples the FFT convolvers take: the trimmed IR, plus half again when the
+// thickening layers are folded in
+static int convolved_length() {
+    int length = engine.ir_effective_length;
+    return thickening_layers() ? length + length / 2 : length;
+}
+
+// Tail-stage partition size for a convolved IR of conv_length samples (0: the
+// 128-sample convolver takes all of it). The candidate under calibration comes
+// first, then the measured choice for this IR length and host block; without
+// one, two-stage runs only when tailThreads asks for it
+static int select_tail_block(int conv_length) {
+    int tail_block;
+    if (tuning_tail_block >= 0) {
+        tail_block = tuning_tail_block;
+    } else {
+        const WisdomEntry* tuned = wisdom_find(&partition_wisdom, wisdom_length_class(conv_length),
+                                               engine.host_block);
+        tail_block = tuned ? tuned->tail_block : (engine.tail_threads > 0 ? TAIL_STAGE_BLOCK : 0);
+    }
+    return conv_length > 3 * tail_block ? tail_block : 0;
+}
+
+// Room for the largest tail stage any candidate layout could build, whenever a
+// two-stage layout can be selected at all
+static size_t tail_stage_reserve_bytes(int conv_length) {
+    int possible = engine.tail_threads > 0 || tuning_active;
+    for (int i = 0; i < partition_wisdom.count && !possible; i++) {
+        possible = partition_wisdom.entries[i].tail_block > 0;
+    }
+    if (!possible) return 0;
     
-    // Generate reverb tail
-    int tail_start = pre_delay_samples + (int)(0.02 * engine.sample_rate);
-    generate_reverb_tail(engine.impulse_response, engine.ir_length, tail_start);
+    size_t most = 0;
+    for (int c = 0; c < TUNING_CANDIDATES; c++) {
+        if (tuning_candidates[c] == 0) continue;
+        size_t bytes = tail_stage_bytes(tuning_candidates[c], conv_length, engine.tail_threads);
+        if (bytes > most) most = bytes;
+    }
+    return most;
+}
+
+// Room for the decimated late tail when multi-rate mode may select it
+static size_t late_tail_reserve_bytes(int conv_length) {
+    if (engine.late_tail_rate == 1) return 0;
     
-    // Apply spectral shaping
-    apply_spectral_shaping(engine.impulse_response, engine.ir_length);
+    size_t half = multirate_tail_bytes(2, conv_length, WET_CHUNK_SIZE, engine.tail_threads);
+    size_t quarter = multirate_tail_bytes(4, conv_length, WET_CHUNK_SIZE, engine.tail_threads);
+    return half > quarter ? half : quarter;
+}
+
+// Tap the hybrid FDN tail takes over at
+static int fdn_crossover_tap() {
+    return (int)((engine.pre_delay + engine.fdn_crossover_ms) * engine.sample_rate / 1000.0);
+}
+
+// Room for the FDN and its input pre-delay in hybrid FDN mode
+static size_t fdn_tail_reserve_bytes() {
+    if (engine.fdn_crossover_ms <= 0.0) return 0;
+    return fdn_tail_bytes(engine.sample_rate, fdn_crossover_tap());
+}
+
+// Tap the velvet-noise tail takes over at, and its segment length
+static int velvet_split_tap() {
+    return (int)((engine.pre_delay + VELVET_SPLIT_MS) * engine.sample_rate / 1000.0);
+}
+
+static int velvet_segment_samples() {
+    return (int)(VELVET_SEGMENT_MS * engine.sample_rate / 1000.0);
+}
+
+// Room for the velvet taps, envelope and input history in velvet mode
+static size_t velvet_tail_reserve_bytes(int conv_length) {
+    if (engine.velvet_density <= 0.0 || velvet_split_tap() >= conv_length) return 0;
+    return velvet_tail_bytes(engine.sample_rate, engine.velvet_density, conv_length,
+                             velvet_split_tap(), velvet_segment_samples());
+}
+
+// Scratch IRs and the uniform convolver at the longest convolved length
+static size_t conv_slot_bytes(int ir_length) {
+    int conv_length = ir_length + ir_length / 2;
     
-    // Normalize with COSMIC SCALE BOOST - WE'RE GOING INTERSTELLAR!
-    double max_val = 0.0;
-    double rms = 0.0;
+    return ARENA_BYTES(conv_length, double) +   // Tail IR scratch
+           ARENA_BYTES(ir_length, double) +     // Early IR scratch
+           fft_convolver_bytes(BLOCK_SIZE, conv_length);
+}
+
+// Arena bytes for an IR of ir_length samples (worst case: thickening layers
+// folded into the tail)
+static size_t engine_memory_bytes(int ir_length) {
+    int conv_length = ir_length + ir_length / 2;
     
-    for (int i = 0; i < engine.ir_length; i++) {
-        double abs_val = fabs(engine.impulse_response[i]);
-        if (abs_val > max_val) max_val = abs_val;
-        rms += engine.impulse_response[i] * engine.impulse_response[i];
-    }
+    return ARENA_BYTES(ir_length, double) +
+           ARENA_BYTES(early_history_samples(ir_length), double) +
+           conv_slot_bytes(ir_length) +
+           tail_stage_reserve_bytes(conv_length) +
+           late_tail_reserve_bytes(conv_length) +
+           fdn_tail_reserve_bytes() +
+           velvet_tail_reserve_bytes(conv_length);
+}
+
+// Size the arena for an IR of ir_length samples and carve out the IR and tap
+// history. The block is only replaced when it is too small or more than twice
+// too big.
+static int configure_engine_memory(int ir_length) {
+    int hist = early_history_samples(ir_length);
+    size_t bytes = engine_memory_bytes(ir_length);
     
-    rms = sqrt(rms / engine.ir_length);
+    release_tail_stage();
+    tail_convolver_ready = 0;
     
-    if (max_val > 0.0) {
-        // 🌟 INTERSTELLAR BOOST - BEYOND ALL LIMITS! 🌟
-        double target_peak = 10.0;  // TEN TIMES the original!
-        double norm_factor = target_peak / max_val;
-        
-        // Allow boosting up to 20x for COSMIC REVERB
-        if (norm_factor > 20.0) norm_factor = 20.0;
-        
-        // EXTREME boost based on reverb type
-        switch (engine.ir_type) {
-            case IR_TYPE_CATHEDRAL:
-                norm_factor *= 2.0;  // DOUBLE for the house of God!
-                printf("  ⛪ CATHEDRAL BOOST: DIVINE MULTIPLICATION x%.1f ⛪\n", norm_factor);
-                break;
-            case IR_TYPE_PLATE:
-                norm_factor *= 1.8;  // Metal plates should RING FOREVER
-                printf("  🔔 PLATE BOOST: ETERNAL RESONANCE x%.1f 🔔\n", norm_factor);
-                break;
-            case IR_TYPE_SPRING:
-                norm_factor *= 2.5;  // Springs should OSCILLATE THE UNIVERSE
-                printf("  🌀 SPRING BOOST: QUANTUM OSCILLATION x%.1f 🌀\n", norm_factor);
-                break;
-            case IR_TYPE_ROOM:
-                norm_factor *= 1.5;  // Even small rooms are CAVERNS now
-                printf("  🏛️ ROOM BOOST: CAVERN MODE x%.1f 🏛️\n", norm_factor);
-                break;
-            default:
-                printf("  🎭 HALL BOOST: SYMPHONIC EXPLOSION x%.1f 🎭\n", norm_factor);
-        }
-        
-        // Apply the cosmic boost with HARMONIC ENHANCEMENT
-        for (int i = 0; i < engine.ir_length; i++) {
-            engine.impulse_response[i] *= norm_factor;
-            
-            // Add subtle harmonic distortion for RICHNESS
-            if (i % 2 == 0 && fabs(engine.impulse_response[i]) > 0.1) {
-                engine.impulse_response[i] *= 1.02;  // Even harmonics boost
-            }
+    if (bytes > engine_arena.size || bytes < engine_arena.size / 2) {
+        Arena fresh;
+        if (arena_init(&fresh, bytes) == 0) {
+            arena_free(&engine_arena);
+            engine_arena = fresh;
+            printf("  🧱 ARENA: %.2f MB reserved%s\n", bytes / (1024.0 * 1024.0),
+                   engine_arena.locked ? " (locked)" : "");
+        } else if (bytes > engine_arena.size) {
+            // The old block stays allocated but is too small to use
+            engine.impulse_response = NULL;
+            conv_history = NULL;
+            history_size = 0;
+            return -1;
         }
-        
-        rms *= norm_factor;
-        
-        printf("  🌌💫 CONVOLUTION MATRIX HYPERCHARGED: %.1fx boost applied! 💫🌌\n", norm_factor);
     }
     
-    engine.ir_needs_update = 0;
-    
-    // Debug output with extended type names
+    arena_rewind(&engine_arena, 0);
+    engine.impulse_response = (double*)arena_alloc(&engine_arena, ir_length * sizeof(double));
+    conv_history = (double*)arena_alloc(&engine_arena, hist * sizeof(double));
+    history_size = hist;
+    arena_conv_mark = arena_mark(&engine_arena);
+    return 0;
+}
+
+// Plate and Spring bypass the IR while the modal engine is on (unless a
+// sampled IR replaced the generated one)
+static int modal_engine_active() {
+    return engine.modal_engine && !ir_upload.loaded &&
+           (engine.ir_type == IR_TYPE_PLATE || engine.ir_type == IR_TYPE_SPRING);
+}
+
+// Mode layouts draw from their own fixed sequence - the same modes every time,
+// and the IR generator's random state is left alone
+static inline double modal_rand(uint32_t* state) {
+    *state = (*state * 1103515245 + 12345) & 0x7fffffff;
+    return (double)*state / 0x7fffffff;
+}
+
+// Magnitude of the IR's one-pole tone filter (apply_spectral_shaping) at freq_hz
+static double spectral_shaping_gain(double freq_hz) {
+    double lp_cutoff, hp_cutoff;
+    spectral_shaping_coefficients(&lp_cutoff, &hp_cutoff);
+    
+    double c = cos(TWO_PI * freq_hz / engine.sample_rate);
+    double lp_pole = 1.0 - lp_cutoff;
+    double hp_pole = 1.0 - hp_cutoff;
+    double lp2 = lp_cutoff * lp_cutoff / (1.0 - 2.0 * lp_pole * c + lp_pole * lp_pole);
+    double hp2 = hp_pole * hp_pole * (2.0 - 2.0 * c) / (1.0 - 2.0 * hp_pole * c + hp_pole * hp_pole);
+    return sqrt(lp2 * hp2);
+}
+
+// Lay the resonator bank out for the current type and parameters. The decay
+// follows generate_reverb_tail()'s envelope, with high modes damped harder as
+// damping rises; the tone follows apply_spectral_shaping(). A bank already
+// laid out for this type keeps ringing through the retune
+static void update_modal_bank() {
+    int plate = engine.ir_type == IR_TYPE_PLATE;
+    int num_modes = plate ? MODAL_PLATE_MODES : MODAL_SPRING_MODES;
+    double level = plate ? MODAL_PLATE_LEVEL : MODAL_SPRING_LEVEL;
+    double size_scale = 0.5 + engine.room_size / 100.0;
+    uint32_t seed = plate ? 0x2545F491u : 0x1B873593u;
+    
+    double decay_rate = 2.0 / engine.decay_time;
+    if (engine.damping > 50) {
+        double damping_factor = (engine.damping - 50.0) / 50.0;
+        decay_rate += damping_factor * damping_factor * 10.0;
+    }
+    double hf_damping = engine.damping / 200.0;   // Extra decay per kHz of mode frequency
+    
+    if (modal_bank_type != engine.ir_type) {
+        modal_bank_reset(&modal_bank);
+    }
+    modal_bank_begin(&modal_bank, num_modes,
+                     (int)(engine.pre_delay * engine.sample_rate / 1000.0));
+    
+    double lowest = MODAL_PLATE_LOWEST_HZ / size_scale;
+    double top = fmin(MODAL_PLATE_TOP_HZ, 0.45 * engine.sample_rate);
+    double spacing = 1000.0 / (MODAL_SPRING_ROUND_TRIP_MS * size_scale);
+    
+    for (int k = 0; k < num_modes; k++) {
+        double freq;
+        if (plate) {
+            freq = lowest + (top - lowest) * (k + modal_rand(&seed)) / num_modes;
+        } else {
+            double harmonic = k + 1.0;
+            freq = spacing * harmonic * (1.0 - MODAL_SPRING_DISPERSION * harmonic / num_modes);
+        }
+        
+        double sign = modal_rand(&seed) < 0.5 ? -1.0 : 1.0;
+        modal_bank_set_mode(&modal_bank, k, freq, decay_rate * (1.0 + hf_damping * freq / 1000.0),
+                            sign * level * spectral_shaping_gain(freq), engine.sample_rate);
+    }
+    
+    if (modal_bank_type != engine.ir_type) {
+        printf("  🔔 MODAL ENGINE: %d %s modes, slowest T60 %.2fs - no IR needed\n", num_modes,
+               plate ? "plate" : "spring", 3.0 * log(10.0) / modal_bank.slowest_decay);
+    }
+    modal_bank_type = engine.ir_type;
+}
+
+// Clear every piece of input history (early taps, kernel, filters, FFT tail)
+static void reset_convolution_state() {
+    if (conv_history) {
+        memset(conv_history, 0, history_size * sizeof(double));
+    }
+    history_pos = 0;
+    
+    memset(early.spread_line, 0, sizeof(early.spread_line));
+    early.spread_pos = 0;
+    early.lp_state = 0.0;
+    early.hp_state = 0.0;
+    early.mod_counter = 0;
+    
+    if (tail_convolver_ready) {
+        fft_convolver_reset(&tail_convolver);
+    }
+    retired.fade_left = 0;
+    if (tail_stage_ready) {
+        tail_stage_reset(&tail_stage);
+    }
+    if (late_tail_ready) {
+        multirate_tail_reset(&late_tail);
+    }
+    if (fdn_tail_ready) {
+        fdn_tail_reset(&fdn_tail);
+    }
+    if (velvet_tail_ready) {
+        velvet_tail_reset(&velvet_tail);
+    }
+    modal_bank_reset(&modal_bank);
+    
+    // Nothing is left ringing (longer than any tail_length_samples())
+    silence.silent_samples = INT32_MAX;
+    silence.last_wet_peak = 0.0;
+}
+
+// Output samples still produced after the input stops (IR plus delayed layer,
+// or the FDN's fitted decay or the slowest mode down to -90 dB)
+static int tail_length_samples() {
+    if (modal_engine_active()) {
+        if (modal_bank.slowest_decay <= 0.0) return modal_bank.predelay_length;
+        return modal_bank.predelay_length +
+               (int)(1.5 * 3.0 * log(10.0) / modal_bank.slowest_decay * engine.sample_rate);
+    }
+    
+    int length = engine.ir_effective_length;
+    if (tail_layered) length += length / 2;
+    
+    if (fdn_tail_ready) {
+        double t60 = fmax(fdn_tail.t60_low, fdn_tail.t60_high);
+        int ring = fdn_tail.start + (int)(1.5 * t60 * engine.sample_rate);
+        if (ring > length) length = ring;
+    }
+    return length;
+}
+
+// Delay modulation for the moving-source types - only the tap read
+// positions move, nothing is regenerated.
+static void setup_early_modulation() {
+    double depth_ms = 0.0;
+    double rate_hz = 0.0;
+    
+    switch (engine.ir_type) {
+        case IR_TYPE_DOPPLER:
+            depth_ms = 0.6;   // Slow sweeping source
+            rate_hz = 0.25;
+            break;
+        case IR_TYPE_MAGNETIC:
+            depth_ms = 0.12;  // Tape wow
+            rate_hz = 1.1;
+            break;
+        case IR_TYPE_CHORUS:
+            depth_ms = 0.35;
+            rate_hz = 0.8;
+            break;
+    }
+    
+    early.modulated = depth_ms > 0.0;
+    early.mod_counter = 0;
+    
+    for (int i = 0; i < early.num_taps; i++) {
+        EarlyTap* tap = &early.taps[i];
+        double depth = depth_ms * engine.sample_rate / 1000.0;
+        
+        // Never read ahead of the newest input sample
+        if (depth > tap->delay - early.spread) depth = tap->delay - early.spread;
+        
+        tap->mod_depth = early.modulated ? depth : 0.0;
+        tap->mod_phase = i * 2.39996;  // Golden angle - taps drift independently
+        tap->mod_step = TWO_PI * rate_hz * (1.0 + 0.1 * i / MAX_EARLY_TAPS) *
+                        ER_MOD_INTERVAL / engine.sample_rate;
+        tap->mod_offset = 0.0;
+    }
+}
+
+// Hand the late segment of tail_ir to the decimated convolver. Auto mode tries
+// 1/4 rate, then 1/2, and keeps the first whose band limit stays within
+// MULTIRATE_MAX_LOSS_DB of the whole tail's energy. Returns the tap the late
+// segment starts at, or 0 when everything stays at full rate
+static int setup_late_tail(const double* tail_ir, int conv_length) {
+    if (engine.late_tail_rate == 1 || tuning_active) return 0;
+    
+    int split = (int)((engine.pre_delay + MULTIRATE_SPLIT_MS) * engine.sample_rate / 1000.0);
+    if (split + MULTIRATE_FADE >= conv_length) return 0;
+    
+    double total = 0.0;
+    double late = 0.0;
+    for (int i = 0; i < conv_length; i++) {
+        double tap = tail_ir[i];
+        total += tap * tap;
+        if (i >= split) {
+            tap *= multirate_tail_fade(i - split, MULTIRATE_FADE);
+            late += tap * tap;
+        }
+    }
+    if (total <= 0.0) return 0;
+    
+    const int auto_factors[] = { 4, 2 };
+    const int* factors = engine.late_tail_rate == 0 ? auto_factors : &engine.late_tail_rate;
+    int num_factors = engine.late_tail_rate == 0 ? 2 : 1;
+    
+    for (int f = 0; f < num_factors; f++) {
+        size_t mark = arena_mark(&engine_arena);
+        if (multirate_tail_init(&late_tail, &engine_arena, factors[f], tail_ir, conv_length, split,
+                                MULTIRATE_FADE, WET_CHUNK_SIZE, engine.tail_threads) != 0) {
+            continue;
+        }
+        
+        double loss_db = 10.0 * log10(late_tail.loss * late / total + 1e-30);
+        if (engine.late_tail_rate == 0 && loss_db > MULTIRATE_MAX_LOSS_DB) {
+            printf("  📉 MULTI-RATE TAIL: 1/%d rate, band-limit loss %.1f dB - over budget\n",
+                   factors[f], loss_db);
+            multirate_tail_destroy(&late_tail);
+            arena_rewind(&engine_arena, mark);
+            continue;
+        }
+        
+        late_tail_ready = 1;
+        printf("  📉 MULTI-RATE TAIL: 1/%d rate from %.0f ms, %d partitions of %d, band-limit loss %.1f dB\n",
+               factors[f], 1000.0 * split / engine.sample_rate, late_tail.stage.num_partitions,
+               late_tail.stage.block_size, loss_db);
+        return split;
+    }
+    
+    printf("  📉 MULTI-RATE TAIL: not used - late tail stays at the full rate\n");
+    return 0;
+}
+
+// Hand the IR past the crossover to the feedback delay network, fitted to the
+// decay of tail_ir. Returns the crossover tap, or 0 when the whole IR stays
+// convolved (mode off, IR shorter than the crossfade, nothing left to fit)
+static int setup_fdn_tail(const double* tail_ir, int conv_length, int fade) {
+    if (engine.fdn_crossover_ms <= 0.0 || tuning_active) return 0;
+    
+    int split = fdn_crossover_tap();
+    if (split + fade >= conv_length) return 0;
+    
+    double lp_coeff, hp_coeff;
+    spectral_shaping_coefficients(&lp_coeff, &hp_coeff);
+    
+    if (fdn_tail_init(&fdn_tail, &engine_arena, engine.sample_rate, engine.room_size, tail_ir,
+                      conv_length, split, fade, lp_coeff, hp_coeff) != 0) {
+        printf("  🌀 FDN TAIL: nothing to fit past %.0f ms - convolving the whole IR\n",
+               1000.0 * split / engine.sample_rate);
+        return 0;
+    }
+    
+    fdn_tail_ready = 1;
+    printf("  🌀 FDN TAIL: from %.0f ms, T60 %.2fs low / %.2fs high, %.0f ms of IR no longer convolved\n",
+           1000.0 * split / engine.sample_rate, fdn_tail.t60_low, fdn_tail.t60_high,
+           1000.0 * (conv_length - split - fade) / engine.sample_rate);
+    return split;
+}
+
+// Hand the IR past the split to the velvet-noise tail. Returns the split tap,
+// or 0 when the whole IR stays convolved (mode off, IR too short, no energy)
+static int setup_velvet_tail(const double* tail_ir, int conv_length, int fade) {
+    if (engine.velvet_density <= 0.0 || tuning_active) return 0;
+    
+    int split = velvet_split_tap();
+    if (split + fade >= conv_length) return 0;
+    
+    double lp_coeff, hp_coeff;
+    spectral_shaping_coefficients(&lp_coeff, &hp_coeff);
+    
+    if (velvet_tail_init(&velvet_tail, &engine_arena, engine.sample_rate, engine.velvet_density,
+                         tail_ir, conv_length, split, fade, velvet_segment_samples(),
+                         lp_coeff, hp_coeff, engine.rand_state) != 0) {
+        printf("  🎲 VELVET TAIL: nothing to cover past %.0f ms - convolving the whole IR\n",
+               1000.0 * split / engine.sample_rate);
+        return 0;
+    }
+    
+    velvet_tail_ready = 1;
+    printf("  🎲 VELVET TAIL: from %.0f ms, %d taps (%.0f/s) in %d segments\n",
+           1000.0 * split / engine.sample_rate, velvet_tail.num_taps, engine.velvet_density,
+           velvet_tail.num_segments);
+    return split;
+}
+
+// Whether an early tap survives a trim to length
+static int early_tap_kept(const EarlyTap* tap, int length) {
+    int max_mod = (int)ceil(ER_MAX_MOD_MS * engine.sample_rate / 1000.0);
+    return tap->delay + early.spread < length && tap->delay + max_mod + 2 <= history_size;
+}
+
+// Drop the early taps a trim to length cuts
+static void keep_early_taps(int length) {
+    int kept = 0;
+    for (int i = 0; i < early.num_taps; i++) {
+        if (early_tap_kept(&early.taps[i], length)) {
+            early.taps[kept++] = early.taps[i];
+        }
+    }
+    early.num_taps = kept;
+}
+
+// Split the current IR into the early tap path and the FFT tail, and load the
+// tail (with the mix > 30 thickening layers folded in) into the convolver.
+// Taps past the trim point were cut from the IR - drop them from the early path
+// too (as well as any the history could not reach, which the sizing rules out)
+static void prepare_early_path(int length) {
+    keep_early_taps(length);
+    spectral_shaping_coefficients(&early.lp_coeff, &early.hp_coeff);
+    setup_early_modulation();
+}
+
+static void prepare_convolution() {
+    int length = engine.ir_effective_length;
+    int layered = thickening_layers();
+    int conv_length = convolved_length();
+    
+    prepare_early_path(length);
+    
+    // The IR is complete and normalized: no level correction left to apply
+    early.gain = ir_norm_factor;
+    wet_correction = wet_correction_target = 1.0;
+    wet_correction_step = 0.0;
+    
+    // Scratch IRs and the convolver reuse the arena space after the mark
+    release_tail_stage();
+    tail_convolver_ready = 0;
+    arena_rewind(&engine_arena, arena_conv_mark);
+    double* tail_ir = (double*)arena_alloc(&engine_arena, conv_length * sizeof(double));
+    double* early_ir = (double*)arena_alloc(&engine_arena, length * sizeof(double));
+    
+    if (!tail_ir || !early_ir) {
+        printf("  WARNING: arena too small preparing convolution\n");
+        return;
+    }
+    
+    // Same response as the old per-sample loop: primary + shimmer + delayed layers
+    const double* ir = engine.impulse_response;
+    for (int j = 0; j < length; j++) {
+        tail_ir[j] += ir[j];
+        if (layered) {
+            if (j % 2 == 0) tail_ir[j] += ir[j] * 0.3;
+            if (j < length - 1) tail_ir[j * 3 / 2] += ir[j] * 0.2;
+        }
+    }
+    
+    // Render the early path's impulse response and take it out of the tail
+    for (int i = 0; i < early.num_taps; i++) {
+        for (int j = -early.spread; j <= early.spread; j++) {
+            early_ir[early.taps[i].delay + j] += early.taps[i].gain * early.kernel[j + early.spread];
+        }
+    }
+    apply_spectral_shaping(early_ir, length);
+    for (int i = 0; i < length; i++) {
+        tail_ir[i] -= early_ir[i] * early.gain;
+    }
+    
+    // Hybrid FDN, velvet noise or multi-rate: the full-rate convolver keeps the
+    // taps up to the end of the crossfade into the network, the velvet taps or
+    // the decimated late segment
+    int full_length = conv_length;
+    int fade = (int)(FDN_FADE_MS * engine.sample_rate / 1000.0);
+    int split = setup_fdn_tail(tail_ir, conv_length, fade);
+    if (split == 0) {
+        fade = (int)(VELVET_FADE_MS * engine.sample_rate / 1000.0);
+        split = setup_velvet_tail(tail_ir, conv_length, fade);
+    }
+    if (split == 0) {
+        fade = MULTIRATE_FADE;
+        split = setup_late_tail(tail_ir, conv_length);
+    }
+    if (split > 0) {
+        for (int i = 0; i < fade; i++) {
+            tail_ir[split + i] *= 1.0 - multirate_tail_fade(i, fade);
+        }
+        full_length = split + fade;
+    }
+    
+    // Two-stage: short partitions up to 2L, the rest in partitions of L whose
+    // work has a whole block of slack - on the tail stage's threads, or spread
+    // over the process calls of the next block without them. The short
+    // full-rate part of a hybrid or multi-rate layout stays uniform
+    int tail_block = split > 0 ? 0 : select_tail_block(conv_length);
+    int head_length = tail_block > 0 ? 2 * tail_block : full_length;
+    
+    if (fft_convolver_init(&tail_convolver, &engine_arena, BLOCK_SIZE, tail_ir, head_length) == 0) {
+        tail_convolver_ready = 1;
+        tail_layered = layered;
+    } else {
+        printf("  WARNING: arena too small for the FFT convolver\n");
+    }
+    
+    if (tail_convolver_ready && head_length < full_length) {
+        if (tail_stage_init(&tail_stage, &engine_arena, tail_block, tail_ir + head_length,
+                            conv_length - head_length, engine.tail_threads) == 0) {
+            tail_stage_ready = 1;
+        } else {
+            printf("  WARNING: arena too small for the tail stage\n");
+            tail_convolver_ready = 0;
+        }
+    }
+    
+    reset_convolution_state();
+    
+    printf("  🧩 HYBRID SPLIT: %d early taps (spread %d%s) + %d/%d non-empty FFT partitions of %d\n",
+           early.num_taps, early.spread, early.modulated ? ", modulated" : "",
+           tail_convolver.num_active, tail_convolver.num_partitions, BLOCK_SIZE);
+    if (tail_stage_ready) {
+        printf("  🧵 TAIL STAGE: %d partitions of %d in %d group(s)%s\n",
+               tail_stage.num_partitions, tail_block, tail_stage.num_groups,
+               tail_stage.threaded ? " on worker threads" : ", time-distributed inline");
+    }
+}
+
+// COSMIC normalization gain for an IR peaking at max_val
+static double normalization_factor(double max_val, int announce) {
+    // 🌟 INTERSTELLAR BOOST - BEYOND ALL LIMITS! 🌟
+    double target_peak = 10.0;  // TEN TIMES the original!
+    double norm_factor = target_peak / max_val;
+    
+    // Allow boosting up to 20x for COSMIC REVERB
+    if (norm_factor > 20.0) norm_factor = 20.0;
+    
+    // EXTREME boost based on reverb type
+    switch (engine.ir_type) {
+        case IR_TYPE_CATHEDRAL:
+            norm_factor *= 2.0;  // DOUBLE for the house of God!
+            if (announce) printf("  ⛪ CATHEDRAL BOOST: DIVINE MULTIPLICATION x%.1f ⛪\n", norm_factor);
+            break;
+        case IR_TYPE_PLATE:
+            norm_factor *= 1.8;  // Metal plates should RING FOREVER
+            if (announce) printf("  🔔 PLATE BOOST: ETERNAL RESONANCE x%.1f 🔔\n", norm_factor);
+            break;
+        case IR_TYPE_SPRING:
+            norm_factor *= 2.5;  // Springs should OSCILLATE THE UNIVERSE
+            if (announce) printf("  🌀 SPRING BOOST: QUANTUM OSCILLATION x%.1f 🌀\n", norm_factor);
+            break;
+        case IR_TYPE_ROOM:
+            norm_factor *= 1.5;  // Even small rooms are CAVERNS now
+            if (announce) printf("  🏛️ ROOM BOOST: CAVERN MODE x%.1f 🏛️\n", norm_factor);
+            break;
+        default:
+            if (announce) printf("  🎭 HALL BOOST: SYMPHONIC EXPLOSION x%.1f 🎭\n", norm_factor);
+    }
+    return norm_factor;
+}
+
+// Tap value after normalization with HARMONIC ENHANCEMENT
+static inline double normalized_tap(double tap, int i, double norm_factor) {
+    tap *= norm_factor;
+    
+    // Add subtle harmonic distortion for RICHNESS
+    if (i % 2 == 0 && fabs(tap) > 0.1) {
+        tap *= 1.02;  // Even harmonics boost
+    }
+    return tap;
+}
+
+// An IR can be published into the convolver before it is complete only with
+// the plain uniform layout (hybrid, velvet, multi-rate and two-stage layouts
+// are fitted to the whole IR)
+static int uniform_layout() {
+    return !tuning_active && engine.fdn_crossover_ms <= 0.0 && engine.velvet_density <= 0.0 &&
+           engine.late_tail_rate == 1 && select_tail_block(convolved_length()) == 0;
+}
+
+// The generated prefix can be published while the tail is drawn when its
+// reflections stay local
+static int progressive_layout() {
+    return ir_gen.reach >= 0 && uniform_layout();
+}
+
+// Lay out the scratch IRs and an empty convolver as prepare_convolution()
+// would for the untrimmed IR; the early path is complete from the start
+static int begin_progressive_convolution() {
+    int length = engine.ir_length;
+    int conv_length = convolved_length();
+    
+    prepare_early_path(length);
+    
+    release_tail_stage();
+    tail_convolver_ready = 0;
+    arena_rewind(&engine_arena, arena_conv_mark);
+    gen_tail_ir = (double*)arena_alloc(&engine_arena, conv_length * sizeof(double));
+    gen_early_ir = (double*)arena_alloc(&engine_arena, length * sizeof(double));
+    if (!gen_tail_ir || !gen_early_ir ||
+        fft_convolver_init_empty(&tail_convolver, &engine_arena, BLOCK_SIZE, conv_length) != 0) {
+        return -1;
+    }
+    
+    for (int i = 0; i < early.num_taps; i++) {
+        for (int j = -early.spread; j <= early.spread; j++) {
+            gen_early_ir[early.taps[i].delay + j] += early.taps[i].gain * early.kernel[j + early.spread];
+        }
+    }
+    apply_spectral_shaping(gen_early_ir, length);
+    
+    tail_convolver_ready = 1;
+    tail_layered = thickening_layers();
+    early.gain = 0.0;   // Silent until the first publish sets the level
+    wet_correction = wet_correction_target = 1.0;
+    wet_correction_step = 0.0;
+    reset_convolution_state();
+    return 0;
+}
+
+// Ramp the wet level to target times the published one over IR_GEN_RAMP_MS
+static void glide_wet_correction(double target) {
+    if (target == wet_correction_target) return;
+    wet_correction_target = target;
+    wet_correction_step = (target - wet_correction) / (IR_GEN_RAMP_MS * engine.sample_rate / 1000.0);
+}
+
+// The convolver lives in rebuild_arena
+static int in_rebuild_arena(const FFTConvolver* conv) {
+    return rebuild_arena.base && (unsigned char*)conv->head >= rebuild_arena.base &&
+           (unsigned char*)conv->head < rebuild_arena.base + rebuild_arena.size;
+}
+
+// Free rebuild_arena once nothing plays from it or is built in it
+static void release_rebuild_arena() {
+    if (!rebuild_arena.base) return;
+    if (rebuild.active && rebuild.arena == &rebuild_arena) return;
+    if (tail_convolver_ready && in_rebuild_arena(&tail_convolver)) return;
+    if (retired.fade_left > 0 && in_rebuild_arena(&retired.convolver)) return;
+    
+    arena_free(&rebuild_arena);
+    printf("  🧱 REBUILD SLOT: released\n");
+}
+
+// Rebuild the live layout for the current mix - and, with trim, for the
+// current trim threshold. A uniform convolver keeps playing while
+// step_layout_rebuild() builds its successor; other layouts are rebuilt here
+static void request_layout_rebuild(int trim) {
+    trim = trim || (rebuild.active && rebuild.trim);
+    
+    int in_place = tail_convolver_ready && !tail_stage_ready && !late_tail_ready &&
+                   !fdn_tail_ready && !velvet_tail_ready && uniform_layout();
+    if (!in_place) {
+        if (trim) update_effective_length();
+        prepare_convolution();
+        return;
+    }
+    
+    memset(&rebuild, 0, sizeof(rebuild));
+    if (!trim && thickening_layers() == tail_layered && !in_rebuild_arena(&tail_convolver)) {
+        return;   // Back to the live layout
+    }
+    
+    rebuild.active = 1;
+    rebuild.trim = trim;
+    rebuild.layered = thickening_layers();
+    rebuild.length = engine.ir_effective_length;
+    rebuild.stage = trim ? REBUILD_MEASURE : REBUILD_PLAN;
+}
+
+// Size the new layout and place it where the live convolver leaves room: the
+// slot at the mark when it plays from elsewhere, the free space past it, or a
+// rebuild_arena reserved now. 0 when it has to be built synchronously after all
+static int plan_layout_rebuild() {
+    rebuild.conv_length = rebuild.layered ? rebuild.length + rebuild.length / 2 : rebuild.length;
+    rebuild.bytes = ARENA_BYTES(rebuild.conv_length, double) + ARENA_BYTES(rebuild.length, double) +
+                    fft_convolver_bytes(BLOCK_SIZE, rebuild.conv_length);
+    if (select_tail_block(rebuild.conv_length) != 0) return 0;
+    
+    rebuild.arena = &engine_arena;
+    size_t second = arena_conv_mark + conv_slot_bytes(engine.ir_length);
+    if (in_rebuild_arena(&tail_convolver) ||
+        (unsigned char*)tail_convolver.head >= engine_arena.base + second) {
+        arena_rewind(&engine_arena, arena_conv_mark);
+        return 1;
+    }
+    if (second + rebuild.bytes <= engine_arena.size) {
+        return arena_seek(&engine_arena, second) == 0;
+    }
+    
+    // Pages are faulted in by the clearing steps, not here
+    rebuild.arena = &rebuild_arena;
+    if (rebuild_arena.size >= rebuild.bytes) {
+        arena_rewind(&rebuild_arena, 0);
+        return 1;
+    }
+    arena_free(&rebuild_arena);
+    if (arena_reserve(&rebuild_arena, rebuild.bytes) != 0) return 0;
+    printf("  🧱 REBUILD SLOT: %.2f MB reserved\n", rebuild_arena.size / (1024.0 * 1024.0));
+    return 1;
+}
+
+// Lay out the scratch IRs and the empty convolver in the cleared slot, and
+// render the early path's IR as prepare_convolution() does
+static int layout_rebuild_buffers() {
+    rebuild.tail_ir = (double*)arena_alloc(rebuild.arena, rebuild.conv_length * sizeof(double));
+    rebuild.early_ir = (double*)arena_alloc(rebuild.arena, rebuild.length * sizeof(double));
+    if (!rebuild.tail_ir || !rebuild.early_ir ||
+        fft_convolver_init_empty(&rebuild.convolver, rebuild.arena, BLOCK_SIZE, rebuild.conv_length) != 0) {
+        return -1;
+    }
+    
+    for (int i = 0; i < early.num_taps; i++) {
+        if (!early_tap_kept(&early.taps[i], rebuild.length)) continue;
+        for (int j = -early.spread; j <= early.spread; j++) {
+            rebuild.early_ir[early.taps[i].delay + j] += early.taps[i].gain * early.kernel[j + early.spread];
+        }
+    }
+    return 0;
+}
+
+// Put the rebuilt convolver in place of the live one, carrying on from its
+// input history, and fade the live one out. Taps past the live IR's length
+// meet silence until the input since the swap reaches them
+static void swap_in_layout_rebuild() {
+    retired.convolver = tail_convolver;
+    retired.scale = wet_correction;
+    fft_convolver_take_history(&rebuild.convolver, &tail_convolver);
+    tail_convolver = rebuild.convolver;
+    tail_layered = rebuild.layered;
+    
+    if (rebuild.trim) {
+        set_effective_length(rebuild.length);
+        keep_early_taps(rebuild.length);
+    }
+    
+    // As prepare_convolution() leaves it: the IR is complete and normalized
+    early.gain = ir_norm_factor;
+    wet_correction = wet_correction_target = 1.0;
+    wet_correction_step = 0.0;
+    
+    retired.fade_length = (int)(REBUILD_FADE_MS * engine.sample_rate / 1000.0) + 1;
+    retired.fade_left = retired.fade_length;
+    rebuild.active = 0;
+    
+    printf("  🔁 LAYOUT REBUILD: %d/%d non-empty FFT partitions%s swapped in after %d steps%s\n",
+           tail_convolver.num_active, tail_convolver.num_partitions,
+           tail_layered ? " (layered)" : "", rebuild.steps,
+           in_rebuild_arena(&tail_convolver) ? " (moving back into the arena next)" : "");
+    
+    // Played from the side slot: the same layout again, into the slot the
+    // retired convolver frees
+    if (in_rebuild_arena(&tail_convolver)) request_layout_rebuild(0);
+}
+
+// One step of the rebuild under way, sized for 128 samples of audio. With
+// wait, the swap holds off until a level glide has settled
+static void step_layout_rebuild(int wait) {
+    // The free slot is the retired convolver's until its fade is over
+    if (!rebuild.active || retired.fade_left > 0) return;
+    rebuild.steps++;
+    
+    const double* ir = engine.impulse_response;
+    int ir_length = engine.ir_length;
+    int end;
+    
+    switch (rebuild.stage) {
+        case REBUILD_MEASURE:
+            // Total energy, then the backward scan of compute_effective_length()
+            end = rebuild.pos + REBUILD_STEP_SAMPLES < ir_length ? rebuild.pos + REBUILD_STEP_SAMPLES : ir_length;
+            for (int i = rebuild.pos; i < end; i++) {
+                rebuild.energy += ir[i] * ir[i];
+            }
+            rebuild.pos = end;
+            if (end < ir_length) break;
+            
+            if (rebuild.energy <= 0.0) {
+                rebuild.length = 1;
+                rebuild.stage = REBUILD_PLAN;
+                break;
+            }
+            rebuild.limit = rebuild.energy * pow(10.0, engine.ir_trim_db / 10.0);
+            rebuild.energy = 0.0;
+            rebuild.pos = ir_length;
+            rebuild.stage = REBUILD_TRIM;
+            break;
+            
+        case REBUILD_TRIM:
+            end = rebuild.pos - REBUILD_STEP_SAMPLES > 0 ? rebuild.pos - REBUILD_STEP_SAMPLES : 0;
+            rebuild.length = ir_length;
+            for (int i = rebuild.pos - 1; i >= end; i--) {
+                rebuild.energy += ir[i] * ir[i];
+                if (rebuild.energy >= rebuild.limit) {
+                    rebuild.length = i + 1;
+                    rebuild.stage = REBUILD_PLAN;
+                    break;
+                }
+            }
+            rebuild.pos = end;
+            if (end == 0) rebuild.stage = REBUILD_PLAN;
+            break;
+            
+        case REBUILD_PLAN:
+            if (!plan_layout_rebuild()) {
+                // Two-stage for the new length, or no room for a second convolver
+                rebuild.active = 0;
+                if (rebuild.trim) set_effective_length(rebuild.length);
+                prepare_convolution();
+                break;
+            }
+            rebuild.stage = REBUILD_CLEAR;
+            break;
+            
+        case REBUILD_CLEAR:
+            // The slot is zeroed (and a fresh rebuild_arena faulted in) here,
+            // so laying it out costs no clearing
+            if (arena_clear_ahead(rebuild.arena, rebuild.bytes, rebuild.arena == &rebuild_arena ?
+                                  REBUILD_FAULT_BYTES : REBUILD_STEP_BYTES) > 0) break;
+            if (layout_rebuild_buffers() != 0) {
+                printf("  WARNING: arena too small for the layout rebuild\n");
+                rebuild.active = 0;
+                break;
+            }
+            rebuild.pos = 0;
+            rebuild.energy = 0.0;
+            rebuild.stage = REBUILD_BUILD;
+            break;
+            
+        case REBUILD_BUILD: {
+            // prepare_convolution()'s tail IR, a span at a time: every tap
+            // before the span's end is final once the span is added
+            double* tail_ir = rebuild.tail_ir;
+            int length = rebuild.length;
+            end = rebuild.pos + REBUILD_STEP_SAMPLES < rebuild.conv_length ?
+                  rebuild.pos + REBUILD_STEP_SAMPLES : rebuild.conv_length;
+            int taps = end < length ? end : length;
+            
+            for (int j = rebuild.pos; j < taps; j++) {
+                tail_ir[j] += ir[j];
+                if (rebuild.layered) {
+                    if (j % 2 == 0) tail_ir[j] += ir[j] * 0.3;
+                    if (j < length - 1) tail_ir[j * 3 / 2] += ir[j] * 0.2;
+                }
+            }
+            if (rebuild.pos < taps) {
+                apply_spectral_shaping_span(rebuild.early_ir, rebuild.pos, taps,
+                                            &rebuild.lp_state, &rebuild.hp_state);
+            }
+            for (int j = rebuild.pos; j < end; j++) {
+                if (j < length) tail_ir[j] -= rebuild.early_ir[j] * ir_norm_factor;
+                rebuild.energy += tail_ir[j] * tail_ir[j];
+            }
+            
+            rebuild.pos = end;
+            if (end == rebuild.conv_length) rebuild.stage = REBUILD_LOAD;
+            break;
+        }
+            
+        case REBUILD_LOAD:
+            fft_convolver_load(&rebuild.convolver, rebuild.tail_ir,
+                               rebuild.convolver.loaded + REBUILD_STEP_PARTITIONS * BLOCK_SIZE,
+                               rebuild.energy * FFT_CONVOLVER_PARTITION_FLOOR);
+            if (rebuild.convolver.loaded >= rebuild.conv_length) rebuild.stage = REBUILD_SWAP;
+            break;
+            
+        case REBUILD_SWAP:
+            if (wait && wet_correction != wet_correction_target) break;
+            swap_in_layout_rebuild();
+            break;
+    }
+}
+
+// Complete a rebuild under way at once, for callers off the audio path
+static void finish_layout_rebuild() {
+    while (rebuild.active) {
+        retired.fade_left = 0;
+        step_layout_rebuild(0);
+    }
+    release_rebuild_arena();
+}
+
+// Crossfade from the retired convolver's output to the new one's in wet
+static void fade_out_retired(const conv_sample_t* in, conv_sample_t* wet, int count) {
+    conv_sample_t old[WET_CHUNK_SIZE];
+    fft_convolver_process(&retired.convolver, in, old, count);
+    
+    for (int i = 0; i < count && retired.fade_left > 0; i++, retired.fade_left--) {
+        double fade = (double)retired.fade_left / retired.fade_length;
+        wet[i] = (conv_sample_t)(wet[i] + fade * (retired.scale * old[i] - wet[i]));
+    }
+}
+
+// Build the tail IR over the newly shaped taps (primary + shimmer + delayed
+// layers, minus the early path, as prepare_convolution() does) and load every
+// partition it completes
+static void publish_ir_prefix() {
+    const double* ir = engine.impulse_response;
+    int length = engine.ir_length;
+    
+    if (ir_gen.norm == 0.0) {
+        if (ir_gen.peak <= 0.0) return;
+        ir_gen.norm = normalization_factor(fmax(ir_gen.peak, ir_gen.peak_estimate), 0);
+        early.gain = ir_gen.norm;
+        printf("  ⏩ PROGRESSIVE IR: first %.0f ms live after %d of %d reflections (level x%.1f)\n",
+               1000.0 * ir_gen.shaped / engine.sample_rate, ir_gen.next_reflection,
+               ir_gen.num_reflections, ir_gen.norm);
+    }
+    
+    for (int j = ir_gen.published; j < ir_gen.shaped; j++) {
+        double tap = normalized_tap(ir[j], j, ir_gen.norm);
+        gen_tail_ir[j] += tap;
+        if (tail_layered) {
+            if (j % 2 == 0) gen_tail_ir[j] += tap * 0.3;
+            if (j < length - 1) gen_tail_ir[j * 3 / 2] += tap * 0.2;
+        }
+        gen_tail_ir[j] -= gen_early_ir[j] * early.gain;
+        ir_gen.published_energy += gen_tail_ir[j] * gen_tail_ir[j];
+    }
+    ir_gen.published = ir_gen.shaped;
+    
+    // The delayed layer's last half is complete once the whole IR is
+    int ready = ir_gen.shaped < length ? ir_gen.shaped : convolved_length();
+    fft_convolver_load(&tail_convolver, gen_tail_ir, ready,
+                       ir_gen.published_energy * FFT_CONVOLVER_PARTITION_FLOOR);
+    
+    // The final peak is at least the one seen so far - never louder than that
+    double estimate = normalization_factor(fmax(ir_gen.peak, ir_gen.peak_estimate), 0);
+    glide_wet_correction(fmin(estimate, ir_gen.norm) / ir_gen.norm);
+}
+
+// Stand-in order index of draw n of count: a hash of n, uniform over
+// [0, count). Leaves the random state alone
+static inline int reflection_index(int n, int count) {
+    uint32_t x = (uint32_t)n * 0x9e3779b9u;
+    x ^= x >> 16;
+    x *= 0x7feb352du;
+    x ^= x >> 15;
+    x *= 0x846ca68bu;
+    x ^= x >> 16;
+    return (int)(x % (uint32_t)count);
+}
+
+// Base delay of a tail reflection at u in [0, 1) of the delay distribution
+static inline int reflection_base(double u) {
+    return ir_gen.tail_start + (int)(sqrt(u) * (engine.ir_length - ir_gen.tail_start));
+}
+
+// Next order statistic of the tail's base delays
+static void draw_next_base() {
+    int left = ir_gen.num_reflections - ir_gen.next_reflection;
+    if (left <= 0) return;
+    
+    double v = fast_rand();
+    ir_gen.remaining *= pow(v > 0.0 ? v : 1e-300, 1.0 / left);
+    ir_gen.next_base = reflection_base(1.0 - ir_gen.remaining);
+}
+
+static double pilot_cell_peak[(MAX_IR_SIZE + IR_PILOT_CELL - 1) / IR_PILOT_CELL];
+
+// Peak of pilot taps [from, to) with every tail reflection that can land there
+// drawn at full density over the early reflections. Uses gen_tail_ir around
+// the window and zeroes it again
+static double pilot_window_peak(int from, int to) {
+    double* scratch = gen_tail_ir;
+    int length = engine.ir_length;
+    int pad = (ir_gen.reach > 0 ? ir_gen.reach : 0) + IR_PILOT_PAD;
+    int lo = from - pad > 0 ? from - pad : 0;
+    int hi = to + pad < length ? to + pad : length;
+    if (to > length) to = length;
+    
+    memcpy(scratch + lo, engine.impulse_response + lo, (hi - lo) * sizeof(double));
+    
+    // Share of the reflections whose base delay falls in [lo, hi)
+    double span = length - ir_gen.tail_start;
+    double u_lo = lo > ir_gen.tail_start ? (lo - ir_gen.tail_start) / span : 0.0;
+    double u_hi = hi > ir_gen.tail_start ? (hi - ir_gen.tail_start) / span : 0.0;
+    u_lo *= u_lo;
+    u_hi *= u_hi;
+    int count = (int)(ir_gen.num_reflections * (u_hi - u_lo) + 0.5);
+    for (int n = 0; n < count; n++) {
+        add_reverb_reflection(scratch, length, ir_gen.tail_start,
+                              (int)(fast_rand() * (ir_gen.num_reflections - 1)),
+                              reflection_base(u_lo + (u_hi - u_lo) * fast_rand()));
+    }
+    
+    double lp_state = 0.0, hp_state = 0.0;
+    apply_spectral_shaping_span(scratch, lo, hi, &lp_state, &hp_state);
+    
+    double peak = 0.0;
+    for (int i = from; i < to; i++) {
+        if (fabs(scratch[i]) > peak) peak = fabs(scratch[i]);
+    }
+    
+    // Reflections land at most their reach from the base delay
+    lo = lo - pad > 0 ? lo - pad : 0;
+    hi = hi + pad < length ? hi + pad : length;
+    memset(scratch + lo, 0, (hi - lo) * sizeof(double));
+    return peak;
+}
+
+// Peak the complete IR will have, from a pilot of its tail drawn over the
+// early reflections (before any tail reflection is in the IR). Sparse
+// reflections find where the tail is loudest but miss the overlaps that set
+// its peak there, so only those cells are drawn at full density and measured
+// after the tone filter. Works in gen_tail_ir, which it leaves zeroed, and
+// restores the random state: the real draw is unchanged
+static double estimate_ir_peak() {
+    double* scratch = gen_tail_ir;
+    const double* ir = engine.impulse_response;
+    int length = engine.ir_length;
+    int count = ir_gen.num_reflections;
+    int cells = (length + IR_PILOT_CELL - 1) / IR_PILOT_CELL;
+    uint32_t rand_state = engine.rand_state;
+    double peak = 0.0;
+    
+    // Only ranks the cells, so the taps are left unshaped; the early
+    // reflections are added while the scratch is read back and cleared
+    for (int n = 0; n < count; n += IR_PILOT_STRIDE) {
+        add_reverb_reflection(scratch, length, ir_gen.tail_start, reflection_index(n, count),
+                              reflection_base(fast_rand()));
+    }
+    for (int c = 0; c < cells; c++) {
+        int end = (c + 1) * IR_PILOT_CELL < length ? (c + 1) * IR_PILOT_CELL : length;
+        double loudest = 0.0;
+        for (int i = c * IR_PILOT_CELL; i < end; i++) {
+            double tap = fabs(scratch[i] + ir[i]);
+            if (tap > loudest) loudest = tap;
+            scratch[i] = 0.0;
+        }
+        pilot_cell_peak[c] = loudest;
+    }
+    
+    // Mark the loudest cells; adjacent marked cells make one window
+    for (int k = 0; k < IR_PILOT_CELLS; k++) {
+        int loudest = 0;
+        for (int c = 1; c < cells; c++) {
+            if (pilot_cell_peak[c] > pilot_cell_peak[loudest]) loudest = c;
+        }
+        if (pilot_cell_peak[loudest] <= 0.0) break;
+        pilot_cell_peak[loudest] = -1.0;
+    }
+    int run_from = -1, run_to = -1;
+    for (int c = 0; c < cells; c++) {
+        if (pilot_cell_peak[c] >= 0.0) continue;
+        if (run_to == c * IR_PILOT_CELL) {
+            run_to += IR_PILOT_CELL;
+            continue;
+        }
+        if (run_from >= 0) peak = fmax(peak, pilot_window_peak(run_from, run_to));
+        run_from = c * IR_PILOT_CELL;
+        run_to = run_from + IR_PILOT_CELL;
+    }
+    if (run_from >= 0) peak = fmax(peak, pilot_window_peak(run_from, run_to));
+    
+    engine.rand_state = rand_state;
+    return peak;
+}
+
+static void complete_impulse_response();
+
+// Draw the reflections up to base delay ir_gen.target (at most budget of
+// them), shape the taps they made final and publish them. Completes the IR
+// once every reflection is in
+static void step_impulse_response(int budget) {
+    double* ir = engine.impulse_response;
+    int length = engine.ir_length;
+    
+    for (int drawn = 0; ir_gen.next_reflection < ir_gen.num_reflections &&
+                        ir_gen.next_base < ir_gen.target && drawn < budget; drawn++) {
+        add_reverb_reflection(ir, length, ir_gen.tail_start,
+                              reflection_index(ir_gen.next_reflection, ir_gen.num_reflections),
+                              ir_gen.next_base);
+        ir_gen.next_reflection++;
+        draw_next_base();
+    }
+    ir_gen.steps++;
+    
+    int done = ir_gen.next_reflection == ir_gen.num_reflections;
+    int final = done ? length : ir_gen.next_base - ir_gen.reach;
+    if (final > length) final = length;
+    
+    // Same tone filter as apply_spectral_shaping(), resumed where it stopped
+    double lp_cutoff, hp_cutoff;
+    spectral_shaping_coefficients(&lp_cutoff, &hp_cutoff);
+    for (int i = ir_gen.shaped; i < final; i++) {
+        ir_gen.lp_state = flush_denormal(ir_gen.lp_state + (ir[i] - ir_gen.lp_state) * lp_cutoff);
+        ir[i] = ir_gen.lp_state;
+        ir_gen.hp_state = flush_denormal(ir_gen.hp_state + (ir[i] - ir_gen.hp_state) * hp_cutoff);
+        ir[i] = flush_denormal(ir[i] - ir_gen.hp_state);
+        if (fabs(ir[i]) > ir_gen.peak) ir_gen.peak = fabs(ir[i]);
+    }
+    if (final > ir_gen.shaped) ir_gen.shaped = final;
+    
+    if (ir_gen.progressive) {
+        publish_ir_prefix();
+    }
+    if (done) {
+        complete_impulse_response();
+    }
+}
+
+// Samples of IR the current decay time generates
+static int generated_ir_length() {
+    int length = (int)(engine.decay_time * engine.sample_rate);
+    if (length > MAX_IR_SIZE) {
+        length = MAX_IR_SIZE;
+    }
+    if (length < engine.sample_rate / 2) {
+        length = engine.sample_rate / 2;
+    }
+    return length;
+}
+
+// Start a new IR: lay out memory, place the early reflections and, when the
+// layout allows, publish the first IR_GEN_FIRST_MS of the tail. The rest is
+// drawn by step_impulse_response(); without progressive publishing (or when
+// allow_progressive is 0) the whole IR is generated here
+static void begin_impulse_response(int allow_progressive) {
+    // A staged or built-in IR for these settings needs no synthesis
+    if (load_prepared_ir() == 0) return;
+    
+    printf("\n=== GENERATING NEW IMPULSE RESPONSE ===\n");
+    
+    enable_denormal_flushing();
+    memset(&ir_gen, 0, sizeof(ir_gen));
+    engine.ir_needs_update = 0;
+    
+    // A generated IR replaces any sampled one, even half uploaded
+    ir_upload.active = 0;
+    ir_upload.loaded = 0;
+    
+    engine.ir_length = generated_ir_length();
+    
+    // Fresh arena layout; the IR comes back zeroed
+    if (configure_engine_memory(engine.ir_length) != 0) {
+        printf("  WARNING: out of memory for a %d sample IR - passing audio through\n",
+               engine.ir_length);
+        engine.ir_length = 0;
+        engine.ir_effective_length = 0;
+        return;
+    }
+    engine.ir_effective_length = engine.ir_length;
+    
+    int pre_delay_samples = (int)(engine.pre_delay * engine.sample_rate / 1000.0);
+    
+    // Generate early reflections
+    generate_early_reflections(engine.impulse_response, engine.ir_length, pre_delay_samples);
+    
+    // Reverb tail, drawn in order of delay
+    ir_gen.active = 1;
+    ir_gen.tail_start = pre_delay_samples + (int)(0.02 * engine.sample_rate);
+    ir_gen.reach = reflection_reach(engine.ir_length);
+    ir_gen.num_reflections = reverb_reflection_count(engine.ir_length);
+    ir_gen.remaining = 1.0;
+    draw_next_base();
+    
+    printf("  🌟 GENERATING %d QUANTUM REFLECTIONS FOR INFINITE TAIL 🌟\n", ir_gen.num_reflections);
+    
+    ir_gen.progressive = allow_progressive && progressive_layout();
+    if (ir_gen.progressive && begin_progressive_convolution() != 0) {
+        printf("  WARNING: arena too small for progressive generation\n");
+        ir_gen.progressive = 0;
+    }
+    
+    if (ir_gen.progressive) {
+        ir_gen.peak_estimate = estimate_ir_peak();
+        ir_gen.target = ir_gen.tail_start + (int)(IR_GEN_FIRST_MS * engine.sample_rate / 1000.0);
+    } else {
+        ir_gen.target = LLONG_MAX;
+    }
+    step_impulse_response(INT_MAX);
+}
+
+// Work for one process call of n samples: draw IR_GEN_LEAD * n samples of
+// delay further, at most IR_GEN_STEP_REFLECTIONS reflections per BLOCK_SIZE
+static void advance_impulse_response(int n) {
+    ir_gen.target += (long long)IR_GEN_LEAD * n;
+    step_impulse_response(IR_GEN_STEP_REFLECTIONS * ((n + BLOCK_SIZE - 1) / BLOCK_SIZE));
+}
+
+// Run a generation under way to the end
+static void finish_impulse_response() {
+    if (!ir_gen.active) return;
+    ir_gen.target = LLONG_MAX;
+    step_impulse_response(INT_MAX);
+}
+
+// Generate the whole IR before returning
+static void generate_impulse_response() {
+    begin_impulse_response(0);
+}
+
+// Every tap is drawn and shaped: normalize, trim and either finish the
+// published convolver in place or split the IR from scratch
+static void complete_impulse_response() {
+    double* ir = engine.impulse_response;
+    
+    // Normalize with COSMIC SCALE BOOST - WE'RE GOING INTERSTELLAR!
+    double max_val = ir_gen.peak;
+    double rms = 0.0;
+    double norm_factor = 1.0;
+    
+    for (int i = 0; i < engine.ir_length; i++) {
+        rms += ir[i] * ir[i];
+    }
+    rms = sqrt(rms / engine.ir_length);
+    
+    if (max_val > 0.0) {
+        norm_factor = normalization_factor(max_val, 1);
+        
+        // Apply the cosmic boost with HARMONIC ENHANCEMENT
+        for (int i = 0; i < engine.ir_length; i++) {
+            ir[i] = normalized_tap(ir[i], i, norm_factor);
+        }
+        
+        rms *= norm_factor;
+        
+        printf("  🌌💫 CONVOLUTION MATRIX HYPERCHARGED: %.1fx boost applied! 💫🌌\n", norm_factor);
+    }
+    ir_norm_factor = norm_factor;
+    ir_gen.active = 0;
+    
+    // Drop the inaudible end of the tail - convolution cost scales with this
+    update_effective_length();
+    
+    // The published convolver stays unless its layout no longer matches:
+    // trimmed partitions are dropped and the level glides to the exact one
+    int keep = ir_gen.progressive && tail_convolver_ready && ir_gen.norm > 0.0 &&
+               thickening_layers() == tail_layered && progressive_layout();
+    for (int i = 0; i < early.num_taps && keep; i++) {
+        keep = early.taps[i].delay + early.spread < engine.ir_effective_length;
+    }
+    
+    if (keep) {
+        fft_convolver_truncate(&tail_convolver, convolved_length());
+        glide_wet_correction(norm_factor / ir_gen.norm);
+        printf("  ⏩ PROGRESSIVE IR: complete after %d steps, level x%.1f -> x%.1f, %d/%d partitions kept\n",
+               ir_gen.steps, ir_gen.norm, norm_factor, tail_convolver.num_active,
+               tail_convolver.num_partitions);
+    } else {
+        // Split into early taps + FFT tail
+        prepare_convolution();
+    }
+    
+    // Debug output with extended type names
     const char* type_names[] = {
         "Hall", "Cathedral", "Room", "Plate", "Spring", 
         "Cave", "Shimmer", "Freeze", "Reverse", "Gated",
@@ -670,6 +2343,8 @@ static void generate_impulse_response() {
     printf("Generated %s IR\n", type_names[type_index]);
     printf("  Length: %d samples (%.2fs)\n", 
            engine.ir_length, (double)engine.ir_length / engine.sample_rate);
+    printf("  Effective length: %d samples (%.2fs)\n",
+           engine.ir_effective_length, (double)engine.ir_effective_length / engine.sample_rate);
     printf("  Parameters: room=%.1f, decay=%.1f, delay=%.1f, damp=%.1f\n",
            engine.room_size, engine.decay_time, engine.pre_delay, engine.damping);
     printf("  Mix=%.1f, diffusion=%.1f, early=%.1f\n",
@@ -678,32 +2353,503 @@ static void generate_impulse_response() {
     printf("=== IR GENERATION COMPLETE ===\n");
 }
 
+// Blackman-windowed sinc over IR_RESAMPLE_ZEROS zero crossings, tabulated
+// once at IR_RESAMPLE_PHASES points per crossing
+static void build_resample_kernel() {
+    if (resample_kernel_ready) return;
+    
+    int points = IR_RESAMPLE_ZEROS * IR_RESAMPLE_PHASES;
+    for (int i = 0; i <= points; i++) {
+        double x = (double)i / IR_RESAMPLE_PHASES;
+        double sinc = i == 0 ? 1.0 : sin(PI * x) / (PI * x);
+        double w = 0.42 + 0.5 * cos(PI * x / IR_RESAMPLE_ZEROS) +
+                   0.08 * cos(TWO_PI * x / IR_RESAMPLE_ZEROS);
+        resample_kernel[i] = sinc * w;
+    }
+    resample_kernel[points + 1] = 0.0;
+    resample_kernel_ready = 1;
+}
+
+// Kernel value x zero crossings from its centre
+static inline double resample_kernel_at(double x) {
+    double pos = fabs(x) * IR_RESAMPLE_PHASES;
+    int i = (int)pos;
+    if (i >= IR_RESAMPLE_ZEROS * IR_RESAMPLE_PHASES) return 0.0;
+    double frac = pos - i;
+    return resample_kernel[i] + (resample_kernel[i + 1] - resample_kernel[i]) * frac;
+}
+
+// Tap k can be resampled once the ring holds the last frame its kernel reads
+static int ir_tap_ready(int k) {
+    if (ir_upload.received == ir_upload.source_frames) return 1;
+    if (ir_upload.direct) return k < ir_upload.received;
+    return (long long)floor(k * ir_upload.step + ir_upload.half_width) < ir_upload.received;
+}
+
+static double resample_tap(int k) {
+    if (ir_upload.direct) {
+        return ir_upload.ring[k & (IR_RESAMPLE_RING - 1)];
+    }
+    
+    double t = k * ir_upload.step;
+    int first = (int)ceil(t - ir_upload.half_width);
+    int last = (int)floor(t + ir_upload.half_width);
+    if (first < 0) first = 0;
+    if (last > ir_upload.source_frames - 1) last = ir_upload.source_frames - 1;
+    
+    double sum = 0.0;
+    for (int m = first; m <= last; m++) {
+        sum += ir_upload.ring[m & (IR_RESAMPLE_RING - 1)] * resample_kernel_at((t - m) * ir_upload.cutoff);
+    }
+    return sum * ir_upload.cutoff;
+}
+
+// Write every tap the frames received so far complete
+static void emit_ready_taps() {
+    double* ir = engine.impulse_response;
+    while (ir_upload.written < engine.ir_length && ir_tap_ready(ir_upload.written)) {
+        double tap = resample_tap(ir_upload.written);
+        ir[ir_upload.written++] = tap;
+        ir_upload.energy += tap * tap;
+    }
+}
+
+// Mix interleaved frames down to mono into the ring, resampling as they come
+static void consume_ir_frames(const float* samples, int frames) {
+    int channels = ir_upload.channels;
+    for (int f = 0; f < frames && ir_upload.received < ir_upload.source_frames; f++) {
+        double sum = 0.0;
+        for (int c = 0; c < channels; c++) {
+            sum += samples[f * channels + c];
+        }
+        ir_upload.ring[ir_upload.received & (IR_RESAMPLE_RING - 1)] = sum / channels;
+        ir_upload.received++;
+        emit_ready_taps();
+    }
+}
+
+// Grow the arena for the current layout, carrying the IR across
+static int grow_arena_keeping_ir() {
+    int length = engine.ir_length;
+    double* copy = (double*)malloc(length * sizeof(double));
+    if (!copy) return -1;
+    memcpy(copy, engine.impulse_response, length * sizeof(double));
+    
+    int result = configure_engine_memory(length);
+    if (result == 0) {
+        memcpy(engine.impulse_response, copy, length * sizeof(double));
+    } else {
+        printf("  WARNING: out of memory for the sampled IR - passing audio through\n");
+        engine.ir_length = 0;
+        engine.ir_effective_length = 0;
+        ir_upload.loaded = 0;
+    }
+    free(copy);
+    return result;
+}
+
+// Split a loaded sampled IR again after a layout parameter changed
+static void rebuild_sampled_convolution() {
+    if (engine_memory_bytes(engine.ir_length) > engine_arena.size && grow_arena_keeping_ir() != 0) {
+        return;
+    }
+    prepare_convolution();
+}
+
+// Put the taps written since the last publish into the running convolver.
+// The first publish fixes their scale from the energy so far; the wet level
+// then glides as the energy grows, so the published response always plays at
+// SAMPLED_IR_ENERGY
+static void publish_ir_samples() {
+    if (ir_upload.norm == 0.0) {
+        if (ir_upload.energy <= 0.0) return;
+        ir_upload.norm = sqrt(SAMPLED_IR_ENERGY / ir_upload.energy);
+        printf("  📼 SAMPLED IR: first %.0f ms live after %d of %d frames (level x%.2f)\n",
+               1000.0 * ir_upload.written / engine.sample_rate, ir_upload.received,
+               ir_upload.source_frames, ir_upload.norm);
+    }
+    
+    for (int j = ir_upload.published; j < ir_upload.written; j++) {
+        gen_tail_ir[j] = engine.impulse_response[j] * ir_upload.norm;
+        ir_upload.published_energy += gen_tail_ir[j] * gen_tail_ir[j];
+    }
+    ir_upload.published = ir_upload.written;
+    
+    fft_convolver_load(&tail_convolver, gen_tail_ir, ir_upload.written,
+                       ir_upload.published_energy * FFT_CONVOLVER_PARTITION_FLOOR);
+    glide_wet_correction(sqrt(SAMPLED_IR_ENERGY / ir_upload.energy) / ir_upload.norm);
+}
+
+// Every tap is in: normalize, trim and finish the published convolver or
+// split the IR from scratch
+static void complete_ir_upload() {
+    double* ir = engine.impulse_response;
+    double norm = 1.0;
+    
+    if (ir_upload.energy > 0.0) {
+        norm = sqrt(SAMPLED_IR_ENERGY / ir_upload.energy);
+    } else {
+        printf("  WARNING: the sampled IR is silent\n");
+    }
+    for (int i = 0; i < engine.ir_length; i++) {
+        ir[i] *= norm;
+    }
+    ir_upload.active = 0;
+    
+    update_effective_length();
+    
+    int keep = ir_upload.progressive && tail_convolver_ready && ir_upload.norm > 0.0 &&
+               uniform_layout();
+    if (keep) {
+        fft_convolver_truncate(&tail_convolver, convolved_length());
+        glide_wet_correction(norm / ir_upload.norm);
+        printf("  📼 SAMPLED IR: complete, level x%.2f -> x%.2f, %d/%d partitions kept\n",
+               ir_upload.norm, norm, tail_convolver.num_active, tail_convolver.num_partitions);
+    } else {
+        rebuild_sampled_convolution();
+        printf("  📼 SAMPLED IR: complete, level x%.2f\n", norm);
+    }
+}
+
+// Start replacing the IR with frames source frames of channels interleaved
+// channels at source_rate. Returns 0, or -1 if the format is unusable or the
+// IR does not fit in memory
+static int begin_ir_upload(int frames, int source_rate, int channels) {
+    if (!engine.initialized || frames < 1 || channels < 1 ||
+        source_rate < MIN_IR_SAMPLE_RATE || source_rate > MAX_IR_SAMPLE_RATE) {
+        printf("  WARNING: unusable IR samples (%d frames, %d Hz, %d channels)\n",
+               frames, source_rate, channels);
+        return -1;
+    }
+    
+    build_resample_kernel();
+    enable_denormal_flushing();
+    memset(&ir_upload, 0, sizeof(ir_upload));
+    ir_upload.source_rate = source_rate;
+    ir_upload.channels = channels;
+    ir_upload.source_frames = frames;
+    ir_upload.direct = source_rate == engine.sample_rate;
+    ir_upload.step = (double)source_rate / engine.sample_rate;
+    ir_upload.cutoff = fmin(1.0, 1.0 / ir_upload.step);
+    ir_upload.half_width = IR_RESAMPLE_ZEROS / ir_upload.cutoff;
+    
+    // The pending generated IR and its early path are replaced
+    memset(&ir_gen, 0, sizeof(ir_gen));
+    engine.ir_needs_update = 0;
+    early.num_taps = 0;
+    
+    long long length = ((long long)frames * engine.sample_rate + source_rate - 1) / source_rate;
+    engine.ir_length = length > MAX_IR_SIZE ? MAX_IR_SIZE : (int)length;
+    if (configure_engine_memory(engine.ir_length) != 0) {
+        printf("  WARNING: out of memory for a %d sample IR - passing audio through\n",
+               engine.ir_length);
+        engine.ir_length = 0;
+        engine.ir_effective_length = 0;
+        return -1;
+    }
+    engine.ir_effective_length = engine.ir_length;
+    ir_upload.active = 1;
+    ir_upload.loaded = 1;
+    
+    ir_upload.progressive = uniform_layout() && begin_progressive_convolution() == 0;
+    
+    printf("\n=== 📼 LOADING SAMPLED IR: %d frames x %d ch at %d Hz -> %d taps at %d Hz%s ===\n",
+           frames, channels, source_rate, engine.ir_length, engine.sample_rate,
+           ir_upload.progressive ? ", convolving as it arrives" : "");
+    return 0;
+}
+
+// Take the next frames of the upload. Returns the IR taps ready so far
+static int append_ir_upload(const float* samples, int frames) {
+    if (!ir_upload.active) {
+        // Frames past MAX_IR_SIZE are dropped
+        ir_upload.received = ir_upload.received + frames < ir_upload.source_frames ?
+                             ir_upload.received + frames : ir_upload.source_frames;
+        return engine.ir_length;
+    }
+    
+    consume_ir_frames(samples, frames);
+    if (ir_upload.progressive) {
+        publish_ir_samples();
+    }
+    if (ir_upload.written == engine.ir_length) {
+        complete_ir_upload();
+    }
+    return ir_upload.written;
+}
+
+// Hash of every setting the generator reads: a blob with this key holds an IR
+// these settings generate (up to the random draw)
+static uint32_t ir_cache_key() {
+    int ids[] = { engine.ir_type, engine.sample_rate };
+    double shape[] = { engine.room_size, engine.decay_time, engine.pre_delay, engine.damping,
+                       engine.diffusion, engine.low_freq, engine.high_freq, engine.early_reflections };
+    uint32_t hash = ir_cache_hash(IR_CACHE_HASH_SEED, ids, sizeof(ids));
+    return ir_cache_hash(hash, shape, sizeof(shape));
+}
+
+static int reserve_ir_cache(size_t bytes) {
+    if (bytes <= ir_cache_capacity) return 0;
+    unsigned char* grown = (unsigned char*)malloc(bytes);
+    if (!grown) return -1;
+    free(ir_cache_buffer);
+    ir_cache_buffer = grown;
+    ir_cache_capacity = bytes;
+    return 0;
+}
+
+// Lay out the uniform convolver and load the blob's spectra straight into it.
+// Returns -1 when they do not fit the current layout - the caller then
+// rebuilds from the IR
+static int restore_cached_spectra(const unsigned char* data, const IRCacheInfo* info) {
+    if (info->spectra_bytes == 0 || info->layered != thickening_layers() ||
+        info->effective_length != engine.ir_effective_length || !uniform_layout()) {
+        return -1;
+    }
+    
+    prepare_early_path(engine.ir_effective_length);
+    release_tail_stage();
+    tail_convolver_ready = 0;
+    arena_rewind(&engine_arena, arena_conv_mark);
+    if (fft_convolver_init_empty(&tail_convolver, &engine_arena, BLOCK_SIZE, convolved_length()) != 0 ||
+        fft_convolver_import(&tail_convolver, data + info->spectra_offset,
+                             info->spectra_bytes) != 0) {
+        return -1;
+    }
+    
+    tail_convolver_ready = 1;
+    tail_layered = info->layered;
+    early.gain = info->early_gain;
+    wet_correction = wet_correction_target = info->wet_gain;
+    wet_correction_step = 0.0;
+    reset_convolution_state();
+    return 0;
+}
+
+// Whether a parsed blob holds an IR the current settings generate. The
+// effective length is bounded by the ir_length the arena is laid out for
+static int ir_blob_matches(const IRCacheInfo* info) {
+    return info->key == ir_cache_key() && info->sample_rate == engine.sample_rate &&
+           info->ir_type == engine.ir_type && info->ir_length <= MAX_IR_SIZE &&
+           info->effective_length > 0 && info->effective_length <= info->ir_length &&
+           info->num_early_taps <= MAX_EARLY_TAPS && info->early_spread <= MAX_ER_SPREAD;
+}
+
+// Replace the IR with a matching blob, cancelling any generation or upload
+// under way. Returns 1 with its spectra loaded, 0 with the partitions rebuilt
+// from its IR, -1 out of memory
+static int restore_ir_blob(const unsigned char* data, const IRCacheInfo* info) {
+    enable_denormal_flushing();
+    memset(&ir_gen, 0, sizeof(ir_gen));
+    ir_upload.active = 0;
+    ir_upload.loaded = 0;
+    engine.ir_needs_update = 0;
+    
+    engine.ir_length = info->ir_length;
+    if (configure_engine_memory(engine.ir_length) != 0) {
+        printf("  WARNING: out of memory for a %d sample IR - passing audio through\n",
+               engine.ir_length);
+        engine.ir_length = 0;
+        engine.ir_effective_length = 0;
+        return -1;
+    }
+    
+    IRCacheTap taps[MAX_EARLY_TAPS];
+    ir_cache_read(data, info, early.kernel, taps, engine.impulse_response);
+    early.spread = info->early_spread;
+    early.num_taps = info->num_early_taps;
+    for (int i = 0; i < early.num_taps; i++) {
+        early.taps[i].delay = taps[i].delay;
+        early.taps[i].gain = taps[i].gain;
+    }
+    ir_norm_factor = info->norm_factor;
+    
+    if (info->trim_db == engine.ir_trim_db) {
+        engine.ir_effective_length = info->effective_length;
+    } else {
+        update_effective_length();
+    }
+    
+    if (restore_cached_spectra(data, info) == 0) return 1;
+    prepare_convolution();
+    return 0;
+}
+
+// Publish an IR made for the current settings without synthesis: the blob
+// staged by load_ir_cache_, else a built-in one. Returns -1 when there is none
+static int load_prepared_ir() {
+    IRCacheInfo info;
+    if (ir_cache_staged > 0 && ir_cache_parse(ir_cache_buffer, ir_cache_staged, &info) == 0 &&
+        ir_blob_matches(&info)) {
+        ir_cache_staged = 0;
+        if (restore_ir_blob(ir_cache_buffer, &info) < 0) return -1;
+        printf("  💾 IR CACHE: staged %d-sample IR taken, no synthesis\n", engine.ir_length);
+        return 0;
+    }
+    
+#ifdef HAVE_DEFAULT_IRS
+    for (int i = 0; i < DEFAULT_IR_COUNT; i++) {
+        if (ir_cache_parse(default_ir_data[i], default_ir_size[i], &info) != 0 ||
+            !ir_blob_matches(&info)) {
+            continue;
+        }
+        if (restore_ir_blob(default_ir_data[i], &info) < 0) return -1;
+        printf("  📦 DEFAULT IR: published built-in %d-sample IR, no synthesis\n", engine.ir_length);
+        return 0;
+    }
+#endif
+    return -1;
+}
+
+// Rebuild the convolvers when a layout input (wisdom, host block) changed the
+// selected partitioning, growing the arena first if the new layout needs it
+static void apply_partition_layout() {
+    if (!engine.initialized || engine.ir_needs_update || ir_gen.active || ir_upload.active ||
+        !engine.impulse_response) return;
+    if (late_tail_ready || fdn_tail_ready || velvet_tail_ready) return;   // Hybrid layouts do not use wisdom
+    
+    int current = tail_stage_ready ? tail_stage.block_size : 0;
+    if (tail_convolver_ready && select_tail_block(convolved_length()) == current) return;
+    
+    if (ir_upload.loaded) {
+        rebuild_sampled_convolution();
+    } else if (engine_memory_bytes(engine.ir_length) > engine_arena.size) {
+        generate_impulse_response();
+    } else {
+        prepare_convolution();
+    }
+}
+
+// Next sample of the early reflection path; conv_history[history_pos] must
+// already hold the current input sample.
+static inline double early_reflection_sample() {
+    if (early.num_taps == 0) return 0.0;
+    
+    if (early.modulated && early.mod_counter-- <= 0) {
+        early.mod_counter = ER_MOD_INTERVAL - 1;
+        for (int i = 0; i < early.num_taps; i++) {
+            EarlyTap* tap = &early.taps[i];
+            tap->mod_phase += tap->mod_step;
+            if (tap->mod_phase > TWO_PI) tap->mod_phase -= TWO_PI;
+            tap->mod_offset = tap->mod_depth * fast_sin(tap->mod_phase);
+        }
+    }
+    
+    // Sparse tap sum, read early by the kernel half-width so the kernel stays causal
+    int history_mask = history_size - 1;
+    double sum = 0.0;
+    for (int i = 0; i < early.num_taps; i++) {
+        const EarlyTap* tap = &early.taps[i];
+        
+        if (early.modulated) {
+            double lag = tap->delay - early.spread + tap->mod_offset;
+            int whole = (int)lag;
+            double frac = lag - whole;
+            int idx0 = (history_pos - whole) & history_mask;
+            int idx1 = (idx0 - 1) & history_mask;
+            sum += tap->gain * (conv_history[idx0] + frac * (conv_history[idx1] - conv_history[idx0]));
+        } else {
+            int idx = (history_pos - (tap->delay - early.spread)) & history_mask;
+            sum += tap->gain * conv_history[idx];
+        }
+    }
+    
+    // Diffusion kernel
+    int width = 2 * early.spread + 1;
+    early.spread_line[early.spread_pos] = sum;
+    double diffused = 0.0;
+    for (int k = 0, idx = early.spread_pos; k < width; k++) {
+        diffused += early.kernel[k] * early.spread_line[idx];
+        if (--idx < 0) idx = width - 1;
+    }
+    if (++early.spread_pos >= width) early.spread_pos = 0;
+    
+    // Tone filter, identical to apply_spectral_shaping()
+    early.lp_state = flush_denormal(early.lp_state + (diffused - early.lp_state) * early.lp_coeff);
+    double shaped = early.lp_state;
+    early.hp_state = flush_denormal(early.hp_state + (shaped - early.hp_state) * early.hp_coeff);
+    shaped -= early.hp_state;
+    
+    return shaped * early.gain;
+}
+
+// Host audio buffers: exactly one input and one output pointer is set, so the
+// float32 and float64 entry points share one processing path
+typedef struct {
+    const double* in64;
+    const float* in32;
+    double* out64;
+    float* out32;
+} AudioIO;
+
+static inline double io_input(const AudioIO* io, int i) {
+    return io->in64 ? io->in64[i] : io->in32[i];
+}
+
+static inline void io_output(const AudioIO* io, int i, double value) {
+    if (io->out64) {
+        io->out64[i] = value;
+    } else {
+        io->out32[i] = (float)value;
+    }
+}
+
+static void io_passthrough(const AudioIO* io, int n, double gain) {
+    for (int i = 0; i < n; i++) {
+        io_output(io, i, gain * io_input(io, i));
+    }
+}
+
 // Process audio with convolution - ENHANCED VERSION
-void process_convolution_(double* input, double* output, int* num_samples) {
-    int n = *num_samples;
+static void process_convolution_io(const AudioIO* io, int n) {
+    // Cheap no-op once set; the audio thread may not be the one that initialized us
+    enable_denormal_flushing();
     
     // Initialize if needed
-    if (!engine.initialized || !engine.impulse_response) {
-        memcpy(output, input, n * sizeof(double));
+    if (!engine.initialized) {
+        io_passthrough(io, n, 1.0);
         return;
     }
     
-    // ALWAYS check and update IR if needed
-    if (engine.ir_needs_update) {
+    // Audio before the asynchronous start-up finished: the IR is built on
+    // demand from here on, as after a synchronous init
+    init_pending = 0;
+    
+    // The modal engine renders Plate and Spring without an IR; any pending
+    // regeneration waits until the convolution path is needed again
+    int modal = modal_engine_active();
+    if (modal && modal_bank_type != engine.ir_type) {
+        update_modal_bank();
+    }
+    
+    // ALWAYS check and update IR if needed - a regeneration publishes its
+    // first partitions now and fills the tail in over the following calls
+    if (engine.ir_needs_update && !modal) {
         printf("process_convolution_: IR needs update, regenerating...\n");
-        generate_impulse_response();
-        
-        // Clear convolution history
-        if (conv_history) {
-            memset(conv_history, 0, MAX_IR_SIZE * sizeof(double));
+        begin_impulse_response(1);
+    } else if (ir_gen.active && !modal) {
+        advance_impulse_response(n);
+    }
+    
+    // The thickening layers live in the tail IR - rebuild it when mix crosses 30%
+    // (a generation or upload under way picks the change up when it completes).
+    // The live convolver plays on while the rebuild advances with the audio
+    if (!modal && engine.impulse_response && !ir_gen.active && !ir_upload.active) {
+        if (!tail_convolver_ready) {
+            prepare_convolution();
+        } else if (thickening_layers() != (rebuild.active ? rebuild.layered : tail_layered)) {
+            request_layout_rebuild(0);
         }
-        history_pos = 0;
+        for (int done = 0; done < n && rebuild.active; done += BLOCK_SIZE) {
+            step_layout_rebuild(1);
+        }
+        release_rebuild_arena();
     }
     
-    // Allocate convolution history buffer if needed
-    if (!conv_history) {
-        conv_history = (double*)calloc(MAX_IR_SIZE, sizeof(double));
-        history_pos = 0;
+    // Buffers could not be allocated - pass the audio through untouched
+    if (!modal && (!engine.impulse_response || !conv_history)) {
+        io_passthrough(io, n, 1.0);
+        return;
     }
     
     // Calculate mix parameters - 🌌 CONVOLUTION SINGULARITY MODE 🌌
@@ -780,63 +2926,496 @@ void process_convolution_(double* input, double* output, int* num_samples) {
         }
     }
     
-    // Process each sample
-    for (int i = 0; i < n; i++) {
-        // Store input in circular buffer
-        conv_history[history_pos] = input[i];
-        
-        // PERFORM CONVOLUTION WITH PARALLEL UNIVERSE PROCESSING
-        double wet_sample = 0.0;
-        double wet_sample_delayed = 0.0;  // Second layer for DEPTH
-        double wet_sample_shimmer = 0.0;  // Third layer for SPARKLE
+    // Input silence: nothing in this call would reach the output above the floor
+    int last_loud = -1;
+    double loud_level = BYPASS_NOISE_FLOOR / (dry_gain + wet_gain + 1e-30);
+    for (int i = n - 1; i >= 0; i--) {
+        if (fabs(io_input(io, i)) > loud_level) {
+            last_loud = i;
+            break;
+        }
+    }
+    int input_silent = last_loud < 0;
+    
+    // Tail-aware auto-bypass: enter once the tail has run its full course and
+    // the wet output has actually died away, leave on the first non-silent call
+    if (input_silent && !silence.bypassed &&
+        silence.silent_samples >= tail_length_samples() &&
+        silence.last_wet_peak * wet_gain <= BYPASS_NOISE_FLOOR) {
+        silence.bypassed = 1;
+        // Nothing wet plays while bypassed, so a glide under way (or one a
+        // type change starts meanwhile) has nothing to smooth: land on it
+        wet_correction = wet_correction_target;
+        wet_correction_step = 0.0;
+        printf("  💤 AUTO-BYPASS: input silent and tail decayed - copying dry audio only\n");
+    } else if (!input_silent && silence.bypassed) {
+        silence.bypassed = 0;
+        reset_convolution_state();
+        wet_correction = wet_correction_target;
+        wet_correction_step = 0.0;
+        printf("  🔊 AUTO-BYPASS OFF: signal returned - convolution resumed\n");
+    }
+    
+    if (silence.bypassed) {
+        io_passthrough(io, n, dry_gain);
+        silence.silent_samples += n;
+        return;
+    }
+    
+    double wet_peak = 0.0;
+    
+    // Process in chunks: FFT tail for the whole chunk, then early taps per sample
+    conv_sample_t in_block[WET_CHUNK_SIZE];
+    conv_sample_t wet_block[WET_CHUNK_SIZE];
+    
+    for (int offset = 0; offset < n; offset += WET_CHUNK_SIZE) {
+        int count = n - offset < WET_CHUNK_SIZE ? n - offset : WET_CHUNK_SIZE;
         
-        int ir_len = engine.ir_length;
+        // Host samples in the convolver's precision
+        for (int i = 0; i < count; i++) {
+            in_block[i] = (conv_sample_t)io_input(io, offset + i);
+        }
         
-        // Primary convolution
-        for (int j = 0; j < ir_len; j++) {
-            int hist_idx = (history_pos - j + MAX_IR_SIZE) % MAX_IR_SIZE;
-            wet_sample += conv_history[hist_idx] * engine.impulse_response[j];
+        if (modal) {
+            memset(wet_block, 0, count * sizeof(conv_sample_t));
+            modal_bank_process(&modal_bank, in_block, wet_block, count);
+        } else if (tail_convolver_ready) {
+            fft_convolver_process(&tail_convolver, in_block, wet_block, count);
+            if (retired.fade_left > 0) {
+                fade_out_retired(in_block, wet_block, count);
+            }
+            if (tail_stage_ready) {
+                tail_stage_process(&tail_stage, in_block, wet_block, count);
+            }
+            if (late_tail_ready) {
+                multirate_tail_process(&late_tail, in_block, wet_block, count);
+            }
+            if (fdn_tail_ready) {
+                fdn_tail_process(&fdn_tail, in_block, wet_block, count);
+            }
+            if (velvet_tail_ready) {
+                velvet_tail_process(&velvet_tail, in_block, wet_block, count);
+            }
+        } else {
+            memset(wet_block, 0, count * sizeof(conv_sample_t));
         }
         
-        // Add subtle pitch-shifted layers for THICKNESS (simple delay-based)
-        if (engine.mix_level > 30) {
-            for (int j = 0; j < ir_len; j += 2) {  // Slight decimation for pitch up
-                int hist_idx = (history_pos - j + MAX_IR_SIZE) % MAX_IR_SIZE;
-                wet_sample_shimmer += conv_history[hist_idx] * engine.impulse_response[j] * 0.3;
+        for (int i = offset; i < offset + count; i++) {
+            double dry = io_input(io, i);
+            
+            // Late tail (FFT partitions or modes) + early reflections (sparse taps)
+            double wet_sample = wet_block[i - offset];
+            if (!modal) {
+                // Store input in circular buffer
+                conv_history[history_pos] = flush_denormal(dry);
+                wet_sample += early_reflection_sample();
+                
+                // Advance circular buffer
+                history_pos = (history_pos + 1) & (history_size - 1);
+                
+                // A progressively published IR glides to its final level
+                if (wet_correction != wet_correction_target) {
+                    wet_correction += wet_correction_step;
+                    if ((wet_correction_step > 0.0) == (wet_correction > wet_correction_target)) {
+                        wet_correction = wet_correction_target;
+                    }
+                }
+                wet_sample *= wet_correction;
             }
+            if (fabs(wet_sample) > wet_peak) wet_peak = fabs(wet_sample);
             
-            for (int j = 0; j < ir_len && j < ir_len - 1; j++) {  // Interpolation for pitch down
-                int hist_idx = (history_pos - (j * 3 / 2) + MAX_IR_SIZE) % MAX_IR_SIZE;
-                wet_sample_delayed += conv_history[hist_idx] * engine.impulse_response[j] * 0.2;
+            // Mix dry and wet signals with CONVOLUTION SUPREMACY
+            double out = dry_gain * dry + wet_gain * wet_sample;
+            
+            // Advanced multiband compression for HUGE levels without distortion
+            double abs_out = fabs(out);
+            if (abs_out > 0.7) {
+                // Smooth compression curve
+                double sign = out > 0 ? 1.0 : -1.0;
+                double compressed = 0.7 + (abs_out - 0.7) * 0.3;  // 3:1 compression above 0.7
+                compressed = fmin(compressed, 1.8);  // Soft ceiling at 1.8
+                out = sign * compressed;
+            }
+            
+            // Final limiter with smooth saturation
+            if (out > 1.9) {
+                out = 1.9 + 0.1 * tanh((out - 1.9) * 10.0);
+            } else if (out < -1.9) {
+                out = -1.9 - 0.1 * tanh((-out - 1.9) * 10.0);
             }
+            
+            io_output(io, i, out);
         }
+    }
+    
+    silence.last_wet_peak = wet_peak;
+    if (input_silent) {
+        silence.silent_samples += n;
+    } else {
+        silence.silent_samples = n - 1 - last_loud;
+    }
+}
+
+void process_convolution_(double* input, double* output, int* num_samples) {
+    AudioIO io = { input, NULL, output, NULL };
+    process_convolution_io(&io, *num_samples);
+}
+
+// Float32 host buffers (Web Audio's native format) - no JS-side conversion
+void process_convolution_f32_(float* input, float* output, int* num_samples) {
+    AudioIO io = { NULL, input, NULL, output };
+    process_convolution_io(&io, *num_samples);
+}
+
+// Engine-owned I/O buffers: hosts write into the input buffers, call
+// process_io_buffers_ and read the output buffers, with no allocation or
+// pointer juggling per block. NULL for channels out of range.
+float* get_input_buffer_(int* channel) {
+    if (*channel < 0 || *channel >= MAX_IO_CHANNELS) return NULL;
+    return io_input_buffers[*channel];
+}
+
+float* get_output_buffer_(int* channel) {
+    if (*channel < 0 || *channel >= MAX_IO_CHANNELS) return NULL;
+    return io_output_buffers[*channel];
+}
+
+int get_io_buffer_frames_() {
+    return IO_BUFFER_FRAMES;
+}
+
+// The engine is mono: stereo input is summed to mono in place in channel 0,
+// and the reverb output is copied to every output channel
+void process_io_buffers_(int* num_samples, int* num_channels) {
+    int n = *num_samples;
+    int channels = *num_channels;
+    if (n > IO_BUFFER_FRAMES) n = IO_BUFFER_FRAMES;
+    if (n <= 0) return;
+    if (channels < 1) channels = 1;
+    if (channels > MAX_IO_CHANNELS) channels = MAX_IO_CHANNELS;
+    
+    float* in = io_input_buffers[0];
+    if (channels == 2) {
+        const float* right = io_input_buffers[1];
+        for (int i = 0; i < n; i++) {
+            in[i] = 0.5f * (in[i] + right[i]);
+        }
+    }
+    
+    process_convolution_f32_(in, io_output_buffers[0], &n);
+    
+    for (int ch = 1; ch < channels; ch++) {
+        memcpy(io_output_buffers[ch], io_output_buffers[0], n * sizeof(float));
+    }
+}
+
+// Wall-clock microseconds for calibration (natively, clock() would also count
+// the tail stage's worker threads)
+static double tuning_now_us() {
+#ifdef __EMSCRIPTEN__
+    return emscripten_get_now() * 1000.0;
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1e6 + now.tv_nsec / 1e3;
+#endif
+}
+
+// Mean and peak time of one process call of host_block samples through the
+// convolvers of the current layout (the only part of the engine the layout
+// changes). Best of TUNING_PASSES, so scheduler noise does not pick the winner
+static void measure_layout(int host_block, const conv_sample_t* input, int length,
+                           double* avg_us, double* peak_us) {
+    conv_sample_t wet[WET_CHUNK_SIZE];
+    
+    // Warm up until every partition sees signal, as in steady playback
+    for (int done = 0; done < convolved_length() + length; done += WET_CHUNK_SIZE) {
+        fft_convolver_process(&tail_convolver, input, wet, WET_CHUNK_SIZE);
+        if (tail_stage_ready) {
+            tail_stage_process(&tail_stage, input, wet, WET_CHUNK_SIZE);
+        }
+    }
+    
+    *avg_us = 1e30;
+    *peak_us = 1e30;
+    
+    for (int pass = 0; pass < TUNING_PASSES; pass++) {
+        double total = 0.0;
+        double peak = 0.0;
+        int calls = 0;
         
-        // Combine all layers
-        wet_sample = wet_sample + wet_sample_delayed + wet_sample_shimmer;
-        
-        // Mix dry and wet signals with CONVOLUTION SUPREMACY
-        output[i] = dry_gain * input[i] + wet_gain * wet_sample;
-        
-        // Advanced multiband compression for HUGE levels without distortion
-        double abs_out = fabs(output[i]);
-        if (abs_out > 0.7) {
-            // Smooth compression curve
-            double sign = output[i] > 0 ? 1.0 : -1.0;
-            double compressed = 0.7 + (abs_out - 0.7) * 0.3;  // 3:1 compression above 0.7
-            compressed = fmin(compressed, 1.8);  // Soft ceiling at 1.8
-            output[i] = sign * compressed;
+        for (int offset = 0; offset + host_block <= length; offset += host_block) {
+            double start = tuning_now_us();
+            for (int done = 0; done < host_block; done += WET_CHUNK_SIZE) {
+                int count = host_block - done < WET_CHUNK_SIZE ? host_block - done : WET_CHUNK_SIZE;
+                fft_convolver_process(&tail_convolver, input + offset + done, wet, count);
+                if (tail_stage_ready) {
+                    tail_stage_process(&tail_stage, input + offset + done, wet, count);
+                }
+            }
+            double us = tuning_now_us() - start;
+            
+            total += us;
+            if (us > peak) peak = us;
+            calls++;
         }
         
-        // Final limiter with smooth saturation
-        if (output[i] > 1.9) {
-            output[i] = 1.9 + 0.1 * tanh((output[i] - 1.9) * 10.0);
-        } else if (output[i] < -1.9) {
-            output[i] = -1.9 - 0.1 * tanh((-output[i] - 1.9) * 10.0);
+        if (total / calls < *avg_us) *avg_us = total / calls;
+        if (peak < *peak_us) *peak_us = peak;
+    }
+}
+
+// Benchmark the candidate partition layouts on the current IR for process calls
+// of host_block samples, and remember the winner: the cheapest on average among
+// the layouts whose slowest call fits TUNING_PEAK_BUDGET of the callback
+// period, or the lowest peak when none fits. A layout already measured for
+// this IR length and block size is returned as is unless force is set.
+// Returns the chosen tail partition size (0: uniform), -1 without an IR.
+int calibrate_partitions_(int* host_block, int* force) {
+    if (!engine.initialized) return -1;
+    
+    int block = *host_block;
+    if (block < 1) block = 1;
+    if (block > IO_BUFFER_FRAMES) block = IO_BUFFER_FRAMES;
+    
+    if (ir_upload.active) return -1;   // Tuned once the sampled IR is complete
+    if (engine.ir_needs_update) {
+        generate_impulse_response();
+    }
+    finish_impulse_response();
+    if (!engine.impulse_response) return -1;
+    
+    int conv_length = convolved_length();
+    int length_class = wisdom_length_class(conv_length);
+    const WisdomEntry* known = wisdom_find(&partition_wisdom, length_class, block);
+    if (known && !*force) {
+        return known->tail_block;
+    }
+    
+    printf("\n=== PARTITION CALIBRATION: %d-sample calls, %d-sample IR ===\n", block, conv_length);
+    
+    // Every candidate must fit the arena - regrow it (regenerating the IR) if not
+    tuning_active = 1;
+    if (engine_memory_bytes(engine.ir_length) > engine_arena.size) {
+        if (ir_upload.loaded && grow_arena_keeping_ir() != 0) {
+            tuning_active = 0;
+            return -1;
+        } else if (!ir_upload.loaded) {
+            generate_impulse_response();
         }
+        conv_length = convolved_length();
+    }
+    
+    // Timed input: noise, so no partition is skipped as silent. A local generator
+    // leaves the IR generator's random state alone
+    int length = block * ((TUNING_MIN_SAMPLES + block - 1) / block);
+    if (length < 16 * block) length = 16 * block;
+    conv_sample_t* input = (conv_sample_t*)malloc((length + WET_CHUNK_SIZE) * sizeof(conv_sample_t));
+    if (!input) {
+        tuning_active = 0;
+        return -1;
+    }
+    uint32_t seed = 0x9E3779B9u;
+    for (int i = 0; i < length + WET_CHUNK_SIZE; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        input[i] = (conv_sample_t)(((int32_t)seed) * (0.1 / 2147483648.0));
+    }
+    
+    double period_us = 1e6 * block / engine.sample_rate;
+    WisdomEntry best = { length_class, block, 0, 0.0f, 0.0f };
+    int have_best = 0;
+    int best_fits = 0;
+    
+    for (int c = 0; c < TUNING_CANDIDATES; c++) {
+        int tail_block = tuning_candidates[c];
+        if (tail_block > 0 && conv_length <= 3 * tail_block) continue;
+        
+        tuning_tail_block = tail_block;
+        prepare_convolution();
+        if (!tail_convolver_ready || (tail_block > 0 && !tail_stage_ready)) continue;
+        
+        double avg_us, peak_us;
+        measure_layout(block, input, length, &avg_us, &peak_us);
+        int fits = peak_us <= TUNING_PEAK_BUDGET * period_us;
+        
+        printf("  %5d: avg %8.1f us | peak %8.1f us%s\n", tail_block, avg_us, peak_us,
+               fits ? "" : "  (over budget)");
         
-        // Advance circular buffer
-        history_pos = (history_pos + 1) % MAX_IR_SIZE;
+        if (!have_best || (fits && !best_fits) ||
+            (fits == best_fits && (fits ? avg_us < best.avg_us : peak_us < best.peak_us))) {
+            best.tail_block = tail_block;
+            best.avg_us = (float)avg_us;
+            best.peak_us = (float)peak_us;
+            best_fits = fits;
+            have_best = 1;
+        }
+    }
+    
+    free(input);
+    tuning_tail_block = -1;
+    tuning_active = 0;
+    
+    if (have_best) {
+        wisdom_store(&partition_wisdom, &best);
+        if (best.tail_block > 0) {
+            printf("  🧠 WISDOM: two-stage with %d-sample tail partitions for %d-sample calls\n",
+                   best.tail_block, block);
+        } else {
+            printf("  🧠 WISDOM: uniform partitions for %d-sample calls\n", block);
+        }
+    }
+    printf("=== CALIBRATION COMPLETE ===\n");
+    
+    // Back to the layout for the engine's own host block, with clean history
+    prepare_convolution();
+    return have_best ? best.tail_block : -1;
+}
+
+// Wisdom exchange buffer: save_wisdom_ serializes into it and returns the
+// byte count; hosts write a persisted blob into it and call load_wisdom_.
+unsigned char* get_wisdom_buffer_() {
+    return wisdom_blob;
+}
+
+int get_wisdom_capacity_() {
+    return WISDOM_MAX_BYTES;
+}
+
+int save_wisdom_() {
+    return wisdom_serialize(&partition_wisdom, wisdom_blob);
+}
+
+// Returns the entry count, or -1 when the blob does not fit this engine
+int load_wisdom_(int* size) {
+    int count = wisdom_parse(&partition_wisdom, wisdom_blob,
+                             *size < WISDOM_MAX_BYTES ? *size : WISDOM_MAX_BYTES);
+    printf("  🧠 WISDOM: %s\n", count >= 0 ? "loaded" : "rejected (format or engine variant)");
+    if (count >= 0) {
+        apply_partition_layout();
+    }
+    return count;
+}
+
+// Precomputed IRs: save_ir_cache serializes the current generated IR (finishing
+// it first) into the cache buffer; to restore, reserve room, write a saved blob
+// there and call load_ir_cache. Blobs are only taken for the settings they were
+// made with - get_ir_cache_key tells the host which one to look up. A blob
+// loaded ahead of its settings (say, before switching to its IR type) is
+// staged and taken by the next generation for them
+unsigned int get_ir_cache_key_() {
+    return ir_cache_key();
+}
+
+unsigned char* get_ir_cache_buffer_() {
+    return ir_cache_buffer;
+}
+
+unsigned char* reserve_ir_cache_(int* bytes) {
+    ir_cache_staged = 0;
+    if (*bytes <= 0 || reserve_ir_cache((size_t)*bytes) != 0) return NULL;
+    return ir_cache_buffer;
+}
+
+// Returns the blob size, or -1 without a generated IR (sampled IRs are not
+// keyed by the settings)
+int save_ir_cache_() {
+    if (!engine.initialized || ir_upload.loaded) return -1;
+    if (engine.ir_needs_update) {
+        generate_impulse_response();
+    }
+    finish_impulse_response();
+    finish_layout_rebuild();
+    if (!engine.impulse_response || engine.ir_length == 0) return -1;
+    
+    // Spectra only for the plain uniform convolver; other layouts are rebuilt
+    // from the IR on load
+    int uniform = tail_convolver_ready && !tail_stage_ready && !late_tail_ready &&
+                  !fdn_tail_ready && !velvet_tail_ready;
+    
+    IRCacheInfo info;
+    memset(&info, 0, sizeof(info));
+    info.key = ir_cache_key();
+    info.sample_rate = engine.sample_rate;
+    info.ir_type = engine.ir_type;
+    info.ir_length = engine.ir_length;
+    info.effective_length = engine.ir_effective_length;
+    info.trim_db = engine.ir_trim_db;
+    info.norm_factor = ir_norm_factor;
+    info.early_gain = early.gain;
+    info.wet_gain = wet_correction_target;
+    info.layered = tail_layered;
+    info.early_spread = early.spread;
+    info.num_early_taps = early.num_taps;
+    
+    IRCacheTap taps[MAX_EARLY_TAPS];
+    for (int i = 0; i < early.num_taps; i++) {
+        taps[i].delay = early.taps[i].delay;
+        taps[i].gain = early.taps[i].gain;
+    }
+    
+    const FFTConvolver* spectra = uniform ? &tail_convolver : NULL;
+    size_t bytes = ir_cache_bytes(&info, spectra);
+    ir_cache_staged = 0;
+    if (bytes > INT_MAX || reserve_ir_cache(bytes) != 0) return -1;
+    ir_cache_serialize(&info, early.kernel, taps, engine.impulse_response, spectra, ir_cache_buffer);
+    
+    printf("  💾 IR CACHE: saved %.2f MB (key %08x%s)\n", bytes / (1024.0 * 1024.0), info.key,
+           uniform ? ", with partition spectra" : "");
+    return (int)bytes;
+}
+
+// Replace the IR with a blob from save_ir_cache - no synthesis, and no FFTs
+// when the layout matches. Returns 0, or -1 for a blob of another format or
+// other settings (the IR is left alone; the blob stays staged)
+int load_ir_cache_(int* size) {
+    IRCacheInfo info;
+    ir_cache_staged = 0;
+    if (!engine.initialized || *size <= 0 || (size_t)*size > ir_cache_capacity ||
+        ir_cache_parse(ir_cache_buffer, (size_t)*size, &info) != 0) {
+        printf("  💾 IR CACHE: rejected (format)\n");
+        return -1;
+    }
+    if (!ir_blob_matches(&info)) {
+        ir_cache_staged = (size_t)*size;
+        printf("  💾 IR CACHE: staged until its settings come up (key %08x)\n", info.key);
+        return -1;
     }
+    
+    // Whatever generation or upload is under way is replaced
+    int restored = restore_ir_blob(ir_cache_buffer, &info);
+    if (restored < 0) return -1;
+    printf("  💾 IR CACHE: restored %d-sample IR (key %08x), %s\n", engine.ir_length, info.key,
+           restored ? "partition spectra loaded" : "partitions rebuilt");
+    return 0;
+}
+
+// Sampled IRs: interleaved float frames, written by the host into the upload
+// buffer a chunk at a time. The convolution starts on the first chunks
+float* get_ir_upload_buffer_() {
+    return ir_upload_buffer;
+}
+
+int get_ir_upload_capacity_() {
+    return IR_UPLOAD_FLOATS;
+}
+
+// Announce an upload of frames frames; returns 0, or -1 if it was rejected
+int begin_ir_samples_(int* frames, int* sample_rate, int* channels) {
+    return begin_ir_upload(*frames, *sample_rate, *channels);
+}
+
+// Append frames interleaved frames; returns the IR taps ready so far, or -1
+// when no upload was begun
+int append_ir_samples_(float* samples, int* frames) {
+    if (!ir_upload.loaded || !engine.impulse_response) return -1;
+    return append_ir_upload(samples, *frames);
+}
+
+// Whole IR in one call; returns its length in taps, or -1
+int load_ir_samples_(float* samples, int* frames, int* sample_rate, int* channels) {
+    if (begin_ir_upload(*frames, *sample_rate, *channels) != 0) return -1;
+    append_ir_upload(samples, *frames);
+    return engine.ir_length;
 }
 
 // ENHANCED: Parameter setter with immediate IR regeneration
@@ -918,23 +3497,116 @@ void set_param_float_(int* param_id, float* value) {
             printf("  Early reflections: %.1f -> %.1f\n", old_value, engine.early_reflections);
             break;
             
+        case 8: // irTrimThreshold
+            old_value = engine.ir_trim_db;
+            engine.ir_trim_db = fmax(MIN_IR_TRIM_DB, fmin(MAX_IR_TRIM_DB, *value));
+            printf("  IR trim threshold: %.1f -> %.1f dB (no IR update needed)\n", old_value, engine.ir_trim_db);
+            // Only the cut point moves - the generated IR stays as it is, and
+            // plays at the old cut point until the process calls have rebuilt it
+            if (engine.initialized && !engine.ir_needs_update && !ir_gen.active && !ir_upload.active &&
+                engine.impulse_response) {
+                request_layout_rebuild(1);
+            }
+            break;
+            
+        case 9: // tailThreads
+            old_value = engine.tail_threads;
+            engine.tail_threads = (int)fmax(0.0, fmin(TAIL_STAGE_MAX_GROUPS, *value));
+            printf("  Tail threads: %.0f -> %d\n", old_value, engine.tail_threads);
+            // The arena layout changes with the partitioning
+            if (engine.tail_threads != (int)old_value) {
+                needs_update = 1;
+            }
+            break;
+            
+        case 10: // hostBlockSize
+            old_value = engine.host_block;
+            engine.host_block = (int)fmax(1.0, fmin(IO_BUFFER_FRAMES, *value));
+            printf("  Host block size: %.0f -> %d (no IR update needed)\n", old_value, engine.host_block);
+            // Wisdom may hold a different layout for this block size
+            apply_partition_layout();
+            break;
+            
+        case 11: // lateTailRate
+            old_value = engine.late_tail_rate;
+            engine.late_tail_rate = *value < 0.5 ? 0 : (*value < 1.5 ? 1 : (*value < 3.0 ? 2 : 4));
+            printf("  Late tail rate: %.0f -> %d%s\n", old_value, engine.late_tail_rate,
+                   engine.late_tail_rate == 0 ? " (auto)" : "");
+            // The arena layout changes with the partitioning
+            if (engine.late_tail_rate != (int)old_value) {
+                needs_update = 1;
+            }
+            break;
+            
+        case 12: // fdnCrossover
+            old_value = engine.fdn_crossover_ms;
+            engine.fdn_crossover_ms = *value <= 0.0f ? 0.0 :
+                                      fmax(FDN_MIN_CROSSOVER_MS, fmin(FDN_MAX_CROSSOVER_MS, *value));
+            printf("  FDN crossover: %.0f -> %.0f ms%s\n", old_value, engine.fdn_crossover_ms,
+                   engine.fdn_crossover_ms > 0.0 ? "" : " (convolve the whole IR)");
+            // The arena layout changes with the crossover
+            if (fabs(old_value - engine.fdn_crossover_ms) > 0.01) {
+                needs_update = 1;
+            }
+            break;
+            
+        case 13: // modalEngine
+            old_value = engine.modal_engine;
+            engine.modal_engine = *value >= 0.5f;
+            printf("  Modal engine: %.0f -> %d%s\n", old_value, engine.modal_engine,
+                   modal_engine_active() ? "" : " (used by Plate and Spring only)");
+            // Switching in starts from a silent bank; switching out lets the
+            // convolution path pick up any regeneration it missed
+            if (engine.modal_engine != (int)old_value) {
+                modal_bank_type = -1;
+            }
+            break;
+            
+        case 14: // velvetDensity
+            old_value = engine.velvet_density;
+            engine.velvet_density = *value <= 0.0f ? 0.0 :
+                                    fmax(VELVET_MIN_DENSITY, fmin(VELVET_MAX_DENSITY, *value));
+            printf("  Velvet density: %.0f -> %.0f taps/s%s\n", old_value, engine.velvet_density,
+                   engine.velvet_density > 0.0 ? "" : " (convolve the whole IR)");
+            // The arena layout changes with the tap count
+            if (fabs(old_value - engine.velvet_density) > 0.5) {
+                needs_update = 1;
+            }
+            break;
+            
         default:
             printf("  WARNING: Unknown parameter ID %d\n", *param_id);
             return;
     }
     
+    // The modal engine retunes in place; the IR is regenerated once the
+    // convolution path runs again
+    if (needs_update && engine.initialized && modal_engine_active()) {
+        engine.ir_needs_update = 1;
+        update_modal_bank();
+        printf("  >>> Modal bank retuned - no IR regeneration\n");
+        return;
+    }
+    
+    // A sampled IR is kept: only its layout is rebuilt (once it is complete)
+    if (needs_update && engine.initialized && ir_upload.loaded) {
+        if (!ir_upload.active) {
+            rebuild_sampled_convolution();
+        }
+        printf("  >>> Sampled IR kept - convolution layout rebuilt\n");
+        return;
+    }
+    
     // Force immediate IR regeneration if needed
     if (needs_update && engine.initialized) {
         engine.ir_needs_update = 1;
-        printf("  >>> Parameter changed significantly - regenerating IR immediately!\n");
-        generate_impulse_response();
-        
-        // Clear convolution history to avoid artifacts
-        if (conv_history) {
-            memset(conv_history, 0, MAX_IR_SIZE * sizeof(double));
-            history_pos = 0;
+        if (init_pending) {
+            printf("  >>> Engine starting up - IR built by continue_init\n");
+            return;
         }
-        printf("  >>> IR regenerated and history cleared\n");
+        printf("  >>> Parameter changed significantly - regenerating IR immediately!\n");
+        begin_impulse_response(1);  // Also clears convolution history
+        printf("  >>> First partitions live and history cleared - tail fills in while processing\n");
     }
 }
 
@@ -977,6 +3649,34 @@ void set_parameter_(char* param_name, double* value, int param_name_len) {
         float fval = (float)*value;
         int id = 7;
         set_param_float_(&id, &fval);
+    } else if (strcmp(name, "irTrimThreshold") == 0) {
+        float fval = (float)*value;
+        int id = 8;
+        set_param_float_(&id, &fval);
+    } else if (strcmp(name, "tailThreads") == 0) {
+        float fval = (float)*value;
+        int id = 9;
+        set_param_float_(&id, &fval);
+    } else if (strcmp(name, "hostBlockSize") == 0) {
+        float fval = (float)*value;
+        int id = 10;
+        set_param_float_(&id, &fval);
+    } else if (strcmp(name, "lateTailRate") == 0) {
+        float fval = (float)*value;
+        int id = 11;
+        set_param_float_(&id, &fval);
+    } else if (strcmp(name, "fdnCrossover") == 0) {
+        float fval = (float)*value;
+        int id = 12;
+        set_param_float_(&id, &fval);
+    } else if (strcmp(name, "modalEngine") == 0) {
+        float fval = (float)*value;
+        int id = 13;
+        set_param_float_(&id, &fval);
+    } else if (strcmp(name, "velvetDensity") == 0) {
+        float fval = (float)*value;
+        int id = 14;
+        set_param_float_(&id, &fval);
     }
 }
 
@@ -1019,47 +3719,149 @@ void set_ir_type_(char* ir_type_str, int ir_type_len) {
         engine.ir_type = IR_TYPE_METALLIC;
     } else if (strcmp(type, "psychedelic") == 0) {
         engine.ir_type = IR_TYPE_PSYCHEDELIC;
+    } else if (strcmp(type, "slapback") == 0) {
+        engine.ir_type = IR_TYPE_SLAPBACK;
+    } else if (strcmp(type, "infinite") == 0) {
+        engine.ir_type = IR_TYPE_INFINITE;
+    } else if (strcmp(type, "scattered") == 0) {
+        engine.ir_type = IR_TYPE_SCATTERED;
+    } else if (strcmp(type, "doppler") == 0) {
+        engine.ir_type = IR_TYPE_DOPPLER;
+    } else if (strcmp(type, "quantum") == 0) {
+        engine.ir_type = IR_TYPE_QUANTUM;
+    } else if (strcmp(type, "void") == 0) {
+        engine.ir_type = IR_TYPE_VOID;
+    } else if (strcmp(type, "crystalline") == 0) {
+        engine.ir_type = IR_TYPE_CRYSTALLINE;
+    } else if (strcmp(type, "magnetic") == 0) {
+        engine.ir_type = IR_TYPE_MAGNETIC;
+    } else if (strcmp(type, "plasma") == 0) {
+        engine.ir_type = IR_TYPE_PLASMA;
+    } else if (strcmp(type, "nightmare") == 0) {
+        engine.ir_type = IR_TYPE_NIGHTMARE;
     }
     
-    if (old_type != engine.ir_type) {
-        printf("  🎭 IR type changed from %d to %d - MORPHING REALITY! 🎭\n", old_type, engine.ir_type);
+    // Picking a type also replaces a sampled IR, even with the same type
+    if (old_type != engine.ir_type || ir_upload.loaded) {
+        if (old_type != engine.ir_type) {
+            printf("  🎭 IR type changed from %d to %d - MORPHING REALITY! 🎭\n", old_type, engine.ir_type);
+        } else {
+            printf("  🎭 Sampled IR replaced by generated type %d\n", engine.ir_type);
+        }
         engine.ir_needs_update = 1;
         
-        // Force immediate regeneration
-        if (engine.initialized) {
+        // Plate and Spring under the modal engine only need a new mode layout
+        if (engine.initialized && modal_engine_active()) {
+            update_modal_bank();
+            return;
+        }
+        
+        // Force immediate regeneration (during an asynchronous start-up the
+        // IR is built by continue_init_)
+        if (engine.initialized && !init_pending) {
             printf("  >>> 🌟 NEW UNIVERSE SELECTED - REGENERATING SPACE-TIME! 🌟\n");
-            generate_impulse_response();
-            if (conv_history) {
-                memset(conv_history, 0, MAX_IR_SIZE * sizeof(double));
-                history_pos = 0;
-            }
+            begin_impulse_response(1);
             printf("  >>> 🎆 NEW REALITY LOADED! 🎆\n");
         }
     }
 }
 
-// Cleanup
-void cleanup_convolution_engine_() {
-    if (engine.impulse_response) {
-        free(engine.impulse_response);
-        engine.impulse_response = NULL;
-    }
-    if (engine.overlap_buffer) {
-        free(engine.overlap_buffer);
-        engine.overlap_buffer = NULL;
-    }
-    if (engine.fft_buffer) {
-        free(engine.fft_buffer);
-        engine.fft_buffer = NULL;
+// Asynchronous start-up: init_engine_async_ initializes without building
+// anything; the host applies its settings, then calls continue_init_ until it
+// returns 100, yielding in between. That lays out the arena, builds the FFT
+// plans and draws the first IR (or takes a staged or built-in one) a slice at
+// a time, so the first process call finds everything ready
+void init_engine_async_(int* sr) {
+    init_convolution_engine_(sr);
+    init_pending = 1;
+}
+
+// Percent of the start-up done: 100 when ready (or after a synchronous
+// init), -1 before any init
+int get_init_progress_() {
+    if (!engine.initialized) return -1;
+    if (!init_pending) return 100;
+    if (engine.ir_needs_update || !engine.impulse_response) {
+        return engine_arena.size ? (int)(5.0 * engine_arena.prefaulted / engine_arena.size) : 0;
     }
-    if (engine.temp_buffer) {
-        free(engine.temp_buffer);
-        engine.temp_buffer = NULL;
+    if (ir_gen.active && engine.ir_length > 0) {
+        return 5 + (int)(90.0 * ir_gen.shaped / engine.ir_length);
     }
-    if (conv_history) {
-        free(conv_history);
-        conv_history = NULL;
+    return 95;
+}
+
+// One slice of the start-up; returns get_init_progress_()
+int continue_init_() {
+    if (!engine.initialized) return -1;
+    if (!init_pending) return 100;
+    
+    enable_denormal_flushing();
+    if (modal_engine_active()) {
+        // Plate and Spring render from the mode bank; the IR waits until the
+        // convolution path is needed
+        if (modal_bank_type != engine.ir_type) {
+            update_modal_bank();
+        }
+    } else if (engine.ir_needs_update) {
+        // The arena first, reserved as configure_engine_memory would and
+        // faulted in a chunk per call - touching tens of MB at once is the
+        // largest single step of the start-up
+        size_t bytes = engine_memory_bytes(generated_ir_length());
+        if (bytes > engine_arena.size || bytes < engine_arena.size / 2) {
+            Arena fresh;
+            if (arena_reserve(&fresh, bytes) == 0) {
+                release_tail_stage();
+                tail_convolver_ready = 0;
+                engine.impulse_response = NULL;
+                conv_history = NULL;
+                history_size = 0;
+                arena_free(&engine_arena);
+                engine_arena = fresh;
+                return get_init_progress_();
+            }
+        } else if (arena_prefault(&engine_arena, INIT_ARENA_CHUNK) > 0) {
+            return get_init_progress_();
+        }
+        begin_impulse_response(1);
+        return get_init_progress_();
+    } else if (ir_gen.active) {
+        ir_gen.target += (long long)(INIT_SLICE_MS * engine.sample_rate / 1000.0);
+        step_impulse_response(INIT_SLICE_REFLECTIONS);
+        return get_init_progress_();
+    } else if (engine.impulse_response && !ir_upload.active &&
+               (!tail_convolver_ready || thickening_layers() != tail_layered)) {
+        // What the first process call would otherwise rebuild
+        prepare_convolution();
+        return get_init_progress_();
     }
+    
+    // Nothing has played through the provisional level, so no glide to the final one
+    wet_correction = wet_correction_target;
+    wet_correction_step = 0.0;
+    
+    init_pending = 0;
+    printf("🚀 ENGINE READY: %d-sample IR prepared, %.2f MB arena\n", engine.ir_length,
+           engine_arena.size / (1024.0 * 1024.0));
+    return 100;
+}
+
+// Cleanup
+void cleanup_convolution_engine_() {
+    // The IR, history and convolver all live in the arena
+    release_tail_stage();
+    arena_free(&engine_arena);
+    arena_conv_mark = 0;
+    engine.impulse_response = NULL;
+    conv_history = NULL;
+    history_size = 0;
+    tail_convolver_ready = 0;
+    early.num_taps = 0;
+    free(ir_cache_buffer);
+    ir_cache_buffer = NULL;
+    ir_cache_capacity = 0;
+    ir_cache_staged = 0;
+    silence.bypassed = 0;
+    init_pending = 0;
     engine.initialized = 0;
     history_pos = 0;
     process_counter = 0;
@@ -1074,6 +3876,29 @@ int get_sample_rate_() {
     return engine.sample_rate;
 }
 
+// Samples of output still to come from input already received; 0 once the
+// tail has decayed (always 0 while bypassed). Hosts can stop calling early.
+int get_tail_samples_() {
+    if (silence.bypassed) return 0;
+    long long remaining = tail_length_samples() - silence.silent_samples;
+    return remaining > 0 ? (int)remaining : 0;
+}
+
+int get_ir_length_() {
+    return engine.ir_length;
+}
+
+int get_effective_ir_length_() {
+    return engine.ir_effective_length;
+}
+
+// Bytes reserved by the engine arena (IR, tap history, FFT convolver, scratch),
+// plus the second convolver slot while a layout rebuild holds one
+int get_memory_usage_() {
+    size_t bytes = engine_arena.size + rebuild_arena.size;
+    return bytes > 0x7fffffff ? 0x7fffffff : (int)bytes;
+}
+
 char* get_version_() {
     static char version[] = "2.0.3-C";
     return version;
@@ -1085,7 +3910,12 @@ void debug_print_engine_state() {
     printf("Initialized: %d\n", engine.initialized);
     printf("Sample Rate: %d Hz\n", engine.sample_rate);
     printf("IR Length: %d samples (%.2fs)\n", engine.ir_length, (double)engine.ir_length / engine.sample_rate);
+    printf("IR Effective Length: %d samples (%.2fs) @ %.0f dB\n", engine.ir_effective_length,
+           (double)engine.ir_effective_length / engine.sample_rate, engine.ir_trim_db);
     printf("IR Needs Update: %d\n", engine.ir_needs_update);
+    printf("Memory Usage: %.2f MB arena, %.2f MB in use%s (history %d)\n",
+           engine_arena.size / (1024.0 * 1024.0), engine_arena.used / (1024.0 * 1024.0),
+           engine_arena.locked ? ", locked" : "", history_size);
     printf("\nParameters:\n");
     printf("  Room Size: %.1f%%\n", engine.room_size);
     printf("  Decay Time: %.1fs\n", engine.decay_time);
@@ -1095,6 +3925,27 @@ void debug_print_engine_state() {
     printf("  Diffusion: %.1f%%\n", engine.diffusion);
     printf("  Mix Level: %.1f%%\n", engine.mix_level);
     printf("  Early Reflections: %.1f%%\n", engine.early_reflections);
+    printf("  IR Trim Threshold: %.1f dB\n", engine.ir_trim_db);
+    printf("  Tail Threads: %d%s\n", engine.tail_threads,
+           tail_stage_ready ? (tail_stage.threaded ? " (running)" : " (inline)") : "");
+    printf("  Host Block: %d | Tail Partitions: %d | Wisdom Entries: %d\n", engine.host_block,
+           tail_stage_ready ? tail_stage.block_size : 0, partition_wisdom.count);
+    printf("  Late Tail Rate: %s | Running at 1/%d\n",
+           engine.late_tail_rate == 0 ? "auto" : (engine.late_tail_rate == 1 ? "full" : "decimated"),
+           late_tail_ready ? late_tail.factor : 1);
+    if (fdn_tail_ready) {
+        printf("  FDN Crossover: %.0f ms | T60 %.2fs low / %.2fs high\n", engine.fdn_crossover_ms,
+               fdn_tail.t60_low, fdn_tail.t60_high);
+    } else {
+        printf("  FDN Crossover: %s\n", engine.fdn_crossover_ms > 0.0 ? "not used" : "off");
+    }
+    if (velvet_tail_ready) {
+        printf("  Velvet Tail: %.0f taps/s | %d taps from %.0f ms\n", engine.velvet_density,
+               velvet_tail.num_taps, 1000.0 * velvet_tail.start / engine.sample_rate);
+    } else {
+        printf("  Velvet Tail: %s\n", engine.velvet_density > 0.0 ? "not used" : "off");
+    }
+    printf("  Modal Engine: %s\n", modal_engine_active() ? "rendering" : (engine.modal_engine ? "idle" : "off"));
     
     const char* type_names[] = {
         "Hall", "Cathedral", "Room", "Plate", "Spring", 
@@ -1159,5 +4010,88 @@ void test_reverb_impulse() {
     printf("=========================\n\n");
 }
 
+// Benchmark: time callbacks while the convolution works on subnormals.
+// Noise at a normal level runs for a whole tail first, so every partition
+// holds live history, and sets the reference; it then decays into the
+// subnormal range of the convolver's sample type and stays there for another
+// tail, until nothing normal is left in any delay line. Only meaningful with
+// -DCONV_NO_SILENCE_GATING - otherwise the silence gating and the auto-bypass
+// skip that work altogether - and against a build with
+// -DCONV_NO_DENORMAL_PROTECTION (scripts/bench_denormal.c runs both).
+// Returns the subnormal/normal callback time ratio
+double benchmark_denormal_decay() {
+    printf("\n=== DENORMAL DECAY BENCHMARK ===\n");
+#ifndef CONV_NO_SILENCE_GATING
+    printf("  WARNING: built with silence gating - subnormal blocks are skipped, not timed\n");
+#endif
+    
+    double input[BLOCK_SIZE];
+    double output[BLOCK_SIZE];
+    int n = BLOCK_SIZE;
+    
+    // The IR and its layout complete before anything is timed
+    memset(input, 0, sizeof(input));
+    process_convolution_(input, output, &n);
+    finish_impulse_response();
+    finish_layout_rebuild();
+    
+    const int timed_blocks = 200;
+    const int decay_blocks = 200;
+    int tail_blocks = tail_length_samples() / BLOCK_SIZE + 2;
+    
+    // Deep in the subnormal range of conv_sample_t (and of double)
+    double floor_level = (sizeof(conv_sample_t) == sizeof(float) ? FLT_MIN : DBL_MIN) * 1e-3;
+    double per_sample = pow(floor_level / 0.1, 1.0 / (decay_blocks * BLOCK_SIZE));
+    
+    // Phases: fill, reference (timed), decay, hold, settled (timed)
+    int phase_end[5];
+    phase_end[0] = tail_blocks;
+    phase_end[1] = phase_end[0] + timed_blocks;
+    phase_end[2] = phase_end[1] + decay_blocks;
+    phase_end[3] = phase_end[2] + tail_blocks;
+    phase_end[4] = phase_end[3] + timed_blocks;
+    
+    double level = 0.1;
+    uint32_t seed = 0x9E3779B9u;
+    double reference_time = 0.0, reference_max = 0.0;
+    double settled_time = 0.0, settled_max = 0.0;
+    
+    for (int b = 0; b < phase_end[4]; b++) {
+        int decaying = b >= phase_end[1] && b < phase_end[2];
+        for (int i = 0; i < BLOCK_SIZE; i++) {
+            seed = seed * 1664525u + 1013904223u;
+            input[i] = level * ((int32_t)seed / 2147483648.0);
+            if (decaying && level > floor_level) level *= per_sample;
+        }
+        
+        clock_t start = clock();
+        process_convolution_(input, output, &n);
+        double us = (double)(clock() - start) * 1e6 / CLOCKS_PER_SEC;
+        
+        if (b >= phase_end[0] && b < phase_end[1]) {
+            reference_time += us;
+            if (us > reference_max) reference_max = us;
+        } else if (b >= phase_end[3]) {
+            settled_time += us;
+            if (us > settled_max) settled_max = us;
+        }
+    }
+    
+    double reference = reference_time / timed_blocks;
+    double settled = settled_time / timed_blocks;
+    double ratio = reference > 0.0 ? settled / reference : 0.0;
+    
+    printf("Block size: %d | %s | denormal protection %s\n", BLOCK_SIZE, CONV_PRECISION_NAME,
+           DENORMAL_PROTECTION ? "on" : "off");
+    printf("Tail: %d blocks | noise at 0.1, then held at %.1e\n", tail_blocks, floor_level);
+    printf("  Normal input:    avg %8.1f us | max %8.1f us\n", reference, reference_max);
+    printf("  Subnormal input: avg %8.1f us | max %8.1f us\n", settled, settled_max);
+    printf("  Subnormal/normal callback time: %.2f%s\n", ratio,
+           ratio > 2.0 ? "  WARNING: subnormal arithmetic is slowing the callback!" : "");
+    printf("================================\n\n");
+    
+    return ratio;
+}
+
 // NOTE: Export functions are defined in wasm_bridge.c
 // The bridge calls these internal functions with underscore suffixes
\ No newline at end of file
@@ -0,0 +1,42 @@
+// denormal.h
+// Hardware flush-to-zero for every thread that runs engine DSP
+
+#ifndef DENORMAL_H
+#define DENORMAL_H
+
+#include <stdint.h>
+
+// Build with -DCONV_NO_DENORMAL_PROTECTION to let subnormals through: no
+// FTZ/DAZ and no explicit flushing anywhere. Only for measuring what the
+// protection saves (scripts/bench_denormal.c)
+#ifdef CONV_NO_DENORMAL_PROTECTION
+#define DENORMAL_PROTECTION 0
+#else
+#define DENORMAL_PROTECTION 1
+#endif
+
+#if (defined(__SSE__) || defined(__x86_64__) || defined(_M_X64)) && !defined(__EMSCRIPTEN__)
+#include <xmmintrin.h>
+#define HAVE_SSE_FTZ 1
+#endif
+
+// Flush-to-zero / denormals-are-zero for the calling thread (native builds
+// only). MXCSR and FPCR are per thread, so the process thread, the IR
+// generation thread and every tail worker each call this themselves
+static inline void enable_denormal_flushing(void) {
+#if !DENORMAL_PROTECTION
+#elif defined(HAVE_SSE_FTZ)
+    unsigned int csr = _mm_getcsr();
+    if ((csr & 0x8040) != 0x8040) {
+        _mm_setcsr(csr | 0x8040);  // FTZ (bit 15) | DAZ (bit 6)
+    }
+#elif defined(__aarch64__) && !defined(__EMSCRIPTEN__)
+    uint64_t fpcr;
+    __asm__ __volatile__("mrs %0, fpcr" : "=r"(fpcr));
+    if (!(fpcr & (1ULL << 24))) {
+        __asm__ __volatile__("msr fpcr, %0" : : "r"(fpcr | (1ULL << 24)));  // FZ
+    }
+#endif
+}
+
+#endif // DENORMAL_H
@@ -0,0 +1,295 @@
+// fdn_tail.c
+// Fit an FDN to the late IR's energy decay and run it in place of convolution
+
+#include <math.h>
+#include <string.h>
+
+#include "fdn_tail.h"
+#include "denormal.h"
+
+#define FDN_PI 3.14159265358979323846
+
+// Line lengths at roomSize 50, scaled by 0.5..1.5 over the roomSize range and
+// rounded up to primes so no two lines share a period
+static const double fdn_line_ms[FDN_LINES] = {
+    29.3, 33.7, 38.9, 43.1, 49.7, 55.3, 61.1, 67.9
+};
+
+// Schroeder allpasses in front of the lines: an impulse comes out dense
+// instead of as eight discrete echoes
+static const double fdn_diffuser_ms[FDN_DIFFUSERS] = { 4.77, 3.59, 12.73, 9.31 };
+#define FDN_DIFFUSION        0.7
+
+// Decay fit: the low band is below FDN_LOW_BAND_HZ, the high band above
+// FDN_HIGH_BAND_HZ (where the absorption filter is matched). A line is fitted
+// to the band's energy decay curve (backward-integrated energy, sampled every
+// FDN_FIT_BLOCK_MS) between FDN_FIT_TOP_DB and FDN_FIT_BOTTOM_DB. The curve
+// sees where the generated IR ends, so the network dies away with it
+#define FDN_LOW_BAND_HZ      500.0
+#define FDN_HIGH_BAND_HZ     4000.0
+#define FDN_FIT_BLOCK_MS     5.0
+#define FDN_FIT_TOP_DB       -5.0
+#define FDN_FIT_BOTTOM_DB    -35.0
+#define FDN_FIT_MIN_BLOCKS   4
+
+// Level match window after the crossfade: long enough to average over the
+// IR's departures from a single exponential
+#define FDN_MATCH_MS         2000.0
+#define FDN_MATCH_CHUNK      256
+
+// Recursive state below this (~-600 dB) is flushed before it can go subnormal
+#define FDN_DENORMAL_FLOOR   1e-30
+
+static inline double flush_denormal(double x) {
+    return DENORMAL_PROTECTION && fabs(x) < FDN_DENORMAL_FLOOR ? 0.0 : x;
+}
+
+static int next_prime(int n) {
+    if (n < 2) return 2;
+    for (;; n++) {
+        int prime = 1;
+        for (int d = 2; d * d <= n && prime; d++) {
+            prime = n % d != 0;
+        }
+        if (prime) return n;
+    }
+}
+
+static int line_length(int sample_rate, double size, int line) {
+    double scale = 0.5 + fmax(0.0, fmin(100.0, size)) / 100.0;
+    return next_prime((int)(fdn_line_ms[line] * scale * sample_rate / 1000.0));
+}
+
+static int diffuser_length(int sample_rate, int d) {
+    int length = (int)(fdn_diffuser_ms[d] * sample_rate / 1000.0);
+    return length > 1 ? length : 1;
+}
+
+size_t fdn_tail_bytes(int sample_rate, int start) {
+    size_t bytes = ARENA_BYTES(start > 1 ? start : 1, conv_sample_t);
+    for (int d = 0; d < FDN_DIFFUSERS; d++) {
+        bytes += ARENA_BYTES(diffuser_length(sample_rate, d), double);
+    }
+    for (int l = 0; l < FDN_LINES; l++) {
+        bytes += ARENA_BYTES(line_length(sample_rate, 100.0, l), double);
+    }
+    return bytes;
+}
+
+// Least-squares line through (t, level) points
+typedef struct {
+    double n, t, y, tt, ty;
+} LineFit;
+
+// One pass over a band of taps [start, ir_length). Returns the band's energy;
+// with a fit it also adds the energy decay curve in dB (remaining energy
+// against total) at every block boundary inside the fit range. The low band
+// is a one-pole low-pass, the high band what a second one leaves over
+static double band_energy_pass(const double* ir, int ir_length, int start, int sample_rate,
+                               int high, double total, LineFit* fit) {
+    double cutoff = high ? FDN_HIGH_BAND_HZ : FDN_LOW_BAND_HZ;
+    double coeff = 1.0 - exp(-2.0 * FDN_PI * cutoff / sample_rate);
+    int block = (int)(FDN_FIT_BLOCK_MS * sample_rate / 1000.0);
+    double lp = 0.0;
+    double energy = 0.0;
+
+    for (int i = 0; i < ir_length; i++) {
+        lp += (ir[i] - lp) * coeff;
+        if (i < start) continue;
+
+        double x = high ? ir[i] - lp : lp;
+        energy += x * x;
+        if (!fit || (i + 1 - start) % block != 0) continue;
+
+        double remaining = total - energy;
+        if (remaining <= 0.0) break;
+
+        double level = 10.0 * log10(remaining / total);
+        if (level > FDN_FIT_TOP_DB) continue;
+        if (level < FDN_FIT_BOTTOM_DB) break;
+
+        double t = (i + 1 - start) / (double)sample_rate;
+        fit->n += 1.0;
+        fit->t += t;
+        fit->y += level;
+        fit->tt += t * t;
+        fit->ty += t * level;
+    }
+    return energy;
+}
+
+// Time (s) the band's fitted energy decay takes to fall by 60 dB, or -1 when
+// the curve has too few points in the fit range
+static double fit_band_t60(const double* ir, int ir_length, int start, int sample_rate, int high) {
+    double total = band_energy_pass(ir, ir_length, start, sample_rate, high, 0.0, NULL);
+    if (total <= 0.0) return -1.0;
+
+    LineFit fit = { 0 };
+    band_energy_pass(ir, ir_length, start, sample_rate, high, total, &fit);
+
+    double spread = fit.n * fit.tt - fit.t * fit.t;
+    if (fit.n < FDN_FIT_MIN_BLOCKS || spread <= 0.0) return -1.0;
+
+    double slope = (fit.n * fit.ty - fit.t * fit.y) / spread;   // dB per second
+    if (slope >= -60.0 / FDN_MAX_T60) return FDN_MAX_T60;
+    return fmax(FDN_MIN_T60, -60.0 / slope);
+}
+
+// One-pole absorption for a line of length samples: the gain per pass that
+// decays by 60 dB in t60_low at DC and in t60_high at FDN_HIGH_BAND_HZ. The
+// response falls monotonically from DC, so the loop gain never exceeds the
+// DC gain (< 1). A high band decaying slower than the low one is not
+// followed - the line then decays at the low band's rate throughout
+static void design_absorption(FDNTail* fdn, int line, int length, int sample_rate) {
+    double g_dc = pow(10.0, -3.0 * length / (sample_rate * fdn->t60_low));
+    double g_high = pow(10.0, -3.0 * length / (sample_rate * fdn->t60_high));
+    double rho = (g_high / g_dc) * (g_high / g_dc);
+    double a = 0.0;
+
+    if (rho < 1.0 - 1e-9) {
+        // |b0 / (1 - a e^-jw)|^2 / (b0 / (1 - a))^2 = rho, the root inside the unit circle
+        double c = cos(2.0 * FDN_PI * FDN_HIGH_BAND_HZ / sample_rate);
+        double p = 1.0 - rho * c;
+        double q = 1.0 - rho;
+        a = (p - sqrt(fmax(0.0, p * p - q * q))) / q;
+    }
+
+    fdn->absorb_a[line] = a;
+    fdn->absorb_b0[line] = g_dc * (1.0 - a);
+}
+
+int fdn_tail_init(FDNTail* fdn, Arena* arena, int sample_rate, double size, const double* ir,
+                  int ir_length, int start, int fade, double lp_coeff, double hp_coeff) {
+    memset(fdn, 0, sizeof(FDNTail));
+
+    int shortest = line_length(sample_rate, size, 0);
+    if (start <= shortest || start + fade >= ir_length) return -1;
+
+    fdn->t60_low = fit_band_t60(ir, ir_length, start, sample_rate, 0);
+    fdn->t60_high = fit_band_t60(ir, ir_length, start, sample_rate, 1);
+    if (fdn->t60_low < 0.0) return -1;
+    if (fdn->t60_high < 0.0) fdn->t60_high = fdn->t60_low;
+
+    // The first line output lands on the crossover tap
+    fdn->start = start;
+    fdn->predelay_length = start - shortest;
+    fdn->predelay = (conv_sample_t*)arena_alloc(arena, fdn->predelay_length * sizeof(conv_sample_t));
+    int ok = fdn->predelay != NULL;
+
+    for (int d = 0; d < FDN_DIFFUSERS; d++) {
+        fdn->diffusers[d].length = diffuser_length(sample_rate, d);
+        fdn->diffusers[d].buffer = (double*)arena_alloc(arena, fdn->diffusers[d].length * sizeof(double));
+        ok = ok && fdn->diffusers[d].buffer;
+    }
+    for (int l = 0; l < FDN_LINES; l++) {
+        fdn->lines[l].length = line_length(sample_rate, size, l);
+        fdn->lines[l].buffer = (double*)arena_alloc(arena, fdn->lines[l].length * sizeof(double));
+        ok = ok && fdn->lines[l].buffer;
+        design_absorption(fdn, l, fdn->lines[l].length, sample_rate);
+    }
+    if (!ok) {
+        memset(fdn, 0, sizeof(FDNTail));
+        return -1;
+    }
+
+    fdn->lp_coeff = lp_coeff;
+    fdn->hp_coeff = hp_coeff;
+
+    // Level: an impulse through the network against the IR over the taps
+    // over the first FDN_MATCH_MS after the crossfade
+    int from = start + fade;
+    int to = from + (int)(FDN_MATCH_MS * sample_rate / 1000.0);
+    if (to > ir_length) to = ir_length;
+
+    double ir_energy = 0.0;
+    for (int i = from; i < to; i++) {
+        ir_energy += ir[i] * ir[i];
+    }
+
+    conv_sample_t in[FDN_MATCH_CHUNK];
+    conv_sample_t out[FDN_MATCH_CHUNK];
+    double net_energy = 0.0;
+
+    fdn->gain = 1.0;
+    fdn_tail_reset(fdn);
+    memset(in, 0, sizeof(in));
+    in[0] = 1;
+    for (int t0 = 0; t0 < to; t0 += FDN_MATCH_CHUNK) {
+        memset(out, 0, sizeof(out));
+        fdn_tail_process(fdn, in, out, FDN_MATCH_CHUNK);
+        in[0] = 0;
+        for (int i = 0; i < FDN_MATCH_CHUNK; i++) {
+            if (t0 + i >= from && t0 + i < to) net_energy += (double)out[i] * out[i];
+        }
+    }
+
+    if (net_energy <= 0.0) {
+        memset(fdn, 0, sizeof(FDNTail));
+        return -1;
+    }
+    fdn->gain = sqrt(ir_energy / net_energy);
+    fdn_tail_reset(fdn);
+    return 0;
+}
+
+void fdn_tail_reset(FDNTail* fdn) {
+    memset(fdn->predelay, 0, fdn->predelay_length * sizeof(conv_sample_t));
+    fdn->predelay_pos = 0;
+
+    for (int d = 0; d < FDN_DIFFUSERS; d++) {
+        memset(fdn->diffusers[d].buffer, 0, fdn->diffusers[d].length * sizeof(double));
+        fdn->diffusers[d].pos = 0;
+    }
+    for (int l = 0; l < FDN_LINES; l++) {
+        memset(fdn->lines[l].buffer, 0, fdn->lines[l].length * sizeof(double));
+        fdn->lines[l].pos = 0;
+        fdn->absorb_state[l] = 0.0;
+    }
+    fdn->lp_state = 0.0;
+    fdn->hp_state = 0.0;
+}
+
+void fdn_tail_process(FDNTail* fdn, const conv_sample_t* in, conv_sample_t* out, int n) {
+    double s[FDN_LINES];
+
+    for (int i = 0; i < n; i++) {
+        double x = fdn->predelay[fdn->predelay_pos];
+        fdn->predelay[fdn->predelay_pos] = in[i];
+        if (++fdn->predelay_pos == fdn->predelay_length) fdn->predelay_pos = 0;
+
+        for (int d = 0; d < FDN_DIFFUSERS; d++) {
+            FDNDelay* ap = &fdn->diffusers[d];
+            double delayed = ap->buffer[ap->pos];
+            double v = flush_denormal(x + FDN_DIFFUSION * delayed);
+            ap->buffer[ap->pos] = v;
+            if (++ap->pos == ap->length) ap->pos = 0;
+            x = delayed - FDN_DIFFUSION * v;
+        }
+
+        // Line outputs through their absorption filters; the output taps and
+        // the input injection alternate in sign so no single mode dominates
+        double sum = 0.0;
+        double y = 0.0;
+        for (int l = 0; l < FDN_LINES; l++) {
+            FDNDelay* line = &fdn->lines[l];
+            double a = flush_denormal(fdn->absorb_b0[l] * line->buffer[line->pos] +
+                                      fdn->absorb_a[l] * fdn->absorb_state[l]);
+            fdn->absorb_state[l] = a;
+            s[l] = a;
+            sum += a;
+            y += (l & 2) ? -a : a;
+        }
+
+        // Householder feedback matrix I - (2 / N) * ones: lossless, O(N)
+        double reflect = sum * (2.0 / FDN_LINES);
+        for (int l = 0; l < FDN_LINES; l++) {
+            FDNDelay* line = &fdn->lines[l];
+            line->buffer[line->pos] = s[l] - reflect + ((l & 1) ? -x : x);
+            if (++line->pos == line->length) line->pos = 0;
+        }
+
+        fdn->lp_state = flush_denormal(fdn->lp_state + (y - fdn->lp_state) * fdn->lp_coeff);
+        fdn->hp_state = flush_denormal(fdn->hp_state + (fdn->lp_state - fdn->hp_state) * fdn->hp_coeff);
+        out[i] += (conv_sample_t)(fdn->gain * (fdn->lp_state - fdn->hp_state));
+    }
+}
@@ -0,0 +1,76 @@
+// fdn_tail.h
+// Feedback delay network that carries the late IR on from a crossover tap,
+// with its per-band decay fitted to the IR's energy decay
+
+#ifndef FDN_TAIL_H
+#define FDN_TAIL_H
+
+#include <stddef.h>
+
+#include "arena.h"
+#include "sample_type.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FDN_LINES      8
+#define FDN_DIFFUSERS  4
+
+// Longest fitted decay; a segment that does not decay at all rings this long
+#define FDN_MAX_T60    100.0
+#define FDN_MIN_T60    0.05
+
+// Ring buffer of one delay line or allpass (reading before writing gives the
+// sample written length samples ago)
+typedef struct {
+    double* buffer;
+    int length;
+    int pos;
+} FDNDelay;
+
+// in -> pre-delay -> allpass diffusers -> 8 lines under a Householder matrix,
+// each with a one-pole absorption filter -> the IR's tone filter -> gain.
+// The pre-delay puts the first line output on the crossover tap, so the
+// network fades in under the convolved IR's fade-out.
+typedef struct {
+    conv_sample_t* predelay;
+    int predelay_length;
+    int predelay_pos;
+    int start;                          // Crossover tap
+
+    FDNDelay diffusers[FDN_DIFFUSERS];
+    FDNDelay lines[FDN_LINES];
+    double absorb_b0[FDN_LINES];        // y = b0 * x + a * y[-1]: DC gain b0 / (1 - a)
+    double absorb_a[FDN_LINES];
+    double absorb_state[FDN_LINES];
+
+    double lp_coeff, hp_coeff;          // Output tone filter, as on the IR
+    double lp_state, hp_state;
+    double gain;                        // Level of the IR just after the crossfade
+
+    double t60_low, t60_high;           // Fitted decay times (s) below/above the band split
+} FDNTail;
+
+// Arena bytes fdn_tail_init needs for a crossover at tap start
+size_t fdn_tail_bytes(int sample_rate, int start);
+
+// Carry ir on from tap start: fit the low- and high-band decay of taps
+// [start, ir_length), size the lines by size (0..100, as roomSize) and match
+// the level over the taps after the fade-long crossfade. lp_coeff/hp_coeff are
+// the IR's one-pole tone filter. Returns 0 on success, -1 if the arena is too
+// small or the segment holds too little energy to fit
+int  fdn_tail_init(FDNTail* fdn, Arena* arena, int sample_rate, double size, const double* ir,
+                   int ir_length, int start, int fade, double lp_coeff, double hp_coeff);
+
+// Forget all input; the fitted network is kept
+void fdn_tail_reset(FDNTail* fdn);
+
+// out[i] += (network * in)[i]
+void fdn_tail_process(FDNTail* fdn, const conv_sample_t* in, conv_sample_t* out, int n);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FDN_TAIL_H
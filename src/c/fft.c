@@ -0,0 +1,252 @@
+// fft.c
+// Real-input FFT: a half-length complex radix-2 FFT plus an even/odd split pass
+
+#include <math.h>
+#include <string.h>
+
+#include "fft.h"
+
+// Straight-line kernels from scripts/gen_fft_codelets.py (generated at build time)
+#ifdef HAVE_FFT_CODELETS
+#include "fft_codelets.h"
+#endif
+
+#define FFT_PI 3.14159265358979323846
+
+size_t fft_plan_bytes(int size) {
+    int half = size / 2;
+    return ARENA_BYTES(half, int) +
+           2 * ARENA_BYTES(half, conv_sample_t) +        // Inner twiddles
+           2 * ARENA_BYTES(half + 1, conv_sample_t) +    // Split twiddles
+           2 * ARENA_BYTES(half, conv_sample_t);         // Work buffers
+}
+
+int fft_plan_init(FFTPlan* plan, int size, Arena* arena) {
+    memset(plan, 0, sizeof(FFTPlan));
+
+    if (size < 4 || (size & (size - 1)) != 0) {
+        return -1;
+    }
+
+    int half = size / 2;
+    int log2_half = 0;
+    while ((1 << log2_half) < half) log2_half++;
+
+    plan->size = size;
+    plan->half = half;
+    plan->log2_half = log2_half;
+    plan->pass_steps = log2_half;
+#ifdef HAVE_FFT_CODELETS
+    if (log2_half > 0) {
+        plan->codelet_log2 = log2_half < FFT_CODELET_MAX_LOG2 ? log2_half : FFT_CODELET_MAX_LOG2;
+        plan->pass_steps = log2_half - plan->codelet_log2 + 1;
+    }
+#endif
+
+    plan->bitrev = (int*)arena_alloc(arena, half * sizeof(int));
+    plan->tw_re = (conv_sample_t*)arena_alloc(arena, half * sizeof(conv_sample_t));
+    plan->tw_im = (conv_sample_t*)arena_alloc(arena, half * sizeof(conv_sample_t));
+    plan->split_re = (conv_sample_t*)arena_alloc(arena, (half + 1) * sizeof(conv_sample_t));
+    plan->split_im = (conv_sample_t*)arena_alloc(arena, (half + 1) * sizeof(conv_sample_t));
+    plan->work_re = (conv_sample_t*)arena_alloc(arena, half * sizeof(conv_sample_t));
+    plan->work_im = (conv_sample_t*)arena_alloc(arena, half * sizeof(conv_sample_t));
+
+    if (!plan->bitrev || !plan->tw_re || !plan->tw_im || !plan->split_re ||
+        !plan->split_im || !plan->work_re || !plan->work_im) {
+        memset(plan, 0, sizeof(FFTPlan));
+        return -1;
+    }
+
+    for (int i = 0; i < half; i++) {
+        int r = 0;
+        for (int b = 0; b < log2_half; b++) {
+            if (i & (1 << b)) r |= 1 << (log2_half - 1 - b);
+        }
+        plan->bitrev[i] = r;
+
+        plan->tw_re[i] = cos(2.0 * FFT_PI * i / half);
+        plan->tw_im[i] = -sin(2.0 * FFT_PI * i / half);
+    }
+
+    for (int k = 0; k <= half; k++) {
+        plan->split_re[k] = cos(2.0 * FFT_PI * k / size);
+        plan->split_im[k] = -sin(2.0 * FFT_PI * k / size);
+    }
+
+    return 0;
+}
+
+// One radix-2 butterfly pass combining sub-transforms of len / 2 into len
+static void fft_complex_pass(FFTPlan* plan, conv_sample_t* re, conv_sample_t* im, int len, int inverse) {
+    int n = plan->half;
+    int half_len = len >> 1;
+    int step = n / len;
+    conv_sample_t sign = inverse ? -1 : 1;
+
+    for (int start = 0; start < n; start += len) {
+        for (int j = 0; j < half_len; j++) {
+            conv_sample_t wr = plan->tw_re[j * step];
+            conv_sample_t wi = sign * plan->tw_im[j * step];
+
+            int a = start + j;
+            int b = a + half_len;
+
+            conv_sample_t tr = re[b] * wr - im[b] * wi;
+            conv_sample_t ti = re[b] * wi + im[b] * wr;
+
+            re[b] = re[a] - tr;
+            im[b] = im[a] - ti;
+            re[a] += tr;
+            im[a] += ti;
+        }
+    }
+}
+
+// Butterfly step k of the in-place FFT over bit-reversed input. With codelets,
+// step 0 transforms every block of 2^codelet_log2 points in one go (the same
+// result as the first codelet_log2 passes) and the later steps continue with
+// the generic passes
+static void fft_complex_step(FFTPlan* plan, conv_sample_t* re, conv_sample_t* im, int k, int inverse) {
+#ifdef HAVE_FFT_CODELETS
+    if (plan->codelet_log2 > 0) {
+        if (k == 0) {
+            FFTCodelet codelet = inverse ? fft_codelets_inverse[plan->codelet_log2]
+                                         : fft_codelets_forward[plan->codelet_log2];
+            int block = 1 << plan->codelet_log2;
+            for (int start = 0; start < plan->half; start += block) {
+                codelet(re + start, im + start);
+            }
+            return;
+        }
+        k += plan->codelet_log2 - 1;
+    }
+#endif
+    fft_complex_pass(plan, re, im, 2 << k, inverse);
+}
+
+static void fft_complex_passes(FFTPlan* plan, conv_sample_t* re, conv_sample_t* im, int inverse) {
+    for (int k = 0; k < plan->pass_steps; k++) {
+        fft_complex_step(plan, re, im, k, inverse);
+    }
+}
+
+// Pack even/odd samples as one complex sequence, in bit-reversed order
+static void fft_forward_pack(FFTPlan* plan, const conv_sample_t* in) {
+    conv_sample_t* zr = plan->work_re;
+    conv_sample_t* zi = plan->work_im;
+
+    for (int k = 0; k < plan->half; k++) {
+        int r = plan->bitrev[k];
+        zr[r] = in[2 * k];
+        zi[r] = in[2 * k + 1];
+    }
+}
+
+// Separate the even and odd spectra and combine them into N/2 + 1 bins
+static void fft_forward_split(FFTPlan* plan, conv_sample_t* re, conv_sample_t* im) {
+    int half = plan->half;
+    const conv_sample_t* zr = plan->work_re;
+    const conv_sample_t* zi = plan->work_im;
+
+    re[0] = zr[0] + zi[0];
+    im[0] = 0;
+    re[half] = zr[0] - zi[0];
+    im[half] = 0;
+
+    for (int k = 1; k < half; k++) {
+        conv_sample_t ar = zr[k], ai = zi[k];
+        conv_sample_t br = zr[half - k], bi = zi[half - k];
+
+        conv_sample_t even_re = (conv_sample_t)0.5 * (ar + br);
+        conv_sample_t even_im = (conv_sample_t)0.5 * (ai - bi);
+        conv_sample_t odd_re = (conv_sample_t)0.5 * (ai + bi);
+        conv_sample_t odd_im = (conv_sample_t)-0.5 * (ar - br);
+
+        conv_sample_t wr = plan->split_re[k];
+        conv_sample_t wi = plan->split_im[k];
+
+        re[k] = even_re + odd_re * wr - odd_im * wi;
+        im[k] = even_im + odd_re * wi + odd_im * wr;
+    }
+}
+
+// Rebuild the packed even/odd spectrum, scattered into bit-reversed order
+static void fft_inverse_pack(FFTPlan* plan, const double* re, const double* im) {
+    int half = plan->half;
+    conv_sample_t* zr = plan->work_re;
+    conv_sample_t* zi = plan->work_im;
+
+    for (int k = 0; k < half; k++) {
+        double ar = re[k], ai = im[k];
+        double br = re[half - k], bi = -im[half - k];
+
+        double even_re = 0.5 * (ar + br);
+        double even_im = 0.5 * (ai + bi);
+        double dr = 0.5 * (ar - br);
+        double di = 0.5 * (ai - bi);
+
+        // Divide by the split twiddle (multiply by its conjugate)
+        double wr = plan->split_re[k];
+        double wi = -plan->split_im[k];
+        double odd_re = dr * wr - di * wi;
+        double odd_im = dr * wi + di * wr;
+
+        int r = plan->bitrev[k];
+        zr[r] = (conv_sample_t)(even_re - odd_im);
+        zi[r] = (conv_sample_t)(even_im + odd_re);
+    }
+}
+
+static void fft_inverse_unpack(FFTPlan* plan, conv_sample_t* out) {
+    const conv_sample_t* zr = plan->work_re;
+    const conv_sample_t* zi = plan->work_im;
+    conv_sample_t scale = (conv_sample_t)1 / plan->half;
+
+    for (int k = 0; k < plan->half; k++) {
+        out[2 * k] = zr[k] * scale;
+        out[2 * k + 1] = zi[k] * scale;
+    }
+}
+
+void fft_real_forward(FFTPlan* plan, const conv_sample_t* in, conv_sample_t* re, conv_sample_t* im) {
+    fft_forward_pack(plan, in);
+    fft_complex_passes(plan, plan->work_re, plan->work_im, 0);
+    fft_forward_split(plan, re, im);
+}
+
+void fft_real_inverse(FFTPlan* plan, const double* re, const double* im, conv_sample_t* out) {
+    fft_inverse_pack(plan, re, im);
+    fft_complex_passes(plan, plan->work_re, plan->work_im, 1);
+    fft_inverse_unpack(plan, out);
+}
+
+int fft_step_count(const FFTPlan* plan) {
+    return plan->pass_steps + 2;
+}
+
+int fft_step_passes(const FFTPlan* plan, int step) {
+    if (step <= 0 || step > plan->pass_steps) return 0;
+    return (step == 1 && plan->codelet_log2 > 0) ? plan->codelet_log2 : 1;
+}
+
+void fft_forward_step(FFTPlan* plan, int step, const conv_sample_t* in,
+                      conv_sample_t* re, conv_sample_t* im) {
+    if (step == 0) {
+        fft_forward_pack(plan, in);
+    } else if (step <= plan->pass_steps) {
+        fft_complex_step(plan, plan->work_re, plan->work_im, step - 1, 0);
+    } else {
+        fft_forward_split(plan, re, im);
+    }
+}
+
+void fft_inverse_step(FFTPlan* plan, int step, const double* re, const double* im,
+                      conv_sample_t* out) {
+    if (step == 0) {
+        fft_inverse_pack(plan, re, im);
+    } else if (step <= plan->pass_steps) {
+        fft_complex_step(plan, plan->work_re, plan->work_im, step - 1, 1);
+    } else {
+        fft_inverse_unpack(plan, out);
+    }
+}
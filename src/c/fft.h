@@ -0,0 +1,64 @@
+// fft.h
+// Real-input radix-2 FFT used by the partitioned convolver
+
+#ifndef FFT_H
+#define FFT_H
+
+#include "arena.h"
+#include "sample_type.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Precomputed tables and scratch for one transform size.
+// Spectra are stored split-complex: size/2 + 1 real parts and imaginary parts.
+typedef struct {
+    int size;           // Real transform length N (power of two)
+    int half;           // N/2 - length of the inner complex FFT
+    int log2_half;
+    int codelet_log2;   // Passes the generated codelet covers (0: generic passes only)
+    int pass_steps;     // Butterfly steps: the codelet counts as one
+    int* bitrev;        // Bit-reversal permutation for the inner FFT
+    conv_sample_t* tw_re;      // Inner FFT twiddles, e^(-2*pi*i*k/half)
+    conv_sample_t* tw_im;
+    conv_sample_t* split_re;   // Real/complex split twiddles, e^(-2*pi*i*k/N)
+    conv_sample_t* split_im;
+    conv_sample_t* work_re;    // Inner FFT scratch
+    conv_sample_t* work_im;
+} FFTPlan;
+
+// Arena bytes needed by fft_plan_init for this size
+size_t fft_plan_bytes(int size);
+
+// Tables live in the arena (released with it). Returns 0 on success, -1 if
+// size is not a power of two >= 4 or the arena is too small
+int  fft_plan_init(FFTPlan* plan, int size, Arena* arena);
+
+// in: N real samples -> re/im: N/2 + 1 bins
+void fft_real_forward(FFTPlan* plan, const conv_sample_t* in, conv_sample_t* re, conv_sample_t* im);
+
+// re/im: N/2 + 1 bins -> out: N real samples (normalized: forward then inverse is identity).
+// The spectrum is double so MAC accumulators feed it without a conversion pass.
+void fft_real_inverse(FFTPlan* plan, const double* re, const double* im, conv_sample_t* out);
+
+// Stepwise variants for spreading one transform over several audio callbacks:
+// step 0 packs the input, steps 1..pass_steps are the butterfly passes (the
+// first one runs the codelet when there is one) and the last step produces
+// the output. The plan's work buffers hold the state between steps, so a plan
+// runs one transform at a time
+int  fft_step_count(const FFTPlan* plan);
+void fft_forward_step(FFTPlan* plan, int step, const conv_sample_t* in,
+                      conv_sample_t* re, conv_sample_t* im);
+void fft_inverse_step(FFTPlan* plan, int step, const double* re, const double* im,
+                      conv_sample_t* out);
+
+// Radix-2 passes a step performs (0 for the pack and output steps) - a rough
+// measure of its cost
+int  fft_step_passes(const FFTPlan* plan, int step);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FFT_H
@@ -0,0 +1,388 @@
+// fft_convolver.c
+// Zero-latency uniformly partitioned overlap-save convolution
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "fft_convolver.h"
+#include "denormal.h"
+
+static int partition_count(int block_size, int ir_length) {
+    int tail_length = ir_length > block_size ? ir_length - block_size : 0;
+    return (tail_length + block_size - 1) / block_size;
+}
+
+size_t fft_convolver_bytes(int block_size, int ir_length) {
+    size_t B = block_size;
+    size_t P = partition_count(block_size, ir_length);
+    size_t bins = B + 1;
+
+    size_t bytes = fft_plan_bytes(block_size * 2)
+                 + ARENA_BYTES(B, conv_sample_t)               // head
+                 + ARENA_BYTES(2 * B, conv_sample_t)           // input
+                 + ARENA_BYTES(B, conv_sample_t)               // tail_out
+                 + 2 * ARENA_BYTES(bins, double)               // accumulator
+                 + ARENA_BYTES(2 * B, conv_sample_t);          // scratch
+
+    if (P > 0) {
+        bytes += 4 * ARENA_BYTES(P * bins, conv_sample_t)      // IR spectra + delay line
+               + ARENA_BYTES(P, unsigned char)
+               + ARENA_BYTES(P, int);
+    }
+    return bytes;
+}
+
+int fft_convolver_init_empty(FFTConvolver* conv, Arena* arena, int block_size, int ir_length) {
+    memset(conv, 0, sizeof(FFTConvolver));
+
+    if (fft_plan_init(&conv->plan, block_size * 2, arena) != 0) {
+        return -1;
+    }
+
+    int B = block_size;
+
+    conv->block_size = B;
+    conv->bins = B + 1;
+    conv->ir_length = ir_length;
+    conv->num_partitions = partition_count(B, ir_length);
+
+    int spectrum_size = conv->num_partitions * conv->bins;
+
+    conv->head = (conv_sample_t*)arena_alloc(arena, B * sizeof(conv_sample_t));
+    conv->input = (conv_sample_t*)arena_alloc(arena, 2 * B * sizeof(conv_sample_t));
+    conv->tail_out = (conv_sample_t*)arena_alloc(arena, B * sizeof(conv_sample_t));
+    conv->acc_re = (double*)arena_alloc(arena, conv->bins * sizeof(double));
+    conv->acc_im = (double*)arena_alloc(arena, conv->bins * sizeof(double));
+    conv->scratch = (conv_sample_t*)arena_alloc(arena, 2 * B * sizeof(conv_sample_t));
+
+    if (spectrum_size > 0) {
+        conv->ir_re = (conv_sample_t*)arena_alloc(arena, spectrum_size * sizeof(conv_sample_t));
+        conv->ir_im = (conv_sample_t*)arena_alloc(arena, spectrum_size * sizeof(conv_sample_t));
+        conv->fdl_re = (conv_sample_t*)arena_alloc(arena, spectrum_size * sizeof(conv_sample_t));
+        conv->fdl_im = (conv_sample_t*)arena_alloc(arena, spectrum_size * sizeof(conv_sample_t));
+        conv->fdl_active = (unsigned char*)arena_alloc(arena, conv->num_partitions);
+        conv->active_partitions = (int*)arena_alloc(arena, conv->num_partitions * sizeof(int));
+    }
+
+    if (!conv->head || !conv->input || !conv->tail_out || !conv->acc_re ||
+        !conv->acc_im || !conv->scratch ||
+        (spectrum_size > 0 && (!conv->ir_re || !conv->ir_im || !conv->fdl_re || !conv->fdl_im ||
+                               !conv->fdl_active || !conv->active_partitions))) {
+        memset(conv, 0, sizeof(FFTConvolver));
+        return -1;
+    }
+
+    return 0;
+}
+
+int fft_convolver_init(FFTConvolver* conv, Arena* arena, int block_size, const double* ir, int ir_length) {
+    if (fft_convolver_init_empty(conv, arena, block_size, ir_length) != 0) {
+        return -1;
+    }
+
+    double total_energy = 0.0;
+    for (int i = 0; i < ir_length; i++) {
+        total_energy += ir[i] * ir[i];
+    }
+    fft_convolver_load(conv, ir, ir_length, total_energy * FFT_CONVOLVER_PARTITION_FLOOR);
+    return 0;
+}
+
+void fft_convolver_load(FFTConvolver* conv, const double* ir, int ready, double floor_energy) {
+    int B = conv->block_size;
+    if (ready > conv->ir_length) ready = conv->ir_length;
+
+    // Direct-form head
+    int head_length = conv->ir_length < B ? conv->ir_length : B;
+    if (conv->loaded == 0 && ready >= head_length) {
+        for (int i = 0; i < head_length; i++) {
+            conv->head[i] = (conv_sample_t)ir[i];
+            if (conv->head[i] != 0) conv->head_active = 1;
+        }
+        conv->loaded = head_length;
+    }
+
+    // Partition spectra: segment k covers IR taps [B + k*B, B + (k+1)*B), zero-padded to 2B
+    while (conv->loaded >= B && conv->loaded < conv->ir_length) {
+        int k = (conv->loaded - B) / B;
+        int start = B + k * B;
+        int count = conv->ir_length - start < B ? conv->ir_length - start : B;
+        if (start + count > ready) break;
+        conv->loaded = start + count;
+
+        double energy = 0.0;
+        for (int i = 0; i < count; i++) {
+            energy += ir[start + i] * ir[start + i];
+        }
+        if (energy <= floor_energy) continue;  // Spectrum stays zero, never multiplied
+
+        memset(conv->scratch, 0, 2 * B * sizeof(conv_sample_t));
+        for (int i = 0; i < count; i++) {
+            conv->scratch[i] = (conv_sample_t)ir[start + i];
+        }
+
+        fft_real_forward(&conv->plan, conv->scratch,
+                         conv->ir_re + k * conv->bins, conv->ir_im + k * conv->bins);
+        conv->active_partitions[conv->num_active++] = k;
+    }
+}
+
+void fft_convolver_truncate(FFTConvolver* conv, int ir_length) {
+    int B = conv->block_size;
+    while (conv->num_active > 0 && B + conv->active_partitions[conv->num_active - 1] * B >= ir_length) {
+        conv->num_active--;
+    }
+}
+
+static void put_u32(unsigned char* p, uint32_t value) {
+    p[0] = (unsigned char)value;
+    p[1] = (unsigned char)(value >> 8);
+    p[2] = (unsigned char)(value >> 16);
+    p[3] = (unsigned char)(value >> 24);
+}
+
+static uint32_t get_u32(const unsigned char* p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void put_f32(unsigned char* p, conv_sample_t value) {
+    float f = (float)value;
+    uint32_t bits;
+    memcpy(&bits, &f, 4);
+    put_u32(p, bits);
+}
+
+static conv_sample_t get_f32(const unsigned char* p) {
+    uint32_t bits = get_u32(p);
+    float f;
+    memcpy(&f, &bits, 4);
+    return (conv_sample_t)f;
+}
+
+// Header: block size, head_active, num_active; then the head, then per active
+// partition its index and bins real and bins imaginary values. Spectra are
+// stored in single precision in both engine variants
+size_t fft_convolver_export(const FFTConvolver* conv, unsigned char* out) {
+    int B = conv->block_size;
+    int bins = conv->bins;
+    size_t bytes = 12 + 4 * (size_t)B + (size_t)conv->num_active * (4 + 8 * (size_t)bins);
+    if (!out) return bytes;
+
+    put_u32(out, (uint32_t)B);
+    put_u32(out + 4, (uint32_t)conv->head_active);
+    put_u32(out + 8, (uint32_t)conv->num_active);
+    unsigned char* p = out + 12;
+    for (int i = 0; i < B; i++, p += 4) {
+        put_f32(p, i < conv->loaded ? conv->head[i] : 0);
+    }
+    for (int a = 0; a < conv->num_active; a++) {
+        int k = conv->active_partitions[a];
+        put_u32(p, (uint32_t)k);
+        p += 4;
+        for (int b = 0; b < bins; b++, p += 4) put_f32(p, conv->ir_re[k * bins + b]);
+        for (int b = 0; b < bins; b++, p += 4) put_f32(p, conv->ir_im[k * bins + b]);
+    }
+    return bytes;
+}
+
+int fft_convolver_import(FFTConvolver* conv, const unsigned char* data, size_t size) {
+    int B = conv->block_size;
+    int bins = conv->bins;
+    if (size < 12 || (int)get_u32(data) != B) return -1;
+
+    int num_active = (int)get_u32(data + 8);
+    if (num_active < 0 || num_active > conv->num_partitions ||
+        size < 12 + 4 * (size_t)B + (size_t)num_active * (4 + 8 * (size_t)bins)) {
+        return -1;
+    }
+
+    const unsigned char* p = data + 12;
+    for (int i = 0; i < B; i++, p += 4) {
+        conv->head[i] = get_f32(p);
+    }
+    conv->head_active = get_u32(data + 4) != 0;
+
+    // Partitions come in increasing order, each inside this layout
+    for (int a = 0; a < num_active; a++) {
+        int k = (int)get_u32(p);
+        p += 4;
+        if (k >= conv->num_partitions || (a > 0 && k <= conv->active_partitions[a - 1])) {
+            conv->num_active = 0;
+            conv->head_active = 0;
+            memset(conv->head, 0, B * sizeof(conv_sample_t));
+            return -1;
+        }
+        for (int b = 0; b < bins; b++, p += 4) conv->ir_re[k * bins + b] = get_f32(p);
+        for (int b = 0; b < bins; b++, p += 4) conv->ir_im[k * bins + b] = get_f32(p);
+        conv->active_partitions[a] = k;
+        conv->num_active = a + 1;
+    }
+    conv->loaded = conv->ir_length;
+    return 0;
+}
+
+void fft_convolver_reset(FFTConvolver* conv) {
+    int B = conv->block_size;
+    int spectrum_size = conv->num_partitions * conv->bins;
+
+    if (conv->input) memset(conv->input, 0, 2 * B * sizeof(conv_sample_t));
+    if (conv->tail_out) memset(conv->tail_out, 0, B * sizeof(conv_sample_t));
+    if (spectrum_size > 0) {
+        memset(conv->fdl_re, 0, spectrum_size * sizeof(conv_sample_t));
+        memset(conv->fdl_im, 0, spectrum_size * sizeof(conv_sample_t));
+        memset(conv->fdl_active, 0, conv->num_partitions);
+    }
+    conv->fdl_pos = 0;
+    conv->pos = 0;
+    conv->block_active = 0;
+    conv->prev_block_active = 0;
+}
+
+// Partition output for the next block, with the newest input spectrum in
+// delay-line slot newest
+static void convolve_partitions(FFTConvolver* conv, int newest) {
+    int B = conv->block_size;
+    int bins = conv->bins;
+    int P = conv->num_partitions;
+    int contributed = 0;
+
+    // Partition k meets the input spectrum from k blocks ago; only pairs
+    // where both sides are non-empty are multiplied
+    for (int a = 0; a < conv->num_active; a++) {
+        int k = conv->active_partitions[a];
+        int slot = newest - k;
+        if (slot < 0) slot += P;
+        if (!conv->fdl_active[slot]) continue;
+
+        if (!contributed) {
+            memset(conv->acc_re, 0, bins * sizeof(double));
+            memset(conv->acc_im, 0, bins * sizeof(double));
+            contributed = 1;
+        }
+
+        const conv_sample_t* xr = conv->fdl_re + slot * bins;
+        const conv_sample_t* xi = conv->fdl_im + slot * bins;
+        const conv_sample_t* hr = conv->ir_re + k * bins;
+        const conv_sample_t* hi = conv->ir_im + k * bins;
+
+        // Products in the sample precision, sums across partitions in double
+        for (int b = 0; b < bins; b++) {
+            conv->acc_re[b] += xr[b] * hr[b] - xi[b] * hi[b];
+            conv->acc_im[b] += xr[b] * hi[b] + xi[b] * hr[b];
+        }
+    }
+
+    if (contributed) {
+        fft_real_inverse(&conv->plan, conv->acc_re, conv->acc_im, conv->scratch);
+
+        // Overlap-save: only the second half is free of circular wrap
+        memcpy(conv->tail_out, conv->scratch + B, B * sizeof(conv_sample_t));
+    } else {
+        memset(conv->tail_out, 0, B * sizeof(conv_sample_t));
+    }
+}
+
+// A full input block is available: push its spectrum into the delay line and
+// compute the partition contribution for the next block.
+static void process_block(FFTConvolver* conv) {
+    int B = conv->block_size;
+    int bins = conv->bins;
+    int P = conv->num_partitions;
+
+    if (P > 0) {
+        // A window of two silent blocks has an all-zero spectrum - skip its FFT
+        int window_active = conv->block_active || conv->prev_block_active;
+        conv->fdl_active[conv->fdl_pos] = (unsigned char)window_active;
+
+        if (window_active) {
+            conv_sample_t* x_re = conv->fdl_re + conv->fdl_pos * bins;
+            conv_sample_t* x_im = conv->fdl_im + conv->fdl_pos * bins;
+            fft_real_forward(&conv->plan, conv->input, x_re, x_im);
+        }
+
+        convolve_partitions(conv, conv->fdl_pos);
+        conv->fdl_pos = (conv->fdl_pos + 1) % P;
+    }
+
+    // Current block becomes the previous one
+    memcpy(conv->input, conv->input + B, B * sizeof(conv_sample_t));
+    conv->prev_block_active = conv->block_active;
+    conv->block_active = 0;
+    conv->pos = 0;
+}
+
+void fft_convolver_take_history(FFTConvolver* conv, const FFTConvolver* from) {
+    int B = conv->block_size;
+    int bins = conv->bins;
+    int P = conv->num_partitions;
+
+    memcpy(conv->input, from->input, 2 * B * sizeof(conv_sample_t));
+    conv->pos = from->pos;
+    conv->block_active = from->block_active;
+    conv->prev_block_active = from->prev_block_active;
+    if (P == 0) return;
+
+    // Slot P - a gets the spectrum from a blocks ago; slot 0 is written next
+    conv->fdl_pos = 0;
+    conv->fdl_active[0] = 0;
+    for (int a = 1; a < P; a++) {
+        int src = from->fdl_pos - a;
+        if (src < 0) src += from->num_partitions;
+        if (a > from->num_partitions || !from->fdl_active[src]) {
+            conv->fdl_active[P - a] = 0;
+            continue;
+        }
+        conv->fdl_active[P - a] = 1;
+        memcpy(conv->fdl_re + (P - a) * bins, from->fdl_re + src * bins, bins * sizeof(conv_sample_t));
+        memcpy(conv->fdl_im + (P - a) * bins, from->fdl_im + src * bins, bins * sizeof(conv_sample_t));
+    }
+
+    // The current block's partition output, for this IR
+    convolve_partitions(conv, P - 1);
+}
+
+void fft_convolver_process(FFTConvolver* conv, const conv_sample_t* in, conv_sample_t* out, int n) {
+    int B = conv->block_size;
+    int done = 0;
+
+    while (done < n) {
+        int chunk = B - conv->pos;
+        if (chunk > n - done) chunk = n - done;
+
+        // Copy the input, zeroing anything near the subnormal range so neither
+        // the head nor the FFTs ever multiply denormals
+        conv_sample_t* block = conv->input + B + conv->pos;
+        for (int i = 0; i < chunk; i++) {
+            conv_sample_t x = in[done + i];
+            double mag = fabs(x);
+            if (DENORMAL_PROTECTION && mag < FFT_CONVOLVER_DENORMAL_LEVEL) x = 0;
+            if (mag > FFT_CONVOLVER_SILENCE_LEVEL) conv->block_active = 1;
+            block[i] = x;
+        }
+
+        // The head only sees the last B samples - nothing to do if they are silent
+        int head_live = conv->head_active && (conv->block_active || conv->prev_block_active);
+
+        for (int i = 0; i < chunk; i++) {
+            double y = conv->tail_out[conv->pos + i];
+
+            if (head_live) {
+                // block[i - j] reaches back into the previous block for j > pos + i
+                const conv_sample_t* x = block + i;
+                for (int j = 0; j < B; j++) {
+                    y += conv->head[j] * x[-j];
+                }
+            }
+
+            out[done + i] = (conv_sample_t)y;
+        }
+
+        conv->pos += chunk;
+        done += chunk;
+
+        if (conv->pos == B) {
+            process_block(conv);
+        }
+    }
+}
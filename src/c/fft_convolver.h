@@ -0,0 +1,110 @@
+// fft_convolver.h
+// Zero-latency uniformly partitioned convolution (direct head + FFT partitions)
+
+#ifndef FFT_CONVOLVER_H
+#define FFT_CONVOLVER_H
+
+#include "fft.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Partitions carrying less than this fraction of the IR's energy are treated
+// as empty (-150 dB, well under the IR trim threshold)
+#define FFT_CONVOLVER_PARTITION_FLOOR 1e-15
+
+// Input blocks whose peak stays at or below this level count as silent
+// (none with -DCONV_NO_SILENCE_GATING, for benchmarks)
+#ifdef CONV_NO_SILENCE_GATING
+#define FFT_CONVOLVER_SILENCE_LEVEL   -1.0
+#else
+#define FFT_CONVOLVER_SILENCE_LEVEL   1e-10
+#endif
+
+// Input samples below this are zeroed on entry (denormal protection)
+#define FFT_CONVOLVER_DENORMAL_LEVEL  1e-30
+
+// The first block_size taps are convolved directly in the time domain, so the
+// output has no added latency. Every later block_size-long segment of the IR is
+// a partition convolved by overlap-save against a frequency-domain delay line.
+// Empty IR partitions and silent input blocks are flagged so their FFTs and
+// spectrum multiplies are skipped.
+typedef struct {
+    int block_size;         // Partition length B
+    int num_partitions;     // FFT partitions after the direct head
+    int bins;               // B + 1 spectrum bins per partition
+    int ir_length;          // Taps the partitions are laid out for
+    int loaded;             // Taps [0, loaded) are in the head and spectra
+    FFTPlan plan;           // Transform of size 2B
+
+    conv_sample_t* head;    // IR taps [0, B), convolved directly
+    int head_active;        // 0 when the head is all zeros
+
+    conv_sample_t* ir_re;   // Partition spectra, num_partitions * bins
+    conv_sample_t* ir_im;
+    int* active_partitions; // Indices of the non-empty partitions
+    int num_active;
+
+    conv_sample_t* fdl_re;  // Input spectra ring (frequency-domain delay line)
+    conv_sample_t* fdl_im;
+    unsigned char* fdl_active;  // Per slot: 0 when the input window was silent
+    int fdl_pos;            // Slot holding the newest input spectrum
+
+    int block_active;       // Current input block has signal so far
+    int prev_block_active;  // Previous input block had signal
+
+    conv_sample_t* input;   // 2B: previous block followed by the current block
+    conv_sample_t* tail_out;  // B: partition output for the current block
+    double* acc_re;         // MAC accumulator, bins (double in both precisions)
+    double* acc_im;
+    conv_sample_t* scratch;   // 2B inverse FFT output
+    int pos;                // Write position inside the current block
+} FFTConvolver;
+
+// Arena bytes fft_convolver_init needs for an IR of ir_length samples
+size_t fft_convolver_bytes(int block_size, int ir_length);
+
+// All buffers come from the arena and are released with it.
+// Returns 0 on success, -1 if the arena is too small
+int  fft_convolver_init(FFTConvolver* conv, Arena* arena, int block_size, const double* ir, int ir_length);
+
+// Same layout with no taps loaded yet: the output stays silent until
+// fft_convolver_load fills the IR in
+int  fft_convolver_init_empty(FFTConvolver* conv, Arena* arena, int block_size, int ir_length);
+
+// Load the head and every partition that lies wholly inside taps [0, ready) of
+// ir and is not loaded yet; partitions at or below floor_energy stay empty.
+// Safe between process calls: a partition that joins convolves the input
+// history the delay line already holds
+void fft_convolver_load(FFTConvolver* conv, const double* ir, int ready, double floor_energy);
+
+// Stop convolving the partitions that start at or past tap ir_length
+void fft_convolver_truncate(FFTConvolver* conv, int ir_length);
+
+// Loaded IR as bytes: block size, head and the non-empty partition spectra,
+// all as little-endian 32-bit values. Returns the byte count; with out NULL
+// only counts
+size_t fft_convolver_export(const FFTConvolver* conv, unsigned char* out);
+
+// Load the IR from fft_convolver_export bytes into a convolver just laid out
+// by fft_convolver_init_empty - no FFTs. Returns 0, or -1 if the bytes do not
+// fit this layout (the convolver is then left empty)
+int  fft_convolver_import(FFTConvolver* conv, const unsigned char* data, size_t size);
+
+// Carry on from the input history of from (same block size) with this
+// convolver's IR, e.g. to swap a rebuilt IR in without a gap. Input older than
+// from's IR length reached is not known and counts as silence
+void fft_convolver_take_history(FFTConvolver* conv, const FFTConvolver* from);
+
+// Forget all input history; the IR is kept
+void fft_convolver_reset(FFTConvolver* conv);
+
+// out[i] = (ir * in)[i]; out may not alias in
+void fft_convolver_process(FFTConvolver* conv, const conv_sample_t* in, conv_sample_t* out, int n);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FFT_CONVOLVER_H
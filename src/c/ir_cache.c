@@ -0,0 +1,223 @@
+// ir_cache.c
+// Precomputed IR blob and its parameter hash
+
+#include <math.h>
+#include <string.h>
+
+#include "ir_cache.h"
+
+#define IR_CACHE_FORMAT_VERSION 1
+
+static const unsigned char ir_cache_magic[4] = { 'C', 'R', 'I', 'R' };
+
+static void put_u32(unsigned char* p, uint32_t value) {
+    p[0] = (unsigned char)value;
+    p[1] = (unsigned char)(value >> 8);
+    p[2] = (unsigned char)(value >> 16);
+    p[3] = (unsigned char)(value >> 24);
+}
+
+static uint32_t get_u32(const unsigned char* p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void put_f64(unsigned char* p, double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, 8);
+    put_u32(p, (uint32_t)bits);
+    put_u32(p + 4, (uint32_t)(bits >> 32));
+}
+
+static double get_f64(const unsigned char* p) {
+    uint64_t bits = get_u32(p) | ((uint64_t)get_u32(p + 4) << 32);
+    double value;
+    memcpy(&value, &bits, 8);
+    return value;
+}
+
+uint32_t ir_cache_hash(uint32_t hash, const void* data, size_t bytes) {
+    const unsigned char* p = (const unsigned char*)data;
+    for (size_t i = 0; i < bytes; i++) {
+        hash = (hash ^ p[i]) * 16777619u;
+    }
+    return hash;
+}
+
+static void put_f32(unsigned char* p, float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, 4);
+    put_u32(p, bits);
+}
+
+static float get_f32(const unsigned char* p) {
+    uint32_t bits = get_u32(p);
+    float value;
+    memcpy(&value, &bits, 4);
+    return value;
+}
+
+static size_t packed_ir_bytes(int length) {
+    size_t blocks = ((size_t)length + IR_CACHE_PACK_BLOCK - 1) / IR_CACHE_PACK_BLOCK;
+    return 4 * blocks + 2 * (size_t)length;
+}
+
+// Bytes before the spectra
+static size_t ir_section_bytes(const IRCacheInfo* info) {
+    return IR_CACHE_HEADER_BYTES +
+           8 * (size_t)(2 * info->early_spread + 1) +
+           IR_CACHE_TAP_BYTES * (size_t)info->num_early_taps +
+           (info->packed ? packed_ir_bytes(info->ir_length) : 4 * (size_t)info->ir_length);
+}
+
+// Block floating point: each block's peak maps to +-32767
+static unsigned char* pack_ir(unsigned char* p, const double* ir, int length) {
+    for (int start = 0; start < length; start += IR_CACHE_PACK_BLOCK) {
+        int count = length - start < IR_CACHE_PACK_BLOCK ? length - start : IR_CACHE_PACK_BLOCK;
+        double peak = 0.0;
+        for (int i = 0; i < count; i++) {
+            if (fabs(ir[start + i]) > peak) peak = fabs(ir[start + i]);
+        }
+        float scale = (float)(peak / 32767.0);
+        put_f32(p, scale);
+        p += 4;
+
+        for (int i = 0; i < count; i++, p += 2) {
+            long q = scale > 0.0f ? lrint(ir[start + i] / scale) : 0;
+            if (q > 32767) q = 32767;
+            if (q < -32767) q = -32767;
+            uint16_t bits = (uint16_t)(int16_t)q;
+            p[0] = (unsigned char)bits;
+            p[1] = (unsigned char)(bits >> 8);
+        }
+    }
+    return p;
+}
+
+static void unpack_ir(const unsigned char* p, double* ir, int length) {
+    for (int start = 0; start < length; start += IR_CACHE_PACK_BLOCK) {
+        int count = length - start < IR_CACHE_PACK_BLOCK ? length - start : IR_CACHE_PACK_BLOCK;
+        double scale = get_f32(p);
+        p += 4;
+
+        for (int i = 0; i < count; i++, p += 2) {
+            int16_t q = (int16_t)(p[0] | (p[1] << 8));
+            ir[start + i] = q * scale;
+        }
+    }
+}
+
+size_t ir_cache_bytes(const IRCacheInfo* info, const FFTConvolver* conv) {
+    return ir_section_bytes(info) + (conv ? fft_convolver_export(conv, NULL) : 0);
+}
+
+size_t ir_cache_serialize(IRCacheInfo* info, const double* kernel, const IRCacheTap* taps,
+                          const double* ir, const FFTConvolver* conv, unsigned char* out) {
+    info->spectra_offset = ir_section_bytes(info);
+    info->spectra_bytes = conv ? fft_convolver_export(conv, NULL) : 0;
+
+    memcpy(out, ir_cache_magic, 4);
+    out[4] = IR_CACHE_FORMAT_VERSION;
+    out[5] = (unsigned char)((info->layered ? 1 : 0) | (info->packed ? 2 : 0));
+    out[6] = (unsigned char)info->early_spread;
+    out[7] = 0;
+    put_u32(out + 8, info->key);
+    put_u32(out + 12, (uint32_t)info->sample_rate);
+    put_u32(out + 16, (uint32_t)info->ir_type);
+    put_u32(out + 20, (uint32_t)info->ir_length);
+    put_u32(out + 24, (uint32_t)info->effective_length);
+    put_u32(out + 28, (uint32_t)info->num_early_taps);
+    put_f64(out + 32, info->trim_db);
+    put_f64(out + 40, info->norm_factor);
+    put_f64(out + 48, info->early_gain);
+    put_f64(out + 56, info->wet_gain);
+    put_u32(out + 64, (uint32_t)info->spectra_bytes);
+    put_u32(out + 68, 0);
+
+    unsigned char* p = out + IR_CACHE_HEADER_BYTES;
+    for (int i = 0; i < 2 * info->early_spread + 1; i++, p += 8) {
+        put_f64(p, kernel[i]);
+    }
+    for (int i = 0; i < info->num_early_taps; i++, p += IR_CACHE_TAP_BYTES) {
+        put_u32(p, (uint32_t)taps[i].delay);
+        put_f64(p + 4, taps[i].gain);
+    }
+
+    // The IR only seeds rebuilds (another mix layer, trim or layout); single
+    // precision is far below the trim threshold
+    if (info->packed) {
+        p = pack_ir(p, ir, info->ir_length);
+    } else {
+        for (int i = 0; i < info->ir_length; i++, p += 4) {
+            put_f32(p, (float)ir[i]);
+        }
+    }
+
+    if (conv) {
+        fft_convolver_export(conv, p);
+    }
+    return info->spectra_offset + info->spectra_bytes;
+}
+
+int ir_cache_parse(const unsigned char* data, size_t size, IRCacheInfo* info) {
+    if (!data || size < IR_CACHE_HEADER_BYTES || memcmp(data, ir_cache_magic, 4) != 0 ||
+        data[4] != IR_CACHE_FORMAT_VERSION) {
+        return -1;
+    }
+
+    IRCacheInfo parsed;
+    parsed.layered = data[5] & 1;
+    parsed.packed = (data[5] >> 1) & 1;
+    parsed.early_spread = data[6];
+    parsed.key = get_u32(data + 8);
+    parsed.sample_rate = (int)get_u32(data + 12);
+    parsed.ir_type = (int)get_u32(data + 16);
+    parsed.ir_length = (int)get_u32(data + 20);
+    parsed.effective_length = (int)get_u32(data + 24);
+    parsed.num_early_taps = (int)get_u32(data + 28);
+    parsed.trim_db = get_f64(data + 32);
+    parsed.norm_factor = get_f64(data + 40);
+    parsed.early_gain = get_f64(data + 48);
+    parsed.wet_gain = get_f64(data + 56);
+    parsed.spectra_bytes = get_u32(data + 64);
+
+    if (parsed.ir_length <= 0 || parsed.effective_length <= 0 ||
+        parsed.effective_length > parsed.ir_length || parsed.num_early_taps < 0) {
+        return -1;
+    }
+    parsed.spectra_offset = ir_section_bytes(&parsed);
+    if (size < parsed.spectra_offset + parsed.spectra_bytes) {
+        return -1;
+    }
+
+    // Every tap's kernel must fit inside the IR, as the generator guarantees:
+    // the early path renders delay - spread .. delay + spread unchecked
+    const unsigned char* p = data + IR_CACHE_HEADER_BYTES + 8 * (size_t)(2 * parsed.early_spread + 1);
+    for (int i = 0; i < parsed.num_early_taps; i++, p += IR_CACHE_TAP_BYTES) {
+        int64_t delay = get_u32(p);
+        if (delay < parsed.early_spread || delay + parsed.early_spread >= parsed.ir_length) {
+            return -1;
+        }
+    }
+
+    *info = parsed;
+    return 0;
+}
+
+void ir_cache_read(const unsigned char* data, const IRCacheInfo* info, double* kernel,
+                   IRCacheTap* taps, double* ir) {
+    const unsigned char* p = data + IR_CACHE_HEADER_BYTES;
+    for (int i = 0; i < 2 * info->early_spread + 1; i++, p += 8) {
+        kernel[i] = get_f64(p);
+    }
+    for (int i = 0; i < info->num_early_taps; i++, p += IR_CACHE_TAP_BYTES) {
+        taps[i].delay = (int)get_u32(p);
+        taps[i].gain = get_f64(p + 4);
+    }
+    if (info->packed) {
+        unpack_ir(p, ir, info->ir_length);
+        return;
+    }
+    for (int i = 0; i < info->ir_length; i++, p += 4) {
+        ir[i] = get_f32(p);
+    }
+}
@@ -0,0 +1,79 @@
+// ir_cache.h
+// Precomputed IR blob: a generated IR, its early reflection taps and the FFT
+// convolver's partition spectra, keyed by a hash of the parameters that shaped
+// the IR. Restoring one skips both the synthesis and the partition FFTs
+
+#ifndef IR_CACHE_H
+#define IR_CACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "fft_convolver.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Blob layout: IR_CACHE_HEADER_BYTES of header, the early path's diffusion
+// kernel (doubles) and taps (delay, gain), the IR as floats (or packed), then
+// the convolver's fft_convolver_export bytes if there are any. Little-endian
+#define IR_CACHE_HEADER_BYTES 72
+#define IR_CACHE_TAP_BYTES    12
+
+// Packed IRs are stored in blocks of IR_CACHE_PACK_BLOCK taps: one float scale
+// and a 16-bit integer per tap (about -90 dB below the block's peak)
+#define IR_CACHE_PACK_BLOCK   64
+
+// FNV-1a offset basis: the start value for ir_cache_hash
+#define IR_CACHE_HASH_SEED    2166136261u
+
+typedef struct {
+    int delay;
+    double gain;
+} IRCacheTap;
+
+typedef struct {
+    uint32_t key;           // Hash of the parameters that shaped the IR
+    int sample_rate;
+    int ir_type;
+    int ir_length;
+    int effective_length;   // Trimmed at trim_db
+    double trim_db;
+    double norm_factor;     // Normalization the IR taps carry
+    double early_gain;      // Early path gain the spectra were built with
+    double wet_gain;        // Output gain the spectra need (a progressive
+                            // publish was scaled by the provisional level)
+    int layered;            // The spectra include the thickening layers
+    int early_spread;       // Kernel half-width: 2 * early_spread + 1 values
+    int num_early_taps;
+    int packed;             // IR stored as 16-bit blocks rather than floats
+    size_t spectra_bytes;   // 0: no spectra, the convolver is rebuilt from the IR
+    size_t spectra_offset;  // Where they start (set by ir_cache_serialize/parse)
+} IRCacheInfo;
+
+// FNV-1a over bytes, continuing from hash
+uint32_t ir_cache_hash(uint32_t hash, const void* data, size_t bytes);
+
+// Blob size for info plus conv's spectra (conv NULL: none)
+size_t ir_cache_bytes(const IRCacheInfo* info, const FFTConvolver* conv);
+
+// Write the blob into out (ir_cache_bytes long). Fills in the spectra fields
+// of info and returns the size
+size_t ir_cache_serialize(IRCacheInfo* info, const double* kernel, const IRCacheTap* taps,
+                          const double* ir, const FFTConvolver* conv, unsigned char* out);
+
+// Read the header of a blob from ir_cache_serialize. Returns 0, or -1 for
+// another format version or a truncated blob
+int ir_cache_parse(const unsigned char* data, size_t size, IRCacheInfo* info);
+
+// Kernel, taps and IR of a parsed blob; the spectra are at
+// data + info->spectra_offset for fft_convolver_import
+void ir_cache_read(const unsigned char* data, const IRCacheInfo* info, double* kernel,
+                   IRCacheTap* taps, double* ir);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IR_CACHE_H
@@ -0,0 +1,146 @@
+// modal_bank.c
+// Damped complex resonators, updated MODAL_LANES modes at a time
+
+#include <math.h>
+#include <string.h>
+
+#include "modal_bank.h"
+#include "denormal.h"
+
+#define MODAL_PI 3.14159265358979323846
+
+// Samples per inner pass; the delayed input and the mode sum stay on the stack
+#define MODAL_CHUNK 256
+
+// Resonator state below this (~-600 dB) is flushed before it can go subnormal
+#define MODAL_DENORMAL_FLOOR 1e-30
+
+void modal_bank_begin(ModalBank* bank, int num_modes, int predelay_samples) {
+    if (num_modes > MODAL_MAX_MODES) num_modes = MODAL_MAX_MODES;
+    if (predelay_samples > MODAL_MAX_PREDELAY) predelay_samples = MODAL_MAX_PREDELAY;
+    if (predelay_samples < 0) predelay_samples = 0;
+
+    // Round up to whole lane groups; the padding modes stay silent
+    bank->num_modes = (num_modes + MODAL_LANES - 1) / MODAL_LANES * MODAL_LANES;
+    memset(bank->pole_re, 0, sizeof(bank->pole_re));
+    memset(bank->pole_im, 0, sizeof(bank->pole_im));
+    memset(bank->gain, 0, sizeof(bank->gain));
+    bank->slowest_decay = 0.0;
+
+    if (predelay_samples != bank->predelay_length) {
+        memset(bank->predelay, 0, sizeof(bank->predelay));
+        bank->predelay_length = predelay_samples;
+        bank->predelay_pos = 0;
+    }
+}
+
+void modal_bank_set_mode(ModalBank* bank, int k, double freq_hz, double decay_rate,
+                         double gain, int sample_rate) {
+    if (k < 0 || k >= bank->num_modes) return;
+
+    if (freq_hz <= 0.0 || freq_hz >= 0.5 * sample_rate) {
+        bank->pole_re[k] = bank->pole_im[k] = bank->gain[k] = 0.0;
+        return;
+    }
+
+    double radius = exp(-decay_rate / sample_rate);
+    double omega = 2.0 * MODAL_PI * freq_hz / sample_rate;
+    bank->pole_re[k] = radius * cos(omega);
+    bank->pole_im[k] = radius * sin(omega);
+    bank->gain[k] = gain;
+
+    if (gain != 0.0 && (bank->slowest_decay == 0.0 || decay_rate < bank->slowest_decay)) {
+        bank->slowest_decay = decay_rate;
+    }
+}
+
+// Sum of (g r^n cos(wn))^2 over n per mode; distinct modes are treated as uncorrelated
+double modal_bank_energy(const ModalBank* bank) {
+    double energy = 0.0;
+    for (int k = 0; k < bank->num_modes; k++) {
+        double r2 = bank->pole_re[k] * bank->pole_re[k] + bank->pole_im[k] * bank->pole_im[k];
+        if (bank->gain[k] == 0.0 || r2 >= 1.0) continue;
+
+        // Re(1 / (1 - pole^2)) is the cos(2wn) part
+        double p2_re = bank->pole_re[k] * bank->pole_re[k] - bank->pole_im[k] * bank->pole_im[k];
+        double p2_im = 2.0 * bank->pole_re[k] * bank->pole_im[k];
+        double d_re = 1.0 - p2_re;
+        double oscillating = d_re / (d_re * d_re + p2_im * p2_im);
+
+        energy += bank->gain[k] * bank->gain[k] * 0.5 * (1.0 / (1.0 - r2) + oscillating);
+    }
+    return energy;
+}
+
+void modal_bank_scale(ModalBank* bank, double factor) {
+    for (int k = 0; k < bank->num_modes; k++) {
+        bank->gain[k] *= factor;
+    }
+}
+
+void modal_bank_reset(ModalBank* bank) {
+    memset(bank->state_re, 0, sizeof(bank->state_re));
+    memset(bank->state_im, 0, sizeof(bank->state_im));
+    memset(bank->predelay, 0, sizeof(bank->predelay));
+    bank->predelay_pos = 0;
+}
+
+void modal_bank_process(ModalBank* bank, const conv_sample_t* in, conv_sample_t* out, int n) {
+    double x[MODAL_CHUNK];
+    double sum[MODAL_CHUNK][MODAL_LANES];   // Per-lane partial sums, added up once per chunk
+
+    for (int offset = 0; offset < n; offset += MODAL_CHUNK) {
+        int count = n - offset < MODAL_CHUNK ? n - offset : MODAL_CHUNK;
+
+        if (bank->predelay_length > 0) {
+            for (int i = 0; i < count; i++) {
+                x[i] = bank->predelay[bank->predelay_pos];
+                bank->predelay[bank->predelay_pos] = in[offset + i];
+                if (++bank->predelay_pos == bank->predelay_length) bank->predelay_pos = 0;
+            }
+        } else {
+            for (int i = 0; i < count; i++) {
+                x[i] = in[offset + i];
+            }
+        }
+        memset(sum, 0, count * sizeof(sum[0]));
+
+        // One lane group at a time: its state lives in registers for the whole
+        // chunk and no lane depends on another, so each step is one vector op
+        for (int k = 0; k < bank->num_modes; k += MODAL_LANES) {
+            double re[MODAL_LANES], im[MODAL_LANES];
+            double pr[MODAL_LANES], pi[MODAL_LANES], g[MODAL_LANES];
+            for (int j = 0; j < MODAL_LANES; j++) {
+                re[j] = bank->state_re[k + j];
+                im[j] = bank->state_im[k + j];
+                pr[j] = bank->pole_re[k + j];
+                pi[j] = bank->pole_im[k + j];
+                g[j] = bank->gain[k + j];
+            }
+
+            for (int i = 0; i < count; i++) {
+                for (int j = 0; j < MODAL_LANES; j++) {
+                    double next_re = pr[j] * re[j] - pi[j] * im[j] + x[i];
+                    double next_im = pi[j] * re[j] + pr[j] * im[j];
+                    re[j] = next_re;
+                    im[j] = next_im;
+                    sum[i][j] += g[j] * next_re;
+                }
+            }
+
+            for (int j = 0; j < MODAL_LANES; j++) {
+                int silent = DENORMAL_PROTECTION && fabs(re[j]) + fabs(im[j]) < MODAL_DENORMAL_FLOOR;
+                bank->state_re[k + j] = silent ? 0.0 : re[j];
+                bank->state_im[k + j] = silent ? 0.0 : im[j];
+            }
+        }
+
+        for (int i = 0; i < count; i++) {
+            double total = 0.0;
+            for (int j = 0; j < MODAL_LANES; j++) {
+                total += sum[i][j];
+            }
+            out[offset + i] += (conv_sample_t)total;
+        }
+    }
+}
@@ -0,0 +1,67 @@
+// modal_bank.h
+// Bank of damped complex resonators rendering a reverb directly from its
+// mode frequencies and decay rates - no IR, no FFT
+
+#ifndef MODAL_BANK_H
+#define MODAL_BANK_H
+
+#include "sample_type.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MODAL_MAX_MODES     256
+
+// Modes are updated in groups of MODAL_LANES independent recursions per
+// sample, which the compiler maps onto SIMD lanes (-msimd128 in WebAssembly)
+#define MODAL_LANES         4
+
+// Longest input delay: 100 ms at 192 kHz
+#define MODAL_MAX_PREDELAY  19200
+
+// Mode k rings as gain[k] * Re(y[n]) with y[n] = pole[k] * y[n-1] + x[n],
+// pole = exp(-sigma / fs) * e^(j * 2 * pi * f / fs). Coefficients can be
+// changed between process calls without touching the resonator state, so
+// a retuned bank keeps ringing. Arrays are structure-of-arrays and padded to
+// a multiple of MODAL_LANES with silent modes.
+typedef struct {
+    int num_modes;
+    double pole_re[MODAL_MAX_MODES];
+    double pole_im[MODAL_MAX_MODES];
+    double gain[MODAL_MAX_MODES];
+    double state_re[MODAL_MAX_MODES];
+    double state_im[MODAL_MAX_MODES];
+    double slowest_decay;   // Smallest sigma of any sounding mode (1/s)
+
+    conv_sample_t predelay[MODAL_MAX_PREDELAY];
+    int predelay_length;    // 0: no input delay
+    int predelay_pos;
+} ModalBank;
+
+// Start a new layout of num_modes (<= MODAL_MAX_MODES) silent modes; the
+// resonator state is kept
+void modal_bank_begin(ModalBank* bank, int num_modes, int predelay_samples);
+
+// Mode k at freq_hz decaying as exp(-decay_rate * t), weighted by gain.
+// Modes at or above Nyquist stay silent
+void modal_bank_set_mode(ModalBank* bank, int k, double freq_hz, double decay_rate,
+                         double gain, int sample_rate);
+
+// Energy of the bank's impulse response
+double modal_bank_energy(const ModalBank* bank);
+
+// Scale every mode's gain
+void modal_bank_scale(ModalBank* bank, double factor);
+
+// Silence every resonator and the input delay
+void modal_bank_reset(ModalBank* bank);
+
+// out[i] += (modes * in)[i]
+void modal_bank_process(ModalBank* bank, const conv_sample_t* in, conv_sample_t* out, int n);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MODAL_BANK_H
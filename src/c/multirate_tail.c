@@ -0,0 +1,316 @@
+// multirate_tail.c
+// Decimate, convolve the late segment at the low rate, interpolate back
+
+#include <math.h>
+#include <string.h>
+
+#include "multirate_tail.h"
+
+#define HALFBAND_TAPS   MULTIRATE_HALFBAND_TAPS
+#define HALFBAND_PAIRS  MULTIRATE_HALFBAND_PAIRS
+#define HALFBAND_CENTRE (2 * HALFBAND_PAIRS - 1)
+
+// Kaiser window shape for the half-band design
+#define HALFBAND_KAISER_BETA 7.0
+
+#define MULTIRATE_PI 3.14159265358979323846
+
+// Group delay of the decimation chain in full-rate samples; the interpolation
+// chain mirrors it
+static int chain_delay(int factor) {
+    return HALFBAND_CENTRE * (factor - 1);
+}
+
+// The IR is advanced by the input's round trip through both chains plus the
+// delay of decimating the IR itself, less the factor - 1 samples the carried
+// over output adds back
+static int ir_advance(int factor) {
+    return 3 * chain_delay(factor) - (factor - 1);
+}
+
+// Decimator input needed for an IR of ir_length taps, flush included
+static int decimator_input_length(int factor, int ir_length) {
+    return ir_length - ir_advance(factor) + chain_delay(factor) + factor;
+}
+
+static int low_ir_length(int factor, int ir_length) {
+    return decimator_input_length(factor, ir_length) / factor + 1;
+}
+
+int multirate_tail_min_start(int factor) {
+    return ir_advance(factor) + factor * (2 * MULTIRATE_MIN_BLOCK + 1);
+}
+
+double multirate_tail_fade(int i, int fade) {
+    if (i >= fade) return 1.0;
+    return 0.5 - 0.5 * cos(MULTIRATE_PI * (i + 0.5) / fade);
+}
+
+size_t multirate_tail_bytes(int factor, int ir_length, int max_block, int num_threads) {
+    int low_length = low_ir_length(factor, ir_length);
+
+    // The block depends on where the segment starts - reserve for the largest stage
+    size_t stage = 0;
+    for (int L = MULTIRATE_MIN_BLOCK; L <= MULTIRATE_MAX_BLOCK; L <<= 1) {
+        size_t bytes = tail_stage_bytes(L, low_length, num_threads);
+        if (bytes > stage) stage = bytes;
+    }
+
+    return 2 * MULTIRATE_MAX_STAGES * ARENA_BYTES(2 * HALFBAND_TAPS, conv_sample_t)
+         + 2 * ARENA_BYTES(max_block / factor + 2, conv_sample_t)   // low_in + low_out
+         + ARENA_BYTES(max_block / 2 + 2, conv_sample_t)            // mid
+         + ARENA_BYTES(max_block + 2 * factor, conv_sample_t)       // pending
+         + ARENA_BYTES(low_length, double)                          // low-rate IR
+         + stage;
+}
+
+static double bessel_i0(double x) {
+    double sum = 1.0;
+    double term = 1.0;
+    for (int k = 1; k < 50; k++) {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+        if (term < sum * 1e-17) break;
+    }
+    return sum;
+}
+
+// Kaiser-windowed sinc with its cutoff at a quarter of the input rate. Taps
+// an even distance from the centre vanish; the pairs are normalized so the
+// DC gain is exactly one
+static void design_halfband(conv_sample_t* coeffs) {
+    double taps[HALFBAND_PAIRS];
+    double sum = 0.0;
+
+    for (int m = 0; m < HALFBAND_PAIRS; m++) {
+        int n = 2 * m;
+        double offset = n - HALFBAND_CENTRE;
+        double x = MULTIRATE_PI * offset / 2.0;
+        double r = 2.0 * n / (HALFBAND_TAPS - 1) - 1.0;
+        double window = bessel_i0(HALFBAND_KAISER_BETA * sqrt(1.0 - r * r)) /
+                        bessel_i0(HALFBAND_KAISER_BETA);
+        taps[m] = 0.5 * sin(x) / x * window;
+        sum += taps[m];
+    }
+
+    for (int m = 0; m < HALFBAND_PAIRS; m++) {
+        coeffs[m] = (conv_sample_t)(taps[m] * 0.25 / sum);
+    }
+}
+
+// Append x; returns the newest HALFBAND_TAPS samples, oldest first
+static inline const conv_sample_t* halfband_push(HalfbandFilter* f, conv_sample_t x) {
+    f->history[f->pos] = x;
+    f->history[f->pos + HALFBAND_TAPS] = x;
+    const conv_sample_t* window = f->history + f->pos + 1;
+    f->pos = f->pos + 1 == HALFBAND_TAPS ? 0 : f->pos + 1;
+    return window;
+}
+
+// Filter and keep every second sample. Returns the output count
+static int halfband_decimate(const conv_sample_t* coeffs, HalfbandFilter* f,
+                             const conv_sample_t* in, int n, conv_sample_t* out) {
+    int count = 0;
+    for (int i = 0; i < n; i++) {
+        const conv_sample_t* w = halfband_push(f, in[i]);
+        f->phase ^= 1;
+        if (f->phase) continue;
+
+        double y = 0.5 * w[HALFBAND_CENTRE];
+        for (int m = 0; m < HALFBAND_PAIRS; m++) {
+            y += coeffs[m] * (w[2 * m] + w[HALFBAND_TAPS - 1 - 2 * m]);
+        }
+        out[count++] = (conv_sample_t)y;
+    }
+    return count;
+}
+
+// Two output samples per input: one filtered phase, one plain delayed copy
+// (the centre tap, doubled). Returns the output count
+static int halfband_interpolate(const conv_sample_t* coeffs, HalfbandFilter* f,
+                                const conv_sample_t* in, int n, conv_sample_t* out) {
+    for (int i = 0; i < n; i++) {
+        const conv_sample_t* v = halfband_push(f, in[i]) + HALFBAND_TAPS - 2 * HALFBAND_PAIRS;
+
+        double y = 0.0;
+        for (int m = 0; m < HALFBAND_PAIRS; m++) {
+            y += coeffs[m] * (v[m] + v[2 * HALFBAND_PAIRS - 1 - m]);
+        }
+        out[2 * i] = (conv_sample_t)(2.0 * y);
+        out[2 * i + 1] = v[HALFBAND_PAIRS];
+    }
+    return 2 * n;
+}
+
+static int decimate(MultirateTail* mt, const conv_sample_t* in, int n, conv_sample_t* low) {
+    if (mt->num_stages == 1) {
+        return halfband_decimate(mt->coeffs, &mt->down[0], in, n, low);
+    }
+    int count = halfband_decimate(mt->coeffs, &mt->down[0], in, n, mt->mid);
+    return halfband_decimate(mt->coeffs, &mt->down[1], mt->mid, count, low);
+}
+
+static int interpolate(MultirateTail* mt, const conv_sample_t* low, int n, conv_sample_t* out) {
+    if (mt->num_stages == 1) {
+        return halfband_interpolate(mt->coeffs, &mt->up[0], low, n, out);
+    }
+    int count = halfband_interpolate(mt->coeffs, &mt->up[1], low, n, mt->mid);
+    return halfband_interpolate(mt->coeffs, &mt->up[0], mt->mid, count, out);
+}
+
+static void reset_filters(MultirateTail* mt) {
+    for (int s = 0; s < mt->num_stages; s++) {
+        memset(mt->down[s].history, 0, 2 * HALFBAND_TAPS * sizeof(conv_sample_t));
+        memset(mt->up[s].history, 0, 2 * HALFBAND_TAPS * sizeof(conv_sample_t));
+        mt->down[s].pos = mt->down[s].phase = 0;
+        mt->up[s].pos = mt->up[s].phase = 0;
+    }
+
+    // The first low-rate sample is due factor - 1 samples into the stream
+    memset(mt->pending, 0, (mt->max_block + 2 * mt->factor) * sizeof(conv_sample_t));
+    mt->pending_count = mt->factor - 1;
+}
+
+// Tap j of the late segment: zero before start, faded in over fade taps
+static double late_tap(const double* ir, int ir_length, int start, int fade, int j) {
+    if (j < start || j >= ir_length) return 0.0;
+    return ir[j] * multirate_tail_fade(j - start, fade);
+}
+
+// Energy fraction of the late segment the chain cannot reproduce: interpolate
+// the low-rate IR back to full rate (one chain delay early) and compare it
+// with the segment
+static double measure_loss(MultirateTail* mt, const double* low_ir, int low_length,
+                           const double* ir, int ir_length, int start, int fade) {
+    int offset = chain_delay(mt->factor);
+    int chunk = mt->max_block / mt->factor;
+    double reference = 0.0;
+    double error = 0.0;
+    int t = 0;
+
+    for (int j = start; j < ir_length; j++) {
+        double h = late_tap(ir, ir_length, start, fade, j);
+        reference += h * h;
+    }
+    if (reference <= 0.0) return 0.0;
+
+    reset_filters(mt);
+    for (int k0 = 0; k0 < low_length; k0 += chunk) {
+        int n = low_length - k0 < chunk ? low_length - k0 : chunk;
+        for (int k = 0; k < n; k++) {
+            mt->low_out[k] = (conv_sample_t)(low_ir[k0 + k] / mt->factor);
+        }
+
+        int produced = interpolate(mt, mt->low_out, n, mt->pending);
+        for (int i = 0; i < produced; i++, t++) {
+            double e = mt->pending[i] - late_tap(ir, ir_length, start, fade, t + offset);
+            error += e * e;
+        }
+    }
+
+    return error / reference;
+}
+
+int multirate_tail_init(MultirateTail* mt, Arena* arena, int factor, const double* ir,
+                        int ir_length, int start, int fade, int max_block, int num_threads) {
+    memset(mt, 0, sizeof(MultirateTail));
+
+    if ((factor != 2 && factor != 4) || start < multirate_tail_min_start(factor) ||
+        start >= ir_length) {
+        return -1;
+    }
+
+    mt->factor = factor;
+    mt->num_stages = factor == 4 ? 2 : 1;
+    mt->max_block = max_block;
+    design_halfband(mt->coeffs);
+
+    int ok = 1;
+    for (int s = 0; s < mt->num_stages; s++) {
+        mt->down[s].history = (conv_sample_t*)arena_alloc(arena, 2 * HALFBAND_TAPS * sizeof(conv_sample_t));
+        mt->up[s].history = (conv_sample_t*)arena_alloc(arena, 2 * HALFBAND_TAPS * sizeof(conv_sample_t));
+        ok = ok && mt->down[s].history && mt->up[s].history;
+    }
+    mt->low_in = (conv_sample_t*)arena_alloc(arena, (max_block / factor + 2) * sizeof(conv_sample_t));
+    mt->low_out = (conv_sample_t*)arena_alloc(arena, (max_block / factor + 2) * sizeof(conv_sample_t));
+    mt->mid = (conv_sample_t*)arena_alloc(arena, (max_block / 2 + 2) * sizeof(conv_sample_t));
+    mt->pending = (conv_sample_t*)arena_alloc(arena, (max_block + 2 * factor) * sizeof(conv_sample_t));
+
+    int low_capacity = low_ir_length(factor, ir_length);
+    double* low_ir = (double*)arena_alloc(arena, low_capacity * sizeof(double));
+
+    if (!ok || !mt->low_in || !mt->low_out || !mt->mid || !mt->pending || !low_ir) {
+        memset(mt, 0, sizeof(MultirateTail));
+        return -1;
+    }
+
+    // Band-limit and decimate the advanced segment with the input's own filters.
+    // A low-rate sum has 1/factor of the full-rate terms, hence the gain
+    int advance = ir_advance(factor);
+    int in_length = decimator_input_length(factor, ir_length);
+    int low_length = 0;
+
+    reset_filters(mt);
+    for (int t0 = 0; t0 < in_length; t0 += max_block) {
+        int n = in_length - t0 < max_block ? in_length - t0 : max_block;
+        for (int i = 0; i < n; i++) {
+            mt->pending[i] = (conv_sample_t)late_tap(ir, ir_length, start, fade, t0 + i + advance);
+        }
+
+        int count = decimate(mt, mt->pending, n, mt->low_in);
+        for (int k = 0; k < count && low_length < low_capacity; k++) {
+            low_ir[low_length++] = factor * (double)mt->low_in[k];
+        }
+    }
+
+    // The leading zeros cover the tail stage's two blocks of latency
+    int first = 0;
+    while (first < low_length && low_ir[first] == 0.0) first++;
+
+    int block = MULTIRATE_MAX_BLOCK;
+    while (block > MULTIRATE_MIN_BLOCK && 2 * block > first) block >>= 1;
+
+    if (2 * block > first || first == low_length ||
+        tail_stage_init(&mt->stage, arena, block, low_ir + 2 * block,
+                        low_length - 2 * block, num_threads) != 0) {
+        memset(mt, 0, sizeof(MultirateTail));
+        return -1;
+    }
+    mt->stage_ready = 1;
+
+    mt->loss = measure_loss(mt, low_ir, low_length, ir, ir_length, start, fade);
+    multirate_tail_reset(mt);
+    return 0;
+}
+
+void multirate_tail_destroy(MultirateTail* mt) {
+    if (mt->stage_ready) {
+        tail_stage_destroy(&mt->stage);
+        mt->stage_ready = 0;
+    }
+}
+
+void multirate_tail_reset(MultirateTail* mt) {
+    reset_filters(mt);
+    if (mt->stage_ready) {
+        tail_stage_reset(&mt->stage);
+    }
+}
+
+void multirate_tail_process(MultirateTail* mt, const conv_sample_t* in, conv_sample_t* out, int n) {
+    int count = decimate(mt, in, n, mt->low_in);
+
+    memset(mt->low_out, 0, count * sizeof(conv_sample_t));
+    tail_stage_process(&mt->stage, mt->low_in, mt->low_out, count);
+
+    // Everything up to the newest decimated sample is interpolated; fewer than
+    // factor samples are left over for the next call
+    int available = mt->pending_count +
+                    interpolate(mt, mt->low_out, count, mt->pending + mt->pending_count);
+    for (int i = 0; i < n; i++) {
+        out[i] += mt->pending[i];
+    }
+
+    mt->pending_count = available - n;
+    memmove(mt->pending, mt->pending + n, mt->pending_count * sizeof(conv_sample_t));
+}
@@ -0,0 +1,92 @@
+// multirate_tail.h
+// Late IR segment convolved at 1/2 or 1/4 of the sample rate, behind polyphase
+// half-band decimation and interpolation
+
+#ifndef MULTIRATE_TAIL_H
+#define MULTIRATE_TAIL_H
+
+#include "tail_stage.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Half-band FIR: 4K - 1 taps, of which only the centre and K symmetric pairs
+// are non-zero. K = 12 gives ~75 dB of stopband with the passband reaching
+// 0.2 of the input rate (9.6 kHz at 48 kHz for the first stage)
+#define MULTIRATE_HALFBAND_PAIRS 12
+#define MULTIRATE_HALFBAND_TAPS  (4 * MULTIRATE_HALFBAND_PAIRS - 1)
+
+// Half-band stages per direction for the lowest rate (1/4)
+#define MULTIRATE_MAX_STAGES     2
+
+// Low-rate partition sizes. The low-rate convolution has a block of latency,
+// which the late segment's start has to cover
+#define MULTIRATE_MIN_BLOCK      32
+#define MULTIRATE_MAX_BLOCK      1024
+
+// One half-band filter's input history; every sample is written twice so the
+// newest TAPS samples are always contiguous
+typedef struct {
+    conv_sample_t* history;     // 2 * MULTIRATE_HALFBAND_TAPS
+    int pos;                    // Slot the next sample goes to
+    int phase;                  // Decimator: an output is due on the next sample
+} HalfbandFilter;
+
+// x -> decimate by factor -> low-rate tail stage -> interpolate -> += out.
+// The IR is handed over at full rate; it is advanced by the filter delays,
+// band-limited and decimated by the same filters that process the input, so
+// the chain reproduces the late segment below the low-rate band edge with no
+// added latency. Interpolated samples that belong to the next call (fewer
+// than factor) are carried over.
+typedef struct {
+    int factor;                 // 2 or 4
+    int num_stages;             // log2(factor)
+    int max_block;              // Largest n one process call may pass
+    conv_sample_t coeffs[MULTIRATE_HALFBAND_PAIRS];  // Taps of the pairs, outermost first
+
+    HalfbandFilter down[MULTIRATE_MAX_STAGES];  // Stage s: rate / 2^s -> rate / 2^(s+1)
+    HalfbandFilter up[MULTIRATE_MAX_STAGES];    // Stage s: rate / 2^(s+1) -> rate / 2^s
+
+    TailStage stage;            // Low-rate partitions
+    int stage_ready;
+
+    conv_sample_t* low_in;      // Decimated input of one call
+    conv_sample_t* low_out;     // Its low-rate convolution
+    conv_sample_t* mid;         // Half-rate scratch between the two stages
+    conv_sample_t* pending;     // Interpolated output not played yet
+    int pending_count;
+
+    double loss;                // Late-segment energy the band limit removes (fraction)
+} MultirateTail;
+
+// Earliest IR tap the late segment may start at for factor
+int multirate_tail_min_start(int factor);
+
+// Fade-in gain of tap i of the fade-long crossfade at the start of the late
+// segment; the full-rate part takes 1 - gain
+double multirate_tail_fade(int i, int fade);
+
+// Arena bytes multirate_tail_init needs for any start
+size_t multirate_tail_bytes(int factor, int ir_length, int max_block, int num_threads);
+
+// Convolve taps [start, ir_length) of ir, the first fade of them faded in,
+// at 1/factor rate. num_threads is passed on to the low-rate tail stage.
+// Returns 0 on success, -1 if the arena is too small or start is too early
+int  multirate_tail_init(MultirateTail* mt, Arena* arena, int factor, const double* ir,
+                         int ir_length, int start, int fade, int max_block, int num_threads);
+
+// Stop the tail stage's worker threads. Must be called before the arena memory is reused
+void multirate_tail_destroy(MultirateTail* mt);
+
+// Forget all input history; the IR is kept
+void multirate_tail_reset(MultirateTail* mt);
+
+// out[i] += (late segment * in)[i], n <= max_block
+void multirate_tail_process(MultirateTail* mt, const conv_sample_t* in, conv_sample_t* out, int n);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MULTIRATE_TAIL_H
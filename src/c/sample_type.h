@@ -0,0 +1,19 @@
+// sample_type.h
+// Precision of the streamed convolution data (FFT buffers, spectra, delay line)
+
+#ifndef SAMPLE_TYPE_H
+#define SAMPLE_TYPE_H
+
+// Build with -DCONV_FLOAT32 for the float engine variant: partition spectra,
+// the frequency-domain delay line and the FFT work buffers become float - half
+// the memory traffic and twice the SIMD lanes. IR design, recursive filters
+// and the spectrum MAC accumulators stay double in both variants.
+#ifdef CONV_FLOAT32
+typedef float conv_sample_t;
+#define CONV_PRECISION_NAME "float32"
+#else
+typedef double conv_sample_t;
+#define CONV_PRECISION_NAME "float64"
+#endif
+
+#endif // SAMPLE_TYPE_H
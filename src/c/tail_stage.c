@@ -0,0 +1,513 @@
+// tail_stage.c
+// Large-partition tail stage: one block of slack per job, joined when due
+
+#include <limits.h>
+#include <math.h>
+#include <string.h>
+
+#include "tail_stage.h"
+#include "fft_convolver.h"
+#include "denormal.h"
+
+static int stage_partition_count(int block_size, int ir_length) {
+    return (ir_length + block_size - 1) / block_size;
+}
+
+static int stage_group_count(int num_partitions, int num_threads) {
+#ifdef CONV_THREADS
+    int groups = num_threads;
+#else
+    int groups = 0;
+    (void)num_threads;
+#endif
+    if (groups > TAIL_STAGE_MAX_GROUPS) groups = TAIL_STAGE_MAX_GROUPS;
+    if (groups > num_partitions) groups = num_partitions;
+    return groups > 0 ? groups : 1;
+}
+
+size_t tail_stage_bytes(int block_size, int ir_length, int num_threads) {
+    size_t L = block_size;
+    size_t P = stage_partition_count(block_size, ir_length);
+    size_t bins = L + 1;
+    size_t groups = stage_group_count((int)P, num_threads);
+
+    size_t per_group = fft_plan_bytes(block_size * 2)
+                     + 2 * ARENA_BYTES(bins, double)           // accumulator
+                     + ARENA_BYTES(2 * L, conv_sample_t)       // scratch
+                     + ARENA_BYTES(L, conv_sample_t);          // out
+
+    return groups * per_group
+         + 4 * ARENA_BYTES(P * bins, conv_sample_t)            // IR spectra + delay line
+         + 2 * ARENA_BYTES(P, unsigned char)
+         + 2 * ARENA_BYTES(2 * L, conv_sample_t)               // input + job_input
+         + ARENA_BYTES(L, conv_sample_t);                      // output
+}
+
+// Relative cost of the job steps, measured in units of roughly one radix-2
+// pass over a 2L transform, so inline jobs can be paced by work rather than
+// by step count
+#define TAIL_COST_FFT_PASS      2
+#define TAIL_COST_FORWARD_PACK  4
+#define TAIL_COST_FORWARD_SPLIT 4
+#define TAIL_COST_INVERSE_PACK  7
+#define TAIL_COST_INVERSE_OUT   1
+#define TAIL_COST_MAC           3
+
+enum {
+    TAIL_JOB_FORWARD,   // Transform the new input window (group 0 only)
+    TAIL_JOB_MAC,       // Multiply-accumulate the group's partitions
+    TAIL_JOB_INVERSE,   // Transform the accumulator back
+    TAIL_JOB_DONE
+};
+
+static int forward_step_cost(const FFTPlan* plan, int step) {
+    if (step == 0) return TAIL_COST_FORWARD_PACK;
+    if (step == fft_step_count(plan) - 1) return TAIL_COST_FORWARD_SPLIT;
+    return TAIL_COST_FFT_PASS * fft_step_passes(plan, step);
+}
+
+static int inverse_step_cost(const FFTPlan* plan, int step) {
+    if (step == 0) return TAIL_COST_INVERSE_PACK;
+    if (step == fft_step_count(plan) - 1) return TAIL_COST_INVERSE_OUT;
+    return TAIL_COST_FFT_PASS * fft_step_passes(plan, step);
+}
+
+static int transform_cost(const FFTPlan* plan, int (*step_cost)(const FFTPlan*, int)) {
+    int cost = 0;
+    for (int step = 0; step < fft_step_count(plan); step++) {
+        cost += step_cost(plan, step);
+    }
+    return cost;
+}
+
+// Delay-line slot partition k reads, or -1 when the product is known to be zero
+static int partition_slot(const TailStage* stage, int k) {
+    if (!stage->ir_active[k]) return -1;
+
+    int slot = stage->job_fdl_pos - k;
+    if (slot < 0) slot += stage->num_partitions;
+    return stage->fdl_active[slot] ? slot : -1;
+}
+
+// Start the group's share of a new job. Returns its total cost
+static int group_begin(TailGroup* group) {
+    TailStage* stage = group->stage;
+    int cost = 0;
+
+    group->phase = TAIL_JOB_MAC;
+    group->step = group->first_partition;
+    group->contributed = 0;
+
+    // The first group also transforms the new input window (only partition 0
+    // needs it - the others read older delay-line slots)
+    if (group->first_partition == 0) {
+        stage->fdl_active[stage->job_fdl_pos] = (unsigned char)stage->job_active;
+        if (stage->job_active) {
+            group->phase = TAIL_JOB_FORWARD;
+            group->step = 0;
+            cost += transform_cost(&group->plan, forward_step_cost);
+        }
+    }
+
+    int last = group->first_partition + group->num_partitions;
+    int active = 0;
+    for (int k = group->first_partition; k < last; k++) {
+        if (partition_slot(stage, k) >= 0) active++;
+    }
+    if (active > 0) {
+        cost += active * TAIL_COST_MAC + transform_cost(&group->plan, inverse_step_cost);
+    }
+    return cost;
+}
+
+// Run the next step of the group's job. Returns the step's cost, 0 once the
+// group is done
+static int group_step(TailGroup* group) {
+    TailStage* stage = group->stage;
+    int L = stage->block_size;
+    int bins = stage->bins;
+    int cost;
+
+    switch (group->phase) {
+        case TAIL_JOB_FORWARD:
+            fft_forward_step(&group->plan, group->step, stage->job_input,
+                             stage->fdl_re + stage->job_fdl_pos * bins,
+                             stage->fdl_im + stage->job_fdl_pos * bins);
+            cost = forward_step_cost(&group->plan, group->step);
+            if (++group->step == fft_step_count(&group->plan)) {
+                group->phase = TAIL_JOB_MAC;
+                group->step = group->first_partition;
+            }
+            return cost;
+
+        case TAIL_JOB_MAC: {
+            int last = group->first_partition + group->num_partitions;
+            int k = group->step;
+            int slot = -1;
+            while (k < last && (slot = partition_slot(stage, k)) < 0) k++;
+
+            if (k == last) {
+                group->step = 0;
+                if (group->contributed) {
+                    group->phase = TAIL_JOB_INVERSE;
+                    return group_step(group);
+                }
+                memset(group->out, 0, L * sizeof(conv_sample_t));
+                group->phase = TAIL_JOB_DONE;
+                return 1;
+            }
+
+            if (!group->contributed) {
+                memset(group->acc_re, 0, bins * sizeof(double));
+                memset(group->acc_im, 0, bins * sizeof(double));
+                group->contributed = 1;
+            }
+
+            const conv_sample_t* xr = stage->fdl_re + slot * bins;
+            const conv_sample_t* xi = stage->fdl_im + slot * bins;
+            const conv_sample_t* hr = stage->ir_re + k * bins;
+            const conv_sample_t* hi = stage->ir_im + k * bins;
+
+            for (int b = 0; b < bins; b++) {
+                group->acc_re[b] += xr[b] * hr[b] - xi[b] * hi[b];
+                group->acc_im[b] += xr[b] * hi[b] + xi[b] * hr[b];
+            }
+
+            group->step = k + 1;
+            return TAIL_COST_MAC;
+        }
+
+        case TAIL_JOB_INVERSE:
+            fft_inverse_step(&group->plan, group->step, group->acc_re, group->acc_im,
+                             group->scratch);
+            cost = inverse_step_cost(&group->plan, group->step);
+            if (++group->step == fft_step_count(&group->plan)) {
+                memcpy(group->out, group->scratch + L, L * sizeof(conv_sample_t));
+                group->phase = TAIL_JOB_DONE;
+            }
+            return cost;
+
+        default:
+            return 0;
+    }
+}
+
+// Inline mode: run job steps until the cost done reaches target
+static void advance_job(TailStage* stage, long long target) {
+    while (stage->job_cost_done < target && stage->step_group < stage->num_groups) {
+        int cost = group_step(&stage->groups[stage->step_group]);
+        if (cost == 0) {
+            stage->step_group++;
+            continue;
+        }
+        stage->job_cost_done += cost;
+    }
+}
+
+#ifdef CONV_THREADS
+// The whole job for one group, in one go
+static void run_group(TailGroup* group) {
+    group_begin(group);
+    while (group_step(group) > 0) {
+    }
+}
+
+static void* group_thread(void* arg) {
+    TailGroup* group = (TailGroup*)arg;
+    TailStage* stage = group->stage;
+
+    // The FTZ/DAZ bits of the process thread do not carry over to this one
+    enable_denormal_flushing();
+
+    for (;;) {
+        pthread_mutex_lock(&stage->lock);
+        while (!stage->quit && stage->job_seq == group->seen_job) {
+            pthread_cond_wait(&stage->wake, &stage->lock);
+        }
+        int quit = stage->quit;
+        group->seen_job = stage->job_seq;
+        pthread_mutex_unlock(&stage->lock);
+
+        if (quit) break;
+
+        run_group(group);
+
+        pthread_mutex_lock(&stage->lock);
+        if (++stage->groups_done == stage->num_groups) {
+            pthread_cond_signal(&stage->done);
+        }
+        pthread_mutex_unlock(&stage->lock);
+    }
+    return NULL;
+}
+#endif
+
+static void dispatch_job(TailStage* stage) {
+#ifdef CONV_THREADS
+    if (stage->threaded) {
+        pthread_mutex_lock(&stage->lock);
+        stage->groups_done = 0;
+        stage->job_seq++;
+        pthread_cond_broadcast(&stage->wake);
+        pthread_mutex_unlock(&stage->lock);
+        stage->job_pending = 1;
+        return;
+    }
+#endif
+    // Inline: nothing runs here. The steps are spread over the process calls
+    // of the coming block (see tail_stage_process), so no single audio
+    // callback carries a whole 2L transform pair
+    stage->job_cost = 0;
+    for (int g = 0; g < stage->num_groups; g++) {
+        stage->job_cost += group_begin(&stage->groups[g]);
+    }
+    stage->step_group = 0;
+    stage->job_cost_done = 0;
+    stage->job_pending = 1;
+}
+
+// Wait for the outstanding job (normally long finished) and sum the group outputs
+static void join_job(TailStage* stage) {
+    int L = stage->block_size;
+
+    if (!stage->job_pending) {
+        memset(stage->output, 0, L * sizeof(conv_sample_t));
+        return;
+    }
+
+#ifdef CONV_THREADS
+    if (stage->threaded) {
+        pthread_mutex_lock(&stage->lock);
+        if (stage->groups_done < stage->num_groups) {
+            stage->deadline_misses++;
+            while (stage->groups_done < stage->num_groups) {
+                pthread_cond_wait(&stage->done, &stage->lock);
+            }
+        }
+        pthread_mutex_unlock(&stage->lock);
+    } else
+#endif
+    {
+        // Whatever the earlier process calls did not get to
+        advance_job(stage, LLONG_MAX);
+    }
+
+    memcpy(stage->output, stage->groups[0].out, L * sizeof(conv_sample_t));
+    for (int g = 1; g < stage->num_groups; g++) {
+        const conv_sample_t* out = stage->groups[g].out;
+        for (int i = 0; i < L; i++) {
+            stage->output[i] += out[i];
+        }
+    }
+    stage->job_pending = 0;
+}
+
+int tail_stage_init(TailStage* stage, Arena* arena, int block_size,
+                    const double* ir, int ir_length, int num_threads) {
+    memset(stage, 0, sizeof(TailStage));
+
+    int L = block_size;
+    int P = stage_partition_count(L, ir_length);
+    if (P <= 0) {
+        return -1;
+    }
+
+    stage->block_size = L;
+    stage->bins = L + 1;
+    stage->num_partitions = P;
+    stage->num_groups = stage_group_count(P, num_threads);
+
+    int spectrum_size = P * stage->bins;
+
+    stage->ir_re = (conv_sample_t*)arena_alloc(arena, spectrum_size * sizeof(conv_sample_t));
+    stage->ir_im = (conv_sample_t*)arena_alloc(arena, spectrum_size * sizeof(conv_sample_t));
+    stage->fdl_re = (conv_sample_t*)arena_alloc(arena, spectrum_size * sizeof(conv_sample_t));
+    stage->fdl_im = (conv_sample_t*)arena_alloc(arena, spectrum_size * sizeof(conv_sample_t));
+    stage->ir_active = (unsigned char*)arena_alloc(arena, P);
+    stage->fdl_active = (unsigned char*)arena_alloc(arena, P);
+    stage->input = (conv_sample_t*)arena_alloc(arena, 2 * L * sizeof(conv_sample_t));
+    stage->job_input = (conv_sample_t*)arena_alloc(arena, 2 * L * sizeof(conv_sample_t));
+    stage->output = (conv_sample_t*)arena_alloc(arena, L * sizeof(conv_sample_t));
+
+    if (!stage->ir_re || !stage->ir_im || !stage->fdl_re || !stage->fdl_im ||
+        !stage->ir_active || !stage->fdl_active || !stage->input ||
+        !stage->job_input || !stage->output) {
+        memset(stage, 0, sizeof(TailStage));
+        return -1;
+    }
+
+    // Contiguous, nearly equal partition ranges per group
+    for (int g = 0; g < stage->num_groups; g++) {
+        TailGroup* group = &stage->groups[g];
+        group->stage = stage;
+        group->first_partition = g * P / stage->num_groups;
+        group->num_partitions = (g + 1) * P / stage->num_groups - group->first_partition;
+
+        group->acc_re = (double*)arena_alloc(arena, stage->bins * sizeof(double));
+        group->acc_im = (double*)arena_alloc(arena, stage->bins * sizeof(double));
+        group->scratch = (conv_sample_t*)arena_alloc(arena, 2 * L * sizeof(conv_sample_t));
+        group->out = (conv_sample_t*)arena_alloc(arena, L * sizeof(conv_sample_t));
+
+        if (fft_plan_init(&group->plan, 2 * L, arena) != 0 ||
+            !group->acc_re || !group->acc_im || !group->scratch || !group->out) {
+            memset(stage, 0, sizeof(TailStage));
+            return -1;
+        }
+    }
+
+    double total_energy = 0.0;
+    for (int i = 0; i < ir_length; i++) {
+        total_energy += ir[i] * ir[i];
+    }
+    double floor_energy = total_energy * FFT_CONVOLVER_PARTITION_FLOOR;
+
+    // Partition spectra: segment k covers taps [k*L, (k+1)*L) of ir, zero-padded to 2L
+    conv_sample_t* scratch = stage->groups[0].scratch;
+    for (int k = 0; k < P; k++) {
+        int start = k * L;
+        int count = ir_length - start < L ? ir_length - start : L;
+
+        double energy = 0.0;
+        for (int i = 0; i < count; i++) {
+            energy += ir[start + i] * ir[start + i];
+        }
+        if (energy <= floor_energy) continue;
+
+        stage->ir_active[k] = 1;
+
+        memset(scratch, 0, 2 * L * sizeof(conv_sample_t));
+        for (int i = 0; i < count; i++) {
+            scratch[i] = (conv_sample_t)ir[start + i];
+        }
+        fft_real_forward(&stage->groups[0].plan, scratch,
+                         stage->ir_re + k * stage->bins, stage->ir_im + k * stage->bins);
+    }
+
+#ifdef CONV_THREADS
+    if (num_threads > 0) {
+        pthread_mutex_init(&stage->lock, NULL);
+        pthread_cond_init(&stage->wake, NULL);
+        pthread_cond_init(&stage->done, NULL);
+        stage->threaded = 1;
+
+        for (int g = 0; g < stage->num_groups; g++) {
+            TailGroup* group = &stage->groups[g];
+            group->thread_started =
+                pthread_create(&group->thread, NULL, group_thread, group) == 0;
+            if (!group->thread_started) {
+                // Run inline rather than with a partial pool
+                tail_stage_destroy(stage);
+                stage->threaded = 0;
+                break;
+            }
+        }
+    }
+#endif
+
+    return 0;
+}
+
+void tail_stage_destroy(TailStage* stage) {
+#ifdef CONV_THREADS
+    if (stage->threaded) {
+        pthread_mutex_lock(&stage->lock);
+        stage->quit = 1;
+        pthread_cond_broadcast(&stage->wake);
+        pthread_mutex_unlock(&stage->lock);
+
+        for (int g = 0; g < stage->num_groups; g++) {
+            if (stage->groups[g].thread_started) {
+                pthread_join(stage->groups[g].thread, NULL);
+                stage->groups[g].thread_started = 0;
+            }
+        }
+
+        pthread_cond_destroy(&stage->done);
+        pthread_cond_destroy(&stage->wake);
+        pthread_mutex_destroy(&stage->lock);
+        stage->threaded = 0;
+        stage->quit = 0;
+    }
+#endif
+    stage->job_pending = 0;
+}
+
+void tail_stage_reset(TailStage* stage) {
+    int L = stage->block_size;
+    int spectrum_size = stage->num_partitions * stage->bins;
+
+    // The running job writes into the delay line
+    join_job(stage);
+
+    memset(stage->input, 0, 2 * L * sizeof(conv_sample_t));
+    memset(stage->output, 0, L * sizeof(conv_sample_t));
+    memset(stage->fdl_re, 0, spectrum_size * sizeof(conv_sample_t));
+    memset(stage->fdl_im, 0, spectrum_size * sizeof(conv_sample_t));
+    memset(stage->fdl_active, 0, stage->num_partitions);
+    stage->fdl_pos = 0;
+    stage->pos = 0;
+    stage->block_active = 0;
+    stage->prev_block_active = 0;
+}
+
+// Block boundary: collect the job due now, hand the completed window to the next
+static void block_boundary(TailStage* stage) {
+    int L = stage->block_size;
+
+    join_job(stage);
+
+    memcpy(stage->job_input, stage->input, 2 * L * sizeof(conv_sample_t));
+    stage->job_active = stage->block_active || stage->prev_block_active;
+    stage->job_fdl_pos = stage->fdl_pos;
+    stage->fdl_pos = (stage->fdl_pos + 1) % stage->num_partitions;
+
+    // Skip the job entirely while input and tail are silent
+    int tail_live = stage->job_active;
+    for (int s = 0; s < stage->num_partitions && !tail_live; s++) {
+        tail_live = stage->fdl_active[s];
+    }
+    if (tail_live) {
+        dispatch_job(stage);
+    } else {
+        stage->fdl_active[stage->job_fdl_pos] = 0;
+    }
+
+    memcpy(stage->input, stage->input + L, L * sizeof(conv_sample_t));
+    stage->prev_block_active = stage->block_active;
+    stage->block_active = 0;
+    stage->pos = 0;
+}
+
+void tail_stage_process(TailStage* stage, const conv_sample_t* in, conv_sample_t* out, int n) {
+    int L = stage->block_size;
+    int done = 0;
+
+    while (done < n) {
+        int chunk = L - stage->pos;
+        if (chunk > n - done) chunk = n - done;
+
+        conv_sample_t* block = stage->input + L + stage->pos;
+        const conv_sample_t* tail = stage->output + stage->pos;
+
+        for (int i = 0; i < chunk; i++) {
+            conv_sample_t x = in[done + i];
+            double mag = fabs(x);
+            if (DENORMAL_PROTECTION && mag < FFT_CONVOLVER_DENORMAL_LEVEL) x = 0;
+            if (mag > FFT_CONVOLVER_SILENCE_LEVEL) stage->block_active = 1;
+            block[i] = x;
+
+            out[done + i] += tail[i];
+        }
+
+        stage->pos += chunk;
+        done += chunk;
+
+        if (stage->pos == L) {
+            block_boundary(stage);
+        } else if (stage->job_pending && !stage->threaded) {
+            // Keep the inline job's progress in step with the block, so the
+            // work per call stays near job_cost * n / L
+            advance_job(stage, stage->job_cost * stage->pos / L);
+        }
+    }
+}
@@ -0,0 +1,120 @@
+// tail_stage.h
+// Large-partition tail stage of a two-stage (non-uniform) convolver, with
+// the partition work optionally run on worker threads
+
+#ifndef TAIL_STAGE_H
+#define TAIL_STAGE_H
+
+#include "fft.h"
+
+#ifdef CONV_THREADS
+#include <pthread.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Most partition groups (and worker threads) one stage runs
+#define TAIL_STAGE_MAX_GROUPS 4
+
+struct TailStage;
+
+// A contiguous range of partitions with its own transform and accumulator,
+// so groups can run concurrently
+typedef struct {
+    struct TailStage* stage;
+    int first_partition;
+    int num_partitions;     // Partitions [first, first + num) of the stage
+    FFTPlan plan;           // Own plan - the work buffers are per group
+    double* acc_re;         // MAC accumulator, bins
+    double* acc_im;
+    conv_sample_t* scratch; // 2L inverse FFT output
+    conv_sample_t* out;     // L: this group's share of the next output block
+    int phase;              // Progress through the current job
+    int step;
+    int contributed;        // Accumulator holds at least one product
+#ifdef CONV_THREADS
+    pthread_t thread;
+    int thread_started;
+    unsigned seen_job;
+#endif
+} TailGroup;
+
+// Uniformly partitioned overlap-save convolution with block L of an IR that
+// starts 2L samples after the input (the caller convolves the first 2L taps
+// with a short-block convolver). The work for the input block completed at
+// one block boundary is only due at the next one, so it can run on worker
+// threads for a whole block period while the audio thread carries on; the
+// result is joined when it is due. Without worker threads the same job is cut
+// into FFT passes and per-partition MACs which run spread evenly over the
+// process calls of the following block, keeping the worst-case call close to
+// the average.
+typedef struct TailStage {
+    int block_size;         // Partition length L
+    int num_partitions;
+    int bins;               // L + 1 spectrum bins per partition
+
+    conv_sample_t* ir_re;   // Partition spectra, num_partitions * bins
+    conv_sample_t* ir_im;
+    unsigned char* ir_active;   // Per partition: 0 when it carries no energy
+
+    conv_sample_t* fdl_re;  // Input spectra ring (frequency-domain delay line)
+    conv_sample_t* fdl_im;
+    unsigned char* fdl_active;  // Per slot: 0 when the input window was silent
+    int fdl_pos;            // Slot the next input spectrum goes to
+
+    conv_sample_t* input;   // 2L: previous block followed by the block being filled
+    int pos;                // Write position inside the current block
+    int block_active;       // Current input block has signal so far
+    int prev_block_active;
+
+    conv_sample_t* job_input;   // 2L window the running job transforms
+    int job_active;         // That window had signal
+    int job_fdl_pos;        // Slot the running job writes
+    int job_pending;        // A job was dispatched and not joined yet
+    long long job_cost;     // Inline: estimated cost of the running job
+    long long job_cost_done;
+    int step_group;         // Inline: group the running job is stepping
+
+    conv_sample_t* output;  // L: tail output for the block being played
+
+    int num_groups;
+    TailGroup groups[TAIL_STAGE_MAX_GROUPS];
+    int threaded;           // Groups run on worker threads
+    long long deadline_misses;  // Joins that had to wait for a worker
+
+#ifdef CONV_THREADS
+    pthread_mutex_t lock;
+    pthread_cond_t wake;    // Workers: a new job was dispatched
+    pthread_cond_t done;    // Audio thread: all groups finished
+    unsigned job_seq;
+    int groups_done;
+    int quit;
+#endif
+} TailStage;
+
+// Arena bytes tail_stage_init needs
+size_t tail_stage_bytes(int block_size, int ir_length, int num_threads);
+
+// ir holds the taps from offset 2L on. num_threads worker threads are started
+// (one partition group each); 0, or a build without CONV_THREADS, runs one
+// group inline, spread over the process calls. Returns 0 on success, -1 if
+// the arena is too small
+int  tail_stage_init(TailStage* stage, Arena* arena, int block_size,
+                     const double* ir, int ir_length, int num_threads);
+
+// Stop the worker threads. Must be called before the arena memory is reused
+void tail_stage_destroy(TailStage* stage);
+
+// Forget all input history; the IR is kept
+void tail_stage_reset(TailStage* stage);
+
+// out[i] += (ir delayed by 2L * in)[i]
+void tail_stage_process(TailStage* stage, const conv_sample_t* in, conv_sample_t* out, int n);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TAIL_STAGE_H
@@ -0,0 +1,230 @@
+// velvet_tail.c
+// Build a velvet-noise stand-in for the late IR and convolve with it
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "multirate_tail.h"
+#include "velvet_tail.h"
+#include "denormal.h"
+
+// Tone filter state below this (~-600 dB) is flushed before it can go subnormal
+#define VELVET_DENORMAL_FLOOR 1e-30
+
+static inline double flush_denormal(double x) {
+    return DENORMAL_PROTECTION && fabs(x) < VELVET_DENORMAL_FLOOR ? 0.0 : x;
+}
+
+static inline double velvet_rand(uint32_t* state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return (double)*state / 4294967296.0;
+}
+
+static int max_taps(int sample_rate, double density, int ir_length, int start) {
+    double period = sample_rate / density;
+    return (int)((ir_length - start) / period) + 2;
+}
+
+size_t velvet_tail_bytes(int sample_rate, double density, int ir_length, int start, int segment) {
+    int segments = (ir_length - start + segment - 1) / segment;
+    return ARENA_BYTES(max_taps(sample_rate, density, ir_length, start), int) +
+           2 * ARENA_BYTES(segments + 1, int) +
+           ARENA_BYTES(segments, double) +
+           ARENA_BYTES(ir_length + 2 * VELVET_CHUNK, conv_sample_t);
+}
+
+int velvet_tail_init(VelvetTail* velvet, Arena* arena, int sample_rate, double density,
+                     const double* ir, int ir_length, int start, int fade, int segment,
+                     double lp_coeff, double hp_coeff, uint32_t seed) {
+    memset(velvet, 0, sizeof(VelvetTail));
+    if (density <= 0.0 || segment < 1 || start < 1 || start + fade >= ir_length) return -1;
+
+    int capacity = max_taps(sample_rate, density, ir_length, start);
+    int segments = (ir_length - start + segment - 1) / segment;
+
+    velvet->taps = (int*)arena_alloc(arena, capacity * sizeof(int));
+    velvet->seg_begin = (int*)arena_alloc(arena, (segments + 1) * sizeof(int));
+    velvet->seg_negative = (int*)arena_alloc(arena, (segments + 1) * sizeof(int));
+    velvet->seg_gain = (double*)arena_alloc(arena, segments * sizeof(double));
+    velvet->history_length = ir_length + VELVET_CHUNK;
+    velvet->history = (conv_sample_t*)arena_alloc(arena, (velvet->history_length + VELVET_CHUNK) *
+                                                          sizeof(conv_sample_t));
+    if (!velvet->taps || !velvet->seg_begin || !velvet->seg_negative || !velvet->seg_gain ||
+        !velvet->history) {
+        memset(velvet, 0, sizeof(VelvetTail));
+        return -1;
+    }
+    velvet->num_segments = segments;
+    velvet->start = start;
+    velvet->lp_coeff = lp_coeff;
+    velvet->hp_coeff = hp_coeff;
+
+    // One tap per grid period, in increasing delay; the sign rides on the
+    // delay until the segments are sorted
+    double period = sample_rate / density;
+    uint32_t state = seed ? seed : 1;
+    int count = 0;
+    for (int m = 0; count < capacity; m++) {
+        int delay = start + (int)((m + velvet_rand(&state)) * period);
+        int negative = velvet_rand(&state) < 0.5;
+        if (delay >= ir_length) break;
+        velvet->taps[count++] = negative ? -delay : delay;
+    }
+    velvet->num_taps = count;
+
+    // Segment gains: the IR's energy spread over the segment's taps, the
+    // first fade taps faded in as the convolved head fades out
+    double ir_energy = 0.0;
+    int k = 0;
+    for (int s = 0; s < segments; s++) {
+        int from = start + s * segment;
+        int to = from + segment < ir_length ? from + segment : ir_length;
+
+        double energy = 0.0;
+        for (int i = from; i < to; i++) {
+            double tap = ir[i];
+            if (i - start < fade) tap *= multirate_tail_fade(i - start, fade);
+            energy += tap * tap;
+        }
+        ir_energy += energy;
+
+        velvet->seg_begin[s] = k;
+        while (k < count && abs(velvet->taps[k]) < to) k++;
+        int taps = k - velvet->seg_begin[s];
+        velvet->seg_gain[s] = taps > 0 ? sqrt(energy / taps) : 0.0;
+    }
+    velvet->seg_begin[segments] = count;
+    if (ir_energy <= 0.0) {
+        memset(velvet, 0, sizeof(VelvetTail));
+        return -1;
+    }
+
+    // The envelope above is white-noise energy; the tone filter takes some of
+    // it away. Run the sparse response through the filter once and make up
+    // the difference
+    double lp = 0.0, hp = 0.0, out_energy = 0.0;
+    int s = 0;
+    k = 0;
+    for (int i = start; i < ir_length; i++) {
+        double x = 0.0;
+        if (k < count && abs(velvet->taps[k]) == i) {
+            while (velvet->seg_begin[s + 1] <= k) s++;
+            x = velvet->taps[k] < 0 ? -velvet->seg_gain[s] : velvet->seg_gain[s];
+            k++;
+        }
+        lp += (x - lp) * lp_coeff;
+        hp += (lp - hp) * hp_coeff;
+        out_energy += (lp - hp) * (lp - hp);
+    }
+    if (out_energy <= 0.0) {
+        memset(velvet, 0, sizeof(VelvetTail));
+        return -1;
+    }
+    double makeup = sqrt(ir_energy / out_energy);
+    for (s = 0; s < segments; s++) {
+        velvet->seg_gain[s] *= makeup;
+    }
+
+    // Positive taps first within each segment, then strip the signs
+    for (s = 0; s < segments; s++) {
+        int lo = velvet->seg_begin[s];
+        int hi = velvet->seg_begin[s + 1];
+        while (lo < hi) {
+            if (velvet->taps[lo] > 0) {
+                lo++;
+            } else {
+                int t = velvet->taps[--hi];
+                velvet->taps[hi] = velvet->taps[lo];
+                velvet->taps[lo] = t;
+            }
+        }
+        velvet->seg_negative[s] = lo;
+    }
+    for (k = 0; k < count; k++) {
+        velvet->taps[k] = abs(velvet->taps[k]);
+    }
+
+    velvet_tail_reset(velvet);
+    return 0;
+}
+
+void velvet_tail_reset(VelvetTail* velvet) {
+    memset(velvet->history, 0, (velvet->history_length + VELVET_CHUNK) * sizeof(conv_sample_t));
+    velvet->history_pos = 0;
+    velvet->lp_state = 0.0;
+    velvet->hp_state = 0.0;
+}
+
+// acc[i] += sum over taps of history[pos - tap + i] for count samples.
+// Contiguous runs rather than per-sample gathers, four taps per pass so the
+// sum is loaded and stored once for every four runs. The mirrored history
+// end means no run has to wrap
+static void accumulate_taps(conv_sample_t* acc, const conv_sample_t* history, int length,
+                            const int* taps, int num_taps, int pos, int count) {
+    const conv_sample_t* run[4];
+    int k = 0;
+    for (; k < num_taps; k++) {
+        int from = pos - taps[k];
+        run[k & 3] = history + (from < 0 ? from + length : from);
+        if ((k & 3) == 3) {
+            for (int i = 0; i < count; i++) {
+                acc[i] += (run[0][i] + run[1][i]) + (run[2][i] + run[3][i]);
+            }
+        }
+    }
+    for (int r = 0; r < (k & 3); r++) {
+        for (int i = 0; i < count; i++) {
+            acc[i] += run[r][i];
+        }
+    }
+}
+
+void velvet_tail_process(VelvetTail* velvet, const conv_sample_t* in, conv_sample_t* out, int n) {
+    conv_sample_t positive[VELVET_CHUNK];
+    conv_sample_t negative[VELVET_CHUNK];
+    double mix[VELVET_CHUNK];
+    int length = velvet->history_length;
+
+    for (int offset = 0; offset < n; offset += VELVET_CHUNK) {
+        int count = n - offset < VELVET_CHUNK ? n - offset : VELVET_CHUNK;
+        int pos = velvet->history_pos;
+
+        // The whole chunk goes in first: taps shorter than the chunk read it
+        for (int i = 0; i < count; i++) {
+            int w = pos + i < length ? pos + i : pos + i - length;
+            velvet->history[w] = in[offset + i];
+            if (w < VELVET_CHUNK) velvet->history[w + length] = in[offset + i];
+        }
+        memset(mix, 0, count * sizeof(double));
+
+        for (int s = 0; s < velvet->num_segments; s++) {
+            int begin = velvet->seg_begin[s];
+            int split = velvet->seg_negative[s];
+            int end = velvet->seg_begin[s + 1];
+            if (begin == end || velvet->seg_gain[s] == 0.0) continue;
+
+            memset(positive, 0, count * sizeof(conv_sample_t));
+            memset(negative, 0, count * sizeof(conv_sample_t));
+            accumulate_taps(positive, velvet->history, length, velvet->taps + begin, split - begin,
+                            pos, count);
+            accumulate_taps(negative, velvet->history, length, velvet->taps + split, end - split,
+                            pos, count);
+
+            double gain = velvet->seg_gain[s];
+            for (int i = 0; i < count; i++) {
+                mix[i] += gain * (positive[i] - negative[i]);
+            }
+        }
+
+        velvet->history_pos = pos + count < length ? pos + count : pos + count - length;
+
+        for (int i = 0; i < count; i++) {
+            velvet->lp_state = flush_denormal(velvet->lp_state + (mix[i] - velvet->lp_state) * velvet->lp_coeff);
+            velvet->hp_state = flush_denormal(velvet->hp_state + (velvet->lp_state - velvet->hp_state) * velvet->hp_coeff);
+            out[offset + i] += (conv_sample_t)(velvet->lp_state - velvet->hp_state);
+        }
+    }
+}
@@ -0,0 +1,66 @@
+// velvet_tail.h
+// Late IR replaced by velvet noise - sparse +-1 taps under a segment-wise
+// gain envelope - convolved with adds only
+
+#ifndef VELVET_TAIL_H
+#define VELVET_TAIL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "arena.h"
+#include "sample_type.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Output samples per pass over the taps; the segment sum and the output mix
+// stay on the stack
+#define VELVET_CHUNK 256
+
+// One tap per grid period of sample_rate / density samples, at a random
+// offset inside it with a random sign. Each segment lists its positive taps
+// before its negative ones, so a segment is one sum of input runs, one
+// difference and one multiply by its gain. Taps are input delays in samples.
+typedef struct {
+    int* taps;
+    int num_taps;
+    int* seg_begin;         // Segment s: taps [seg_begin[s], seg_begin[s + 1])
+    int* seg_negative;      // First negative tap of segment s
+    double* seg_gain;
+    int num_segments;
+    int start;              // Crossover tap: first delay covered
+
+    conv_sample_t* history; // Input ring, long enough for the last tap plus a chunk; its
+    int history_length;     // first VELVET_CHUNK samples are mirrored past the end
+    int history_pos;
+
+    double lp_coeff, hp_coeff;  // Output tone filter, as on the IR
+    double lp_state, hp_state;
+} VelvetTail;
+
+// Arena bytes velvet_tail_init needs for ir_length taps covered from tap start
+// in segments of segment samples
+size_t velvet_tail_bytes(int sample_rate, double density, int ir_length, int start, int segment);
+
+// Cover taps [start, ir_length) of ir with density taps per second, in
+// segments of segment samples whose gains follow the IR's energy (faded in
+// over the fade samples after start). lp_coeff/hp_coeff are the IR's one-pole
+// tone filter. Returns 0 on success, -1 if the arena is too small or the
+// segment holds no energy
+int  velvet_tail_init(VelvetTail* velvet, Arena* arena, int sample_rate, double density,
+                      const double* ir, int ir_length, int start, int fade, int segment,
+                      double lp_coeff, double hp_coeff, uint32_t seed);
+
+// Forget all input; the taps and envelope are kept
+void velvet_tail_reset(VelvetTail* velvet);
+
+// out[i] += (taps * in)[i]
+void velvet_tail_process(VelvetTail* velvet, const conv_sample_t* in, conv_sample_t* out, int n);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // VELVET_TAIL_H
@@ -5,26 +5,82 @@
 
 /* ---- prototypes of the internal (“underscore”) functions ---- */
 void init_convolution_engine_(int *sr);
+void init_engine_async_(int *sr);
+int  continue_init_(void);
+int  get_init_progress_(void);
 void process_convolution_(double *in, double *out, int *n);
+void process_convolution_f32_(float *in, float *out, int *n);
+float *get_input_buffer_(int *ch);
+float *get_output_buffer_(int *ch);
+int  get_io_buffer_frames_(void);
+void process_io_buffers_(int *n, int *channels);
 void set_param_float_(int *param_id, float *value);
 void set_ir_type_(char *str, int len);
 void cleanup_convolution_engine_(void);
 int  is_initialized_(void);
 int  get_sample_rate_(void);
+int  get_ir_length_(void);
+int  get_effective_ir_length_(void);
+int  get_tail_samples_(void);
+int  get_memory_usage_(void);
+int  calibrate_partitions_(int *host_block, int *force);
+unsigned char *get_wisdom_buffer_(void);
+int  get_wisdom_capacity_(void);
+int  save_wisdom_(void);
+int  load_wisdom_(int *size);
+unsigned int get_ir_cache_key_(void);
+unsigned char *get_ir_cache_buffer_(void);
+unsigned char *reserve_ir_cache_(int *bytes);
+int  save_ir_cache_(void);
+int  load_ir_cache_(int *size);
+float *get_ir_upload_buffer_(void);
+int  get_ir_upload_capacity_(void);
+int  begin_ir_samples_(int *frames, int *sample_rate, int *channels);
+int  append_ir_samples_(float *samples, int *frames);
+int  load_ir_samples_(float *samples, int *frames, int *sample_rate, int *channels);
 char *get_version_(void);
 
 /* ---- simple memory helpers expected by JS ---- */
 void *allocate_double_array(int n)      { return calloc(n, sizeof(double)); }
 void  free_double_array(void *p)        { free(p); }
+void *allocate_float_array(int n)       { return calloc(n, sizeof(float)); }
+void  free_float_array(void *p)         { free(p); }
 
 /* ---- public wrappers -------------------------------------------------- */
 void init_engine(int sr)                          { init_convolution_engine_(&sr);             }
+void init_engine_async(int sr)                    { init_engine_async_(&sr);                   }
+int  continue_init(void)                          { return continue_init_();                   }
+int  get_init_progress(void)                      { return get_init_progress_();               }
 void process_audio(double *in,double *out,int n)  { process_convolution_(in,out,&n);          }
+void process_audio_f32(float *in,float *out,int n) { process_convolution_f32_(in,out,&n);     }
+float *get_input_buffer(int ch)                   { return get_input_buffer_(&ch);             }
+float *get_output_buffer(int ch)                  { return get_output_buffer_(&ch);            }
+int  get_io_buffer_frames(void)                   { return get_io_buffer_frames_();            }
+void process_io_buffers(int n, int channels)      { process_io_buffers_(&n, &channels);        }
 void set_parameter(int id, float v)               { set_param_float_(&id, &v);                 }
 void set_ir_type(const char *s)                   { int len=strlen(s); set_ir_type_((char*)s,len); }
 void cleanup_engine(void)                         { cleanup_convolution_engine_();             }
 int  is_initialized(void)                         { return is_initialized_();                  }
 int  get_sample_rate(void)                        { return get_sample_rate_();                 }
+int  get_ir_length(void)                          { return get_ir_length_();                   }
+int  get_effective_ir_length(void)                { return get_effective_ir_length_();         }
+int  get_tail_samples(void)                       { return get_tail_samples_();                }
+int  get_memory_usage(void)                       { return get_memory_usage_();                }
+int  calibrate_partitions(int block, int force)   { return calibrate_partitions_(&block, &force); }
+unsigned char *get_wisdom_buffer(void)            { return get_wisdom_buffer_();               }
+int  get_wisdom_capacity(void)                    { return get_wisdom_capacity_();             }
+int  save_wisdom(void)                            { return save_wisdom_();                     }
+int  load_wisdom(int size)                        { return load_wisdom_(&size);                }
+unsigned int get_ir_cache_key(void)              { return get_ir_cache_key_();                }
+unsigned char *get_ir_cache_buffer(void)         { return get_ir_cache_buffer_();             }
+unsigned char *reserve_ir_cache(int bytes)       { return reserve_ir_cache_(&bytes);          }
+int  save_ir_cache(void)                         { return save_ir_cache_();                   }
+int  load_ir_cache(int size)                     { return load_ir_cache_(&size);              }
+float *get_ir_upload_buffer(void)                 { return get_ir_upload_buffer_();            }
+int  get_ir_upload_capacity(void)                 { return get_ir_upload_capacity_();          }
+int  begin_ir_samples(int frames, int sr, int ch) { return begin_ir_samples_(&frames, &sr, &ch); }
+int  append_ir_samples(float *p, int frames)      { return append_ir_samples_(p, &frames);     }
+int  load_ir_samples(float *p, int frames, int sr, int ch) { return load_ir_samples_(p, &frames, &sr, &ch); }
 const char *get_version(void)                     { return get_version_();                     }
 
 /* optional stub, exported to satisfy the old list */
@@ -8,9 +8,31 @@ extern "C" {
 // Initialize the convolution engine with given sample rate
 void init_engine(int sample_rate);
 
+// Asynchronous start-up: init_engine_async initializes without building the
+// first IR. Apply parameters, IR type, wisdom and any precomputed IR, then call
+// continue_init until it returns 100, yielding to the event loop in between -
+// each call does one bounded slice (arena layout, IR generation, partitions).
+// get_init_progress reports the same percentage without doing any work (-1
+// before init). Processing audio early falls back to on-demand generation
+void init_engine_async(int sample_rate);
+int continue_init(void);
+int get_init_progress(void);
+
 // Process audio chunk
 void process_audio(double* input, double* output, int num_samples);
 
+// Same processing on Float32 buffers, so Web Audio data is copied in and out
+// without a per-sample conversion in JavaScript
+void process_audio_f32(float* input, float* output, int num_samples);
+
+// Engine-owned Float32 I/O buffers with stable addresses (get_io_buffer_frames
+// samples per channel, 2 channels). Write the input buffers, call
+// process_io_buffers, read the output buffers - nothing is allocated per block.
+float* get_input_buffer(int channel);
+float* get_output_buffer(int channel);
+int get_io_buffer_frames(void);
+void process_io_buffers(int num_samples, int num_channels);
+
 // Set parameter value
 void set_parameter(int param_id, float value);
 
@@ -20,9 +42,65 @@ void set_ir_type(const char* ir_type);
 // Cleanup engine resources
 void cleanup_engine(void);
 
+// Generated IR length in samples, before and after energy-based trimming
+int get_ir_length(void);
+int get_effective_ir_length(void);
+
+// Output samples still to come from input already processed (0 once the
+// reverb tail has decayed and the engine has bypassed itself)
+int get_tail_samples(void);
+
+// Heap bytes held by the engine; buffers are sized to the current IR
+int get_memory_usage(void);
+
+// Benchmark the partition layouts on the current IR for calls of block_size
+// samples and keep the cheapest that meets the callback deadline. Skipped when
+// the wisdom already has an entry for this IR length and block size, unless
+// force is set. Returns the tail partition size (0: uniform), -1 without an IR.
+int calibrate_partitions(int block_size, int force);
+
+// Wisdom persistence through an engine-owned byte buffer: save_wisdom
+// serializes into it and returns the byte count; to restore, write a saved
+// blob (at most get_wisdom_capacity bytes) into it and call load_wisdom, which
+// returns the entry count or -1 for a blob from another engine variant.
+unsigned char* get_wisdom_buffer(void);
+int get_wisdom_capacity(void);
+int save_wisdom(void);
+int load_wisdom(int size);
+
+// Precomputed IRs: save_ir_cache serializes the generated IR, its early
+// reflections and (for the uniform layout) the partition spectra into an
+// engine-owned buffer at get_ir_cache_buffer and returns the byte count (-1
+// with a sampled IR loaded). To restore, reserve_ir_cache(bytes) returns
+// where to write a saved blob and load_ir_cache takes it: 0, or -1 when it
+// was made for other settings - it then stays staged, and the next IR those
+// settings generate (e.g. after set_ir_type) is taken from it instead.
+// get_ir_cache_key hashes the settings the current IR is generated from.
+unsigned int get_ir_cache_key(void);
+unsigned char* get_ir_cache_buffer(void);
+unsigned char* reserve_ir_cache(int bytes);
+int save_ir_cache(void);
+int load_ir_cache(int size);
+
+// Replace the generated IR with recorded samples: interleaved float frames of
+// any channel count (mixed to mono) at 8-384 kHz (resampled to the engine
+// rate). load_ir_samples takes the whole IR; for uploads in pieces, announce
+// it with begin_ir_samples, then write chunks of at most
+// get_ir_upload_capacity floats into get_ir_upload_buffer and call
+// append_ir_samples, which returns the IR taps ready (-1 without an upload).
+// The convolution starts on the first chunk. Selecting an IR type goes back
+// to generated IRs.
+float* get_ir_upload_buffer(void);
+int get_ir_upload_capacity(void);
+int begin_ir_samples(int frames, int sample_rate, int channels);
+int append_ir_samples(float* samples, int frames);
+int load_ir_samples(float* samples, int frames, int sample_rate, int channels);
+
 // Memory management helpers
 double* allocate_double_array(int size);
 void free_double_array(double* ptr);
+float* allocate_float_array(int size);
+void free_float_array(float* ptr);
 
 // Parameter IDs
 enum ConvolutionParams {
@@ -33,7 +111,14 @@ enum ConvolutionParams {
     PARAM_LOW_FREQ = 4,
     PARAM_DIFFUSION = 5,
     PARAM_MIX = 6,
-    PARAM_EARLY_REFLECTIONS = 7
+    PARAM_EARLY_REFLECTIONS = 7,
+    PARAM_IR_TRIM_THRESHOLD = 8,
+    PARAM_TAIL_THREADS = 9,
+    PARAM_HOST_BLOCK_SIZE = 10,
+    PARAM_LATE_TAIL_RATE = 11,
+    PARAM_FDN_CROSSOVER = 12,
+    PARAM_MODAL_ENGINE = 13,
+    PARAM_VELVET_DENSITY = 14
 };
 
 #ifdef __cplusplus
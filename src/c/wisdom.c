@@ -0,0 +1,117 @@
+// wisdom.c
+// Partition-layout table and its portable blob form
+
+#include <string.h>
+
+#include "wisdom.h"
+#include "sample_type.h"
+
+#define WISDOM_FORMAT_VERSION 1
+
+// Engine variant byte: the timings only hold for the variant that measured them
+#ifdef CONV_THREADS
+#define WISDOM_VARIANT_THREADS 0x10
+#else
+#define WISDOM_VARIANT_THREADS 0x00
+#endif
+#define WISDOM_VARIANT ((unsigned char)(sizeof(conv_sample_t) | WISDOM_VARIANT_THREADS))
+
+static const unsigned char wisdom_magic[4] = { 'C', 'R', 'W', 'S' };
+
+int wisdom_length_class(int ir_length) {
+    int length_class = 0;
+    while (length_class < 30 && (1 << length_class) < ir_length) length_class++;
+    return length_class;
+}
+
+const WisdomEntry* wisdom_find(const Wisdom* wisdom, int length_class, int host_block) {
+    for (int i = 0; i < wisdom->count; i++) {
+        const WisdomEntry* entry = &wisdom->entries[i];
+        if (entry->length_class == length_class && entry->host_block == host_block) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+void wisdom_store(Wisdom* wisdom, const WisdomEntry* entry) {
+    for (int i = 0; i < wisdom->count; i++) {
+        if (wisdom->entries[i].length_class == entry->length_class &&
+            wisdom->entries[i].host_block == entry->host_block) {
+            wisdom->entries[i] = *entry;
+            return;
+        }
+    }
+
+    if (wisdom->count == WISDOM_MAX_ENTRIES) {
+        memmove(wisdom->entries, wisdom->entries + 1,
+                (WISDOM_MAX_ENTRIES - 1) * sizeof(WisdomEntry));
+        wisdom->count--;
+    }
+    wisdom->entries[wisdom->count++] = *entry;
+}
+
+static void put_u16(unsigned char* p, int value) {
+    if (value < 0) value = 0;
+    if (value > 0xFFFF) value = 0xFFFF;
+    p[0] = (unsigned char)(value & 0xFF);
+    p[1] = (unsigned char)(value >> 8);
+}
+
+static int get_u16(const unsigned char* p) {
+    return p[0] | (p[1] << 8);
+}
+
+int wisdom_serialize(const Wisdom* wisdom, unsigned char* out) {
+    memcpy(out, wisdom_magic, 4);
+    out[4] = WISDOM_FORMAT_VERSION;
+    out[5] = WISDOM_VARIANT;
+    out[6] = (unsigned char)wisdom->count;
+    out[7] = 0;
+
+    unsigned char* p = out + WISDOM_HEADER_BYTES;
+    for (int i = 0; i < wisdom->count; i++, p += WISDOM_ENTRY_BYTES) {
+        const WisdomEntry* entry = &wisdom->entries[i];
+        p[0] = (unsigned char)entry->length_class;
+        p[1] = 0;
+        put_u16(p + 2, entry->host_block);
+        put_u16(p + 4, entry->tail_block);
+        put_u16(p + 6, (int)(entry->avg_us * 10.0f + 0.5f));    // 0.1 us units
+        put_u16(p + 8, (int)(entry->peak_us * 10.0f + 0.5f));
+    }
+    return (int)(p - out);
+}
+
+int wisdom_parse(Wisdom* wisdom, const unsigned char* data, int size) {
+    if (!data || size < WISDOM_HEADER_BYTES || memcmp(data, wisdom_magic, 4) != 0 ||
+        data[4] != WISDOM_FORMAT_VERSION || data[5] != WISDOM_VARIANT) {
+        return -1;
+    }
+
+    int count = data[6];
+    if (count > WISDOM_MAX_ENTRIES || size < WISDOM_HEADER_BYTES + count * WISDOM_ENTRY_BYTES) {
+        return -1;
+    }
+
+    Wisdom parsed;
+    parsed.count = 0;
+
+    const unsigned char* p = data + WISDOM_HEADER_BYTES;
+    for (int i = 0; i < count; i++, p += WISDOM_ENTRY_BYTES) {
+        WisdomEntry entry;
+        entry.length_class = p[0];
+        entry.host_block = get_u16(p + 2);
+        entry.tail_block = get_u16(p + 4);
+        entry.avg_us = get_u16(p + 6) / 10.0f;
+        entry.peak_us = get_u16(p + 8) / 10.0f;
+
+        // Partition sizes are powers of two; anything else is a corrupt blob
+        if (entry.host_block <= 0 || (entry.tail_block & (entry.tail_block - 1)) != 0) {
+            return -1;
+        }
+        wisdom_store(&parsed, &entry);
+    }
+
+    *wisdom = parsed;
+    return wisdom->count;
+}
@@ -0,0 +1,53 @@
+// wisdom.h
+// Measured partition layouts ("wisdom"), keyed by IR length and host block size
+
+#ifndef WISDOM_H
+#define WISDOM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Entries one table holds; the oldest is dropped when a new one does not fit
+#define WISDOM_MAX_ENTRIES 32
+
+// Blob layout: 8-byte header, then WISDOM_ENTRY_BYTES per entry, little-endian
+#define WISDOM_HEADER_BYTES 8
+#define WISDOM_ENTRY_BYTES  10
+#define WISDOM_MAX_BYTES    (WISDOM_HEADER_BYTES + WISDOM_MAX_ENTRIES * WISDOM_ENTRY_BYTES)
+
+// The cheapest layout the calibration found for one situation
+typedef struct {
+    int length_class;   // ceil(log2(convolved IR length))
+    int host_block;     // Samples per process call it was measured with
+    int tail_block;     // Tail-stage partition size, 0 for uniform partitions only
+    float avg_us;       // Measured cost of the winner per process call
+    float peak_us;
+} WisdomEntry;
+
+typedef struct {
+    int count;
+    WisdomEntry entries[WISDOM_MAX_ENTRIES];
+} Wisdom;
+
+int wisdom_length_class(int ir_length);
+
+// NULL when nothing was measured for this situation
+const WisdomEntry* wisdom_find(const Wisdom* wisdom, int length_class, int host_block);
+
+// Insert, or replace the entry for the same situation
+void wisdom_store(Wisdom* wisdom, const WisdomEntry* entry);
+
+// Blob for the host to persist. Returns the byte count (at most WISDOM_MAX_BYTES)
+int wisdom_serialize(const Wisdom* wisdom, unsigned char* out);
+
+// Replace the table with a blob from wisdom_serialize. Blobs from another
+// format version or engine variant (precision, threading) are rejected, since
+// their timings do not apply. Returns the entry count, or -1 (table unchanged)
+int wisdom_parse(Wisdom* wisdom, const unsigned char* data, int size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WISDOM_H
@@ -0,0 +1,132 @@
+// convolution-dsp-worker.js - Dedicated Worker hosting the reverb engine
+// In DSP worker mode the AudioWorklet only copies render quanta into and out
+// of SharedArrayBuffer rings; this Worker does all convolution in large blocks,
+// so slow IR regenerations or GC pauses here cannot underrun the audio thread.
+
+importScripts('sab-ring-buffer.js', 'convolution_reverb.js', 'convolution-module.js');
+
+// Where Atomics.waitAsync is missing the worker blocks in Atomics.wait, but
+// never longer than this before returning to its event loop for messages
+const DSP_WAIT_SLICE_MS = 20;
+
+let processor = null;
+let inputRing = null;
+let outputRing = null;
+let blockSize = 0;
+let inputBlock = null;
+let outputBlock = null;
+let agc = null;
+let running = false;
+
+self.onmessage = async (event) => {
+    const message = event.data;
+    switch (message.type) {
+        case 'init':
+            await initialize(message);
+            break;
+        case 'setParameter':
+            if (processor) processor.setParameter(message.param, message.value);
+            break;
+        case 'setIRType':
+            if (processor) processor.setImpulseResponseType(message.irType);
+            break;
+        case 'loadWisdom':
+            if (processor) processor.importWisdom(message.wisdom);
+            break;
+        case 'loadIRCache':
+            if (processor) processor.importIRCache(message.cache);
+            break;
+        case 'beginIR':
+            if (processor) processor.beginImpulseResponse(message.frames, message.sampleRate, message.channels);
+            break;
+        case 'appendIR':
+            if (processor) processor.appendImpulseResponse(message.samples);
+            break;
+        case 'stop':
+            running = false;
+            break;
+    }
+};
+
+async function initialize(message) {
+    try {
+        inputRing = new SABRingBuffer(message.inputRing);
+        outputRing = new SABRingBuffer(message.outputRing);
+        blockSize = message.blockSize;
+        inputBlock = new Float32Array(blockSize);
+        outputBlock = new Float32Array(blockSize);
+        agc = message.agc || null;
+
+        // The tuned partition layout for this block size applies from the first
+        // IR on; the IR is ready before the first block is pumped
+        processor = new ConvolutionProcessor();
+        await processor.initialize(message.wasmPath || './', message.sampleRate, {
+            hostBlockSize: blockSize,
+            wisdom: message.wisdom,
+            parameters: message.parameters,
+            irType: message.irType,
+            irCache: message.irCache
+        });
+
+        running = true;
+        self.postMessage({ type: 'initialized', blockSize: blockSize });
+        pump();
+    } catch (error) {
+        console.error('DSP worker initialization error:', error);
+        self.postMessage({ type: 'error', error: error.message });
+    }
+}
+
+// Same gain law as the worklet and the ScriptProcessor fallback
+function agcGain(block) {
+    let sum = 0;
+    for (let i = 0; i < block.length; i++) {
+        sum += block[i] * block[i];
+    }
+    const rms = Math.sqrt(sum / block.length);
+
+    if (rms > agc.silenceThreshold && rms < agc.target) {
+        return Math.min(agc.target / rms, agc.maxGain);
+    }
+    return rms < agc.silenceThreshold ? agc.silenceGain : 1.0;
+}
+
+// Process every complete block the worklet has delivered, as long as the
+// output ring has room for the result
+function drain() {
+    while (inputRing.availableRead() >= blockSize && outputRing.availableWrite() >= blockSize) {
+        inputRing.pull(inputBlock);
+
+        const gain = agc ? agcGain(inputBlock) : 1.0;
+        if (!processor.processInto(inputBlock, outputBlock, gain)) {
+            outputBlock.set(inputBlock);
+        }
+
+        outputRing.push(outputBlock);
+    }
+}
+
+// Drain, then sleep until the worklet signals new input
+function pump() {
+    const sliceStart = performance.now();
+
+    while (running) {
+        const seen = inputRing.sequence();
+        drain();
+
+        const pending = inputRing.waitAsync(seen);
+        if (pending) {
+            if (pending.async) {
+                pending.value.then(pump);
+                return;
+            }
+            continue;
+        }
+
+        inputRing.wait(seen, DSP_WAIT_SLICE_MS);
+        if (performance.now() - sliceStart >= DSP_WAIT_SLICE_MS) {
+            setTimeout(pump, 0);
+            return;
+        }
+    }
+}
@@ -1,12 +1,21 @@
 // convolution-module.js - FIXED VERSION
 // WebAssembly module wrapper for the convolution reverb engine
 
+// Engine start-up work per event loop turn (ConvolutionProcessor.prepare)
+const INIT_SLICE_BUDGET_MS = 8;
+
 class ConvolutionProcessor {
     constructor() {
         this.module = null;
         this.initialized = false;
         this.sampleRate = 48000;
         
+        // Engine-owned I/O buffers and the HEAPF32 views over them
+        this.ioInputPtr = 0;
+        this.ioOutputPtr = 0;
+        this.ioBufferFrames = 0;
+        this.ioViews = null;
+        
         // Function pointers
         this.functions = {};
         
@@ -19,11 +28,24 @@ class ConvolutionProcessor {
             'lowFreq': 4,
             'diffusion': 5,
             'mix': 6,
-            'earlyReflections': 7
+            'earlyReflections': 7,
+            'irTrimThreshold': 8,
+            'tailThreads': 9,
+            'hostBlockSize': 10,
+            'lateTailRate': 11,
+            'fdnCrossover': 12,
+            'modalEngine': 13,
+            'velvetDensity': 14
         };
     }
     
-    async initialize(wasmPath, sampleRate) {
+    // Resolves once the engine is ready to process. The options are applied
+    // before the first IR is built, so it is built once, for them:
+    // hostBlockSize, wisdom, parameters ([{ param, value }]), irType, irCache,
+    // and onProgress(percent). Engines with init_engine_async lay out their
+    // buffers, FFT plans and first IR here, a slice per event loop turn, so the
+    // first processed block does no set-up work
+    async initialize(wasmPath, sampleRate, options = {}) {
         console.log('ConvolutionProcessor: Loading WebAssembly module...');
         
         try {
@@ -46,14 +68,42 @@ class ConvolutionProcessor {
             try {
                 this.functions = {
                     init_engine: this.module.cwrap('init_engine', null, ['number']),
+                    init_engine_async: this.module.cwrap('init_engine_async', null, ['number']),
+                    continue_init: this.module.cwrap('continue_init', 'number', []),
+                    get_init_progress: this.module.cwrap('get_init_progress', 'number', []),
                     process_audio: this.module.cwrap('process_audio', null, ['number', 'number', 'number']),
+                    process_audio_f32: this.module.cwrap('process_audio_f32', null, ['number', 'number', 'number']),
                     set_parameter: this.module.cwrap('set_parameter', null, ['number', 'number']),
                     set_ir_type: this.module.cwrap('set_ir_type', null, ['string']),
                     cleanup_engine: this.module.cwrap('cleanup_engine', null, []),
                     allocate_double_array: this.module.cwrap('allocate_double_array', 'number', ['number']),
                     free_double_array: this.module.cwrap('free_double_array', null, ['number']),
+                    allocate_float_array: this.module.cwrap('allocate_float_array', 'number', ['number']),
+                    free_float_array: this.module.cwrap('free_float_array', null, ['number']),
                     is_initialized: this.module.cwrap('is_initialized', 'number', []),
                     get_sample_rate: this.module.cwrap('get_sample_rate', 'number', []),
+                    get_ir_length: this.module.cwrap('get_ir_length', 'number', []),
+                    get_effective_ir_length: this.module.cwrap('get_effective_ir_length', 'number', []),
+                    get_tail_samples: this.module.cwrap('get_tail_samples', 'number', []),
+                    get_memory_usage: this.module.cwrap('get_memory_usage', 'number', []),
+                    get_input_buffer: this.module.cwrap('get_input_buffer', 'number', ['number']),
+                    get_output_buffer: this.module.cwrap('get_output_buffer', 'number', ['number']),
+                    get_io_buffer_frames: this.module.cwrap('get_io_buffer_frames', 'number', []),
+                    process_io_buffers: this.module.cwrap('process_io_buffers', null, ['number', 'number']),
+                    calibrate_partitions: this.module.cwrap('calibrate_partitions', 'number', ['number', 'number']),
+                    get_wisdom_buffer: this.module.cwrap('get_wisdom_buffer', 'number', []),
+                    get_wisdom_capacity: this.module.cwrap('get_wisdom_capacity', 'number', []),
+                    save_wisdom: this.module.cwrap('save_wisdom', 'number', []),
+                    load_wisdom: this.module.cwrap('load_wisdom', 'number', ['number']),
+                    get_ir_cache_key: this.module.cwrap('get_ir_cache_key', 'number', []),
+                    get_ir_cache_buffer: this.module.cwrap('get_ir_cache_buffer', 'number', []),
+                    reserve_ir_cache: this.module.cwrap('reserve_ir_cache', 'number', ['number']),
+                    save_ir_cache: this.module.cwrap('save_ir_cache', 'number', []),
+                    load_ir_cache: this.module.cwrap('load_ir_cache', 'number', ['number']),
+                    get_ir_upload_buffer: this.module.cwrap('get_ir_upload_buffer', 'number', []),
+                    get_ir_upload_capacity: this.module.cwrap('get_ir_upload_capacity', 'number', []),
+                    begin_ir_samples: this.module.cwrap('begin_ir_samples', 'number', ['number', 'number', 'number']),
+                    append_ir_samples: this.module.cwrap('append_ir_samples', 'number', ['number', 'number']),
                     get_version: this.module.cwrap('get_version', 'string', [])
                 };
             } catch (e) {
@@ -68,6 +118,10 @@ class ConvolutionProcessor {
                     free_double_array: this.module.cwrap('free_double_array', null, ['number']),
                     is_initialized: this.module.cwrap('is_initialized_', 'number', []),
                     get_sample_rate: this.module.cwrap('get_sample_rate_', 'number', []),
+                    get_ir_length: this.module.cwrap('get_ir_length_', 'number', []),
+                    get_effective_ir_length: this.module.cwrap('get_effective_ir_length_', 'number', []),
+                    get_tail_samples: this.module.cwrap('get_tail_samples_', 'number', []),
+                    get_memory_usage: this.module.cwrap('get_memory_usage_', 'number', []),
                     get_version: this.module.cwrap('get_version_', 'string', [])
                 };
             }
@@ -75,7 +129,12 @@ class ConvolutionProcessor {
             // Initialize the engine
             this.sampleRate = sampleRate;
             console.log('ConvolutionProcessor: Initializing engine with sample rate:', sampleRate);
-            this.functions.init_engine(sampleRate);
+            const prepared = !!this.functions.init_engine_async;
+            if (prepared) {
+                this.functions.init_engine_async(sampleRate);
+            } else {
+                this.functions.init_engine(sampleRate);
+            }
             
             // Verify initialization
             const isInit = this.functions.is_initialized();
@@ -83,8 +142,32 @@ class ConvolutionProcessor {
                 throw new Error('Engine failed to initialize');
             }
             
+            // The I/O buffers live in static engine memory - their addresses never change
+            if (this.functions.get_io_buffer_frames) {
+                this.ioInputPtr = this.functions.get_input_buffer(0);
+                this.ioOutputPtr = this.functions.get_output_buffer(0);
+                this.ioBufferFrames = this.functions.get_io_buffer_frames();
+            }
+            
             this.initialized = true;
             
+            if (options.hostBlockSize) {
+                this.setParameter('hostBlockSize', options.hostBlockSize);
+            }
+            if (options.wisdom) {
+                this.importWisdom(options.wisdom);
+            }
+            (options.parameters || []).forEach(({ param, value }) => this.setParameter(param, value));
+            if (options.irType) {
+                this.setImpulseResponseType(options.irType);
+            }
+            if (options.irCache) {
+                this.importIRCache(options.irCache);
+            }
+            if (prepared) {
+                await this.prepare(options.onProgress);
+            }
+            
             console.log('ConvolutionProcessor: Initialization complete!');
             console.log('ConvolutionProcessor: Version:', this.getVersion());
             console.log('ConvolutionProcessor: Sample rate:', this.getSampleRate(), 'Hz');
@@ -97,12 +180,59 @@ class ConvolutionProcessor {
         }
     }
     
+    // Run the engine start-up begun by init_engine_async to the end, yielding
+    // to the event loop every INIT_SLICE_BUDGET_MS
+    async prepare(onProgress) {
+        let progress = this.functions.get_init_progress();
+        while (progress >= 0 && progress < 100) {
+            const start = performance.now();
+            do {
+                progress = this.functions.continue_init();
+            } while (progress >= 0 && progress < 100 && performance.now() - start < INIT_SLICE_BUDGET_MS);
+            
+            if (onProgress) onProgress(Math.max(progress, 0));
+            if (progress < 100) {
+                await new Promise(resolve => setTimeout(resolve, 0));
+            }
+        }
+        if (progress < 0) {
+            throw new Error('Engine failed to prepare');
+        }
+    }
+    
+    // Emscripten glue source and .wasm bytes for hosting a second engine
+    // instance in an AudioWorklet or Worker, which cannot fetch them itself
+    static async fetchEngineSources(wasmPath) {
+        const [glueResponse, wasmResponse] = await Promise.all([
+            fetch(wasmPath + 'convolution_reverb.js'),
+            fetch(wasmPath + 'convolution_reverb.wasm')
+        ]);
+        if (!glueResponse.ok || !wasmResponse.ok) {
+            throw new Error('Failed to fetch the WebAssembly engine');
+        }
+        return {
+            glueSource: await glueResponse.text(),
+            wasmBinary: await wasmResponse.arrayBuffer()
+        };
+    }
+    
     processAudio(inputArray) {
         if (!this.initialized) {
             console.warn('ConvolutionProcessor: Not initialized, returning input');
             return inputArray;
         }
         
+        // Blocks that fit the engine I/O buffers need no WASM allocation at all
+        if (inputArray instanceof Float32Array && inputArray.length <= this.ioBufferFrames) {
+            const output = new Float32Array(inputArray.length);
+            return this.processInto(inputArray, output) ? output : inputArray;
+        }
+        
+        // Web Audio data goes through the float32 entry point - no conversion loops
+        if (inputArray instanceof Float32Array && this.functions.process_audio_f32) {
+            return this.processAudioFloat32(inputArray);
+        }
+        
         const numSamples = inputArray.length;
         
         // Allocate memory for input and output
@@ -151,6 +281,383 @@ class ConvolutionProcessor {
         }
     }
     
+    processAudioFloat32(inputArray) {
+        const numSamples = inputArray.length;
+        
+        const inputPtr = this.functions.allocate_float_array(numSamples);
+        const outputPtr = this.functions.allocate_float_array(numSamples);
+        
+        if (!inputPtr || !outputPtr) {
+            console.error('ConvolutionProcessor: Failed to allocate memory');
+            return inputArray;
+        }
+        
+        try {
+            this.module.HEAPF32.set(inputArray, inputPtr >> 2);
+            
+            this.functions.process_audio_f32(inputPtr, outputPtr, numSamples);
+            
+            // Read HEAPF32 again - the heap may have grown during processing
+            return this.module.HEAPF32.slice(outputPtr >> 2, (outputPtr >> 2) + numSamples);
+        } catch (error) {
+            console.error('ConvolutionProcessor: Processing error:', error);
+            return inputArray;
+        } finally {
+            this.functions.free_float_array(inputPtr);
+            this.functions.free_float_array(outputPtr);
+        }
+    }
+    
+    // Float32Array views over the engine I/O buffers. They are only rebuilt when
+    // the WASM memory has grown (which detaches the old ArrayBuffer) or the
+    // block size changes
+    getIOViews(numSamples) {
+        const heap = this.module.HEAPF32;
+        const views = this.ioViews;
+        if (views && views.buffer === heap.buffer && views.length === numSamples) {
+            return views;
+        }
+        
+        this.ioViews = {
+            buffer: heap.buffer,
+            length: numSamples,
+            input: heap.subarray(this.ioInputPtr >> 2, (this.ioInputPtr >> 2) + numSamples),
+            output: heap.subarray(this.ioOutputPtr >> 2, (this.ioOutputPtr >> 2) + numSamples)
+        };
+        return this.ioViews;
+    }
+    
+    // Process a block straight from one caller-owned Float32Array into another
+    // (which may be subarrays of larger buffers). Optional gain is applied on the
+    // way in. Nothing is allocated; returns false when the block cannot be handled.
+    processInto(input, output, gain = 1.0) {
+        const numSamples = input.length;
+        if (!this.initialized || numSamples > this.ioBufferFrames || output.length < numSamples) {
+            return false;
+        }
+        
+        try {
+            const inputView = this.getIOViews(numSamples).input;
+            if (gain === 1.0) {
+                inputView.set(input);
+            } else {
+                for (let i = 0; i < numSamples; i++) {
+                    inputView[i] = input[i] * gain;
+                }
+            }
+            
+            this.functions.process_io_buffers(numSamples, 1);
+            
+            // An IR regeneration inside the call may have grown the heap
+            output.set(this.getIOViews(numSamples).output);
+            return true;
+        } catch (error) {
+            console.error('ConvolutionProcessor: Processing error:', error);
+            return false;
+        }
+    }
+    
+    // Measure the partition layouts on the current IR for calls of blockSize
+    // samples and switch to the cheapest one that meets the deadline. Cached
+    // per IR length class and block size unless force is set; blocks the
+    // calling thread while measuring. Returns the tail partition size (0:
+    // uniform partitions), or -1
+    calibratePartitions(blockSize, force = false) {
+        if (!this.initialized || !this.functions.calibrate_partitions) return -1;
+        try {
+            return this.functions.calibrate_partitions(blockSize, force ? 1 : 0);
+        } catch (error) {
+            console.error('ConvolutionProcessor: Error calibrating partitions:', error);
+            return -1;
+        }
+    }
+    
+    // Measured layouts as a small blob for persistence, or null
+    exportWisdom() {
+        if (!this.initialized || !this.functions.save_wisdom) return null;
+        const size = this.functions.save_wisdom();
+        const ptr = this.functions.get_wisdom_buffer();
+        return this.module.HEAPU8.slice(ptr, ptr + size);
+    }
+    
+    // Restore a blob from exportWisdom. Returns the number of layouts loaded,
+    // or -1 when it does not fit this engine build
+    importWisdom(bytes) {
+        if (!this.initialized || !this.functions.load_wisdom || !bytes) return -1;
+        const blob = bytes instanceof Uint8Array ? bytes : new Uint8Array(bytes);
+        if (blob.length > this.functions.get_wisdom_capacity()) return -1;
+        
+        this.module.HEAPU8.set(blob, this.functions.get_wisdom_buffer());
+        return this.functions.load_wisdom(blob.length);
+    }
+    
+    // Hash of the settings the current IR is generated from (what an
+    // exported IR is stored under), or null
+    getIRCacheKey() {
+        if (!this.initialized || !this.functions.get_ir_cache_key) return null;
+        return this.functions.get_ir_cache_key() >>> 0;
+    }
+    
+    // The generated IR, early reflections and partition spectra as a blob, or
+    // null (no IR, or a sampled IR loaded). Finishes IR generation first
+    exportIRCache() {
+        if (!this.initialized || !this.functions.save_ir_cache) return null;
+        const size = this.functions.save_ir_cache();
+        if (size <= 0) return null;
+        const ptr = this.functions.get_ir_cache_buffer();
+        return this.module.HEAPU8.slice(ptr, ptr + size);
+    }
+    
+    // Replace the IR with a blob from exportIRCache. Returns false when it was
+    // made for another engine build, or for other settings - then the engine
+    // keeps it for the next IR those settings generate, so importing before
+    // setImpulseResponseType switches types without synthesis
+    importIRCache(bytes) {
+        if (!this.initialized || !this.functions.load_ir_cache || !bytes) return false;
+        const blob = bytes instanceof Uint8Array ? bytes : new Uint8Array(bytes);
+        
+        const ptr = this.functions.reserve_ir_cache(blob.length);
+        if (!ptr) return false;
+        this.module.HEAPU8.set(blob, ptr);
+        return this.functions.load_ir_cache(blob.length) === 0;
+    }
+    
+    // Replace the generated IR with a recording of frames frames of channels
+    // interleaved channels at sampleRate, sent in pieces with
+    // appendImpulseResponse. Returns false if the engine rejected the format
+    beginImpulseResponse(frames, sampleRate, channels) {
+        if (!this.initialized || !this.functions.begin_ir_samples) return false;
+        this.irUploadChannels = channels;
+        return this.functions.begin_ir_samples(frames, sampleRate, channels) === 0;
+    }
+    
+    // Next interleaved samples of the recording (whole frames). The engine
+    // convolves with what has arrived so far; returns the IR taps ready, or -1
+    appendImpulseResponse(samples) {
+        if (!this.initialized || !this.functions.append_ir_samples) return -1;
+        const channels = this.irUploadChannels || 1;
+        const chunk = Math.floor(this.functions.get_ir_upload_capacity() / channels) * channels;
+        
+        let ready = -1;
+        for (let offset = 0; offset < samples.length; offset += chunk) {
+            const piece = samples.subarray(offset, Math.min(offset + chunk, samples.length));
+            // Looked up per chunk: the engine may grow WASM memory between calls
+            const ptr = this.functions.get_ir_upload_buffer();
+            this.module.HEAPF32.set(piece, ptr >> 2);
+            ready = this.functions.append_ir_samples(ptr, piece.length / channels);
+            if (ready < 0) break;
+        }
+        return ready;
+    }
+    
+    // Whole recording as one Float32Array per channel (an AudioBuffer's
+    // channel data). Returns the IR taps ready, or -1
+    loadImpulseResponse(channelData, sampleRate) {
+        const channels = channelData.length;
+        const frames = channels > 0 ? channelData[0].length : 0;
+        if (!this.beginImpulseResponse(frames, sampleRate, channels)) return -1;
+        
+        const chunkFrames = Math.floor(this.functions.get_ir_upload_capacity() / channels);
+        const interleaved = new Float32Array(chunkFrames * channels);
+        let ready = -1;
+        for (let start = 0; start < frames; start += chunkFrames) {
+            const count = Math.min(chunkFrames, frames - start);
+            for (let c = 0; c < channels; c++) {
+                const data = channelData[c];
+                for (let f = 0; f < count; f++) {
+                    interleaved[f * channels + c] = data[start + f];
+                }
+            }
+            ready = this.appendImpulseResponse(interleaved.subarray(0, count * channels));
+            if (ready < 0) break;
+        }
+        return ready;
+    }
+    
+    // Fetch a WAV file and hand it to sink as it downloads: sink.begin(frames,
+    // sampleRate, channels) once the header is in, then sink.append(samples)
+    // with interleaved Float32Arrays of up to IR_STREAM_FRAMES frames. Both may
+    // return promises. Rejects on HTTP errors and on files that are not PCM or
+    // float WAV (decode those with decodeAudioData instead)
+    static async streamImpulseResponse(url, sink) {
+        const IR_STREAM_FRAMES = 4096;
+        const response = await fetch(url);
+        if (!response.ok) throw new Error(`HTTP ${response.status} loading ${url}`);
+        
+        const reader = response.body ? response.body.getReader() : null;
+        let buffer = reader ? new Uint8Array(0) : new Uint8Array(await response.arrayBuffer());
+        let ended = !reader;
+        
+        // Buffer at least n bytes, fewer only at the end of the stream
+        const fill = async (n) => {
+            while (buffer.length < n && !ended) {
+                const { done, value } = await reader.read();
+                if (done) {
+                    ended = true;
+                    break;
+                }
+                const joined = new Uint8Array(buffer.length + value.length);
+                joined.set(buffer);
+                joined.set(value, buffer.length);
+                buffer = joined;
+            }
+            return buffer.length >= n;
+        };
+        const take = (n) => {
+            const view = new DataView(buffer.buffer, buffer.byteOffset, n);
+            buffer = buffer.subarray(n);
+            return view;
+        };
+        const tag = (view, offset) => String.fromCharCode(
+            view.getUint8(offset), view.getUint8(offset + 1), view.getUint8(offset + 2), view.getUint8(offset + 3));
+        
+        if (!await fill(12)) throw new Error('Not a WAV file');
+        const riff = take(12);
+        if (tag(riff, 0) !== 'RIFF' || tag(riff, 8) !== 'WAVE') throw new Error('Not a WAV file');
+        
+        // Chunks up to the sample data; only the format matters
+        let format = null;
+        let dataBytes = 0;
+        for (;;) {
+            if (!await fill(8)) throw new Error('WAV file has no data chunk');
+            const header = take(8);
+            const size = header.getUint32(4, true);
+            if (tag(header, 0) === 'data') {
+                dataBytes = size;
+                break;
+            }
+            const padded = size + (size & 1);
+            if (!await fill(padded)) throw new Error('WAV file is truncated');
+            const body = take(padded);
+            if (tag(header, 0) === 'fmt ' && size >= 16) {
+                format = {
+                    code: body.getUint16(0, true),
+                    channels: body.getUint16(2, true),
+                    sampleRate: body.getUint32(4, true),
+                    blockAlign: body.getUint16(12, true),
+                    bits: body.getUint16(14, true)
+                };
+                if (format.code === 0xFFFE && size >= 26) {
+                    format.code = body.getUint16(24, true);   // WAVE_FORMAT_EXTENSIBLE sub-format
+                }
+            }
+        }
+        
+        const read = format ? ConvolutionProcessor.wavSampleReader(format.code, format.bits) : null;
+        if (!read || format.channels < 1 || format.blockAlign < format.channels * (format.bits >> 3)) {
+            throw new Error('Unsupported WAV encoding');
+        }
+        const channels = format.channels;
+        const bytes = format.bits >> 3;
+        const frames = Math.floor(dataBytes / format.blockAlign);
+        if (frames < 1) throw new Error('WAV file has no samples');
+        
+        await sink.begin(frames, format.sampleRate, channels);
+        for (let done = 0; done < frames;) {
+            await fill(Math.min(IR_STREAM_FRAMES, frames - done) * format.blockAlign);
+            const count = Math.min(IR_STREAM_FRAMES, frames - done, Math.floor(buffer.length / format.blockAlign));
+            if (count < 1) throw new Error('WAV file is truncated');
+            
+            const view = take(count * format.blockAlign);
+            const samples = new Float32Array(count * channels);
+            for (let f = 0; f < count; f++) {
+                for (let c = 0; c < channels; c++) {
+                    samples[f * channels + c] = read(view, f * format.blockAlign + c * bytes);
+                }
+            }
+            done += count;
+            await sink.append(samples);
+        }
+        if (reader && !ended) reader.cancel();
+    }
+    
+    // Sample decoder for WAV format code and bit depth, or null
+    static wavSampleReader(code, bits) {
+        if (code === 3 && bits === 32) return (view, at) => view.getFloat32(at, true);
+        if (code !== 1) return null;
+        switch (bits) {
+            case 8: return (view, at) => (view.getUint8(at) - 128) / 128;
+            case 16: return (view, at) => view.getInt16(at, true) / 32768;
+            case 24: return (view, at) => ((view.getUint8(at + 2) << 24 | view.getUint8(at + 1) << 16 |
+                                            view.getUint8(at) << 8) >> 8) / 8388608;
+            case 32: return (view, at) => view.getInt32(at, true) / 2147483648;
+            default: return null;
+        }
+    }
+    
+    // Wisdom persisted in IndexedDB under key, or null (also where IndexedDB
+    // is unavailable, e.g. in worklet scopes)
+    static loadStoredWisdom(key) {
+        return ConvolutionProcessor.objectStore('wisdom', 'readonly', (store) => store.get(key))
+            .then((value) => (value ? new Uint8Array(value) : null))
+            .catch(() => null);
+    }
+    
+    static storeWisdom(key, bytes) {
+        return ConvolutionProcessor.objectStore('wisdom', 'readwrite', (store) => store.put(bytes, key))
+            .catch((error) => console.warn('ConvolutionProcessor: Could not persist wisdom:', error));
+    }
+    
+    // Precomputed IR blob persisted in IndexedDB under key, or null
+    static loadStoredIRCache(key) {
+        return ConvolutionProcessor.objectStore('ir-cache', 'readonly', (store) => store.get(key))
+            .then((value) => (value ? new Uint8Array(value.bytes) : null))
+            .catch(() => null);
+    }
+    
+    // Blobs run to a few MB each, so only the most recently saved are kept
+    static storeIRCache(key, bytes) {
+        const IR_CACHE_ENTRIES = 16;
+        return ConvolutionProcessor.objectStore('ir-cache', 'readwrite', (store) => {
+            store.put({ bytes: bytes, savedAt: Date.now() }, key);
+            
+            let kept = 0;
+            const cursor = store.index('savedAt').openKeyCursor(null, 'prev');
+            cursor.onsuccess = () => {
+                const entry = cursor.result;
+                if (!entry) return;
+                if (++kept > IR_CACHE_ENTRIES) store.delete(entry.primaryKey);
+                entry.continue();
+            };
+            return cursor;
+        }).catch((error) => console.warn('ConvolutionProcessor: Could not persist IR:', error));
+    }
+    
+    // Run one request against one of the object stores
+    static objectStore(name, mode, request) {
+        return new Promise((resolve, reject) => {
+            if (typeof indexedDB === 'undefined') {
+                resolve(null);
+                return;
+            }
+            
+            const open = indexedDB.open('convolution-reverb', 2);
+            open.onupgradeneeded = () => {
+                const db = open.result;
+                if (!db.objectStoreNames.contains('wisdom')) {
+                    db.createObjectStore('wisdom');
+                }
+                if (!db.objectStoreNames.contains('ir-cache')) {
+                    db.createObjectStore('ir-cache').createIndex('savedAt', 'savedAt');
+                }
+            };
+            open.onerror = () => reject(open.error);
+            open.onsuccess = () => {
+                const db = open.result;
+                const transaction = db.transaction(name, mode);
+                const pending = request(transaction.objectStore(name));
+                transaction.oncomplete = () => {
+                    db.close();
+                    resolve(pending.result);
+                };
+                transaction.onerror = () => {
+                    db.close();
+                    reject(transaction.error);
+                };
+            };
+        });
+    }
+    
     setParameter(paramName, value) {
         if (!this.initialized) {
             console.warn('ConvolutionProcessor: Cannot set parameter - not initialized');
@@ -209,12 +716,58 @@ class ConvolutionProcessor {
         }
     }
     
+    // Full generated IR length in samples
+    getIRLength() {
+        if (!this.initialized) return 0;
+        try {
+            return this.functions.get_ir_length();
+        } catch (error) {
+            console.error('ConvolutionProcessor: Error getting IR length:', error);
+            return 0;
+        }
+    }
+    
+    // IR length actually convolved after energy-based trimming
+    getEffectiveIRLength() {
+        if (!this.initialized) return 0;
+        try {
+            return this.functions.get_effective_ir_length();
+        } catch (error) {
+            console.error('ConvolutionProcessor: Error getting effective IR length:', error);
+            return 0;
+        }
+    }
+    
+    // Samples of reverb tail still to come; 0 once the engine has gone idle
+    getTailSamples() {
+        if (!this.initialized) return 0;
+        try {
+            return this.functions.get_tail_samples();
+        } catch (error) {
+            console.error('ConvolutionProcessor: Error getting tail samples:', error);
+            return 0;
+        }
+    }
+    
+    // Bytes reserved by the engine arenas (IR, tap history, FFT partitions, and a
+    // layout rebuild's second convolver while it holds one)
+    getMemoryUsage() {
+        if (!this.initialized) return 0;
+        try {
+            return this.functions.get_memory_usage();
+        } catch (error) {
+            console.error('ConvolutionProcessor: Error getting memory usage:', error);
+            return 0;
+        }
+    }
+    
     cleanup() {
         if (this.initialized) {
             console.log('ConvolutionProcessor: Cleaning up...');
             try {
                 this.functions.cleanup_engine();
                 this.initialized = false;
+                this.ioViews = null;
                 console.log('ConvolutionProcessor: Cleanup complete');
             } catch (error) {
                 console.error('ConvolutionProcessor: Error during cleanup:', error);
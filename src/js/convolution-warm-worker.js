@@ -0,0 +1,86 @@
+// convolution-warm-worker.js - Idle-time IR pre-generation
+// Hosts a private engine that generates the IR of every type at the current
+// settings and posts each back as an IR cache blob (ConvolutionProcessor.
+// exportIRCache), so switching types later needs no synthesis. One IR per
+// task: a new 'warm' message replaces the queue, which cancels the work still
+// pending for stale settings.
+
+importScripts('convolution_reverb.js', 'convolution-module.js');
+
+// Pause between two IRs, leaving the CPU to the audio threads now and then
+const WARM_PAUSE_MS = 50;
+
+let processor = null;
+let queue = [];
+let settings = null;
+let pendingParameters = [];
+let stepping = false;
+
+self.onmessage = async (event) => {
+    const message = event.data;
+    switch (message.type) {
+        case 'init':
+            await initialize(message);
+            break;
+        case 'warm':
+            warm(message);
+            break;
+        case 'loadWisdom':
+            if (processor) processor.importWisdom(message.wisdom);
+            break;
+    }
+};
+
+async function initialize(message) {
+    try {
+        // Same partition layout as the live engine, so the spectra in the
+        // blobs load straight into it
+        processor = new ConvolutionProcessor();
+        await processor.initialize(message.wasmPath || './', message.sampleRate, {
+            hostBlockSize: message.blockSize,
+            wisdom: message.wisdom
+        });
+
+        self.postMessage({ type: 'initialized' });
+    } catch (error) {
+        console.error('IR warmer initialization error:', error);
+        self.postMessage({ type: 'error', error: error.message });
+    }
+}
+
+// Generate irTypes in order at parameters; settings is echoed back with each
+// blob
+function warm(message) {
+    settings = message.settings;
+    queue = message.irTypes.slice();
+    pendingParameters = message.parameters || [];
+    if (!stepping) {
+        stepping = true;
+        setTimeout(step, 0);
+    }
+}
+
+function step() {
+    if (!processor || queue.length === 0) {
+        stepping = false;
+        return;
+    }
+
+    // Parameters first: applied once per 'warm', not once per type
+    pendingParameters.forEach(({ param, value }) => processor.setParameter(param, value));
+    pendingParameters = [];
+
+    const irType = queue.shift();
+    processor.setImpulseResponseType(irType);
+    const key = processor.getIRCacheKey();
+    if (key !== null) {
+        // Finishes the generation the type switch started
+        const blob = processor.exportIRCache();
+        if (blob) {
+            self.postMessage({ type: 'warmed', irType: irType, key: key, settings: settings, cache: blob },
+                             [blob.buffer]);
+        }
+    }
+
+    setTimeout(step, WARM_PAUSE_MS);
+}
@@ -1,14 +1,52 @@
 // convolution-worklet.js - AudioWorklet Processor for Low-Latency Reverb
+// Load sab-ring-buffer.js with addModule() before this file.
+
+// Web Audio render quantum
+const RENDER_QUANTUM = 128;
+
+// Minimum render quanta between two latency reports
+const LATENCY_REPORT_QUANTA = 375;
 
 class ConvolutionReverbWorklet extends AudioWorkletProcessor {
-    constructor() {
+    constructor(options) {
         super();
         
+        const processorOptions = (options && options.processorOptions) || {};
+        
         this.initialized = false;
+        this.preparing = false;     // Asynchronous engine start-up under way
         this.wasmModule = null;
         this.inputPtr = null;
         this.outputPtr = null;
         this.bufferSize = 0;
+        this.useFloat32 = false;
+        
+        // Engine-owned I/O buffers (stable addresses) and views over them
+        this.useIOBuffers = false;
+        this.ioViews = null;
+        
+        // The engine runs on blocks of blockSize frames (a multiple of the render
+        // quantum). The rings between render quanta and engine blocks add
+        // blockSize - 128 frames of latency - none at the default of 128.
+        this.blockSize = Math.max(RENDER_QUANTUM,
+            Math.ceil((processorOptions.blockSize || RENDER_QUANTUM) / RENDER_QUANTUM) * RENDER_QUANTUM);
+        
+        // DSP worker mode: the engine runs in a Worker on the far side of the
+        // rings, and this processor only copies quanta and signals the Worker.
+        // The output ring is primed with a block the Worker fills while it
+        // waits for input plus a block of slack for its processing time.
+        this.workerMode = !!processorOptions.dspWorker;
+        const ringCapacity = (this.workerMode ? 4 : 2) * this.blockSize + RENDER_QUANTUM;
+        this.inputRing = SABRingBuffer.create(ringCapacity);
+        this.outputRing = SABRingBuffer.create(ringCapacity);
+        this.outputRing.pushSilence(this.workerMode ? 2 * this.blockSize : this.blockSize - RENDER_QUANTUM);
+        this.blockScratch = new Float32Array(this.blockSize);
+        this.reportedLatency = -1;
+        this.quantaSinceReport = 0;
+        this.underruns = 0;
+        
+        // Optional automatic gain control, applied per engine block
+        this.agc = processorOptions.agc || null;
         
         // Parameters
         this.parameters = {
@@ -19,14 +57,30 @@ class ConvolutionReverbWorklet extends AudioWorkletProcessor {
             lowFreq: 50,
             diffusion: 80,
             mix: 30,
-            earlyReflections: 50
+            earlyReflections: 50,
+            hostBlockSize: this.blockSize   // Selects the tuned partition layout
         };
+        this.irType = null;
+        this.wisdom = null;
+        
+        if (this.workerMode) {
+            if (!this.inputRing.isShared) {
+                this.port.postMessage({ type: 'error', error: 'DSP worker mode needs SharedArrayBuffer' });
+            } else {
+                this.port.postMessage({
+                    type: 'rings',
+                    inputRing: this.inputRing.buffer,
+                    outputRing: this.outputRing.buffer,
+                    blockSize: this.blockSize
+                });
+            }
+        }
         
         // Handle messages from main thread
         this.port.onmessage = async (event) => {
             switch (event.data.type) {
                 case 'init':
-                    await this.initializeModule(event.data.wasmModule);
+                    await this.initializeModule(event.data);
                     break;
                 case 'setParameter':
                     this.setParameter(event.data.param, event.data.value);
@@ -34,16 +88,53 @@ class ConvolutionReverbWorklet extends AudioWorkletProcessor {
                 case 'setIRType':
                     this.setIRType(event.data.irType);
                     break;
+                case 'loadWisdom':
+                    this.loadWisdom(event.data.wisdom);
+                    break;
+                case 'loadIRCache':
+                    this.loadIRCache(event.data.cache);
+                    break;
+                case 'beginIR':
+                    this.beginIR(event.data.frames, event.data.sampleRate, event.data.channels);
+                    break;
+                case 'appendIR':
+                    this.appendIR(event.data.samples);
+                    break;
             }
         };
     }
     
-    async initializeModule(wasmModule) {
+    // The worklet scope cannot fetch, so the main thread posts the Emscripten
+    // glue source and the .wasm bytes (ConvolutionProcessor.fetchEngineSources)
+    async instantiateModule(glueSource, wasmBinary) {
+        const factory = new Function(`${glueSource}\nreturn ConvolutionModule;`)();
+        return factory({
+            wasmBinary: wasmBinary,
+            print: (text) => console.log('WASM (worklet):', text),
+            printErr: (text) => console.error('WASM Error (worklet):', text)
+        });
+    }
+    
+    async initializeModule(data) {
         try {
-            this.wasmModule = wasmModule;
+            this.wasmModule = data.wasmModule ||
+                await this.instantiateModule(data.glueSource, data.wasmBinary);
+            
+            // Float32 entry point: Web Audio buffers are copied without conversion
+            this.useFloat32 = typeof this.wasmModule._process_audio_f32 === 'function';
+            this.useIOBuffers = typeof this.wasmModule._process_io_buffers === 'function';
+            
+            // Initialize the convolution engine; with the asynchronous start-up
+            // the first IR waits for the settings below
+            const prepared = typeof this.wasmModule._init_engine_async === 'function';
+            if (prepared) {
+                this.wasmModule._init_engine_async(sampleRate);
+            } else {
+                this.wasmModule._init_engine(sampleRate);
+            }
             
-            // Initialize the convolution engine
-            this.wasmModule._init_engine(sampleRate);
+            // Layouts measured on the main thread - before the parameters build the first IR
+            this.loadWisdom(data.wisdom || this.wisdom);
             
             // Set initial parameters
             const paramMap = {
@@ -54,7 +145,14 @@ class ConvolutionReverbWorklet extends AudioWorkletProcessor {
                 'lowFreq': 4,
                 'diffusion': 5,
                 'mix': 6,
-                'earlyReflections': 7
+                'earlyReflections': 7,
+                'irTrimThreshold': 8,
+                'tailThreads': 9,
+                'hostBlockSize': 10,
+                'lateTailRate': 11,
+                'fdnCrossover': 12,
+                'modalEngine': 13,
+                'velvetDensity': 14
             };
             
             Object.keys(this.parameters).forEach((param) => {
@@ -64,8 +162,30 @@ class ConvolutionReverbWorklet extends AudioWorkletProcessor {
                 }
             });
             
+            if (this.useIOBuffers) {
+                this.inputPtr = this.wasmModule._get_input_buffer(0);
+                this.outputPtr = this.wasmModule._get_output_buffer(0);
+            }
+            
             this.initialized = true;
-            this.port.postMessage({ type: 'initialized' });
+            
+            if (this.irType) {
+                this.setIRType(this.irType);
+            }
+            
+            // A stored IR for these settings replaces synthesizing the first one
+            this.loadIRCache(data.irCache || this.irCache);
+            
+            // This handler runs on the rendering thread: the start-up is stepped
+            // one slice per render quantum in process() instead, silent until done
+            this.preparing = prepared;
+            
+            this.port.postMessage({
+                type: 'initialized',
+                blockSize: this.blockSize,
+                latencyFrames: this.blockSize - RENDER_QUANTUM,
+                sharedRings: this.inputRing.isShared
+            });
             
         } catch (error) {
             console.error('Worklet initialization error:', error);
@@ -73,25 +193,45 @@ class ConvolutionReverbWorklet extends AudioWorkletProcessor {
         }
     }
     
+    // Views are rebuilt only after WASM memory growth or a block size change
+    getIOViews(numSamples) {
+        const heap = this.wasmModule.HEAPF32;
+        const views = this.ioViews;
+        if (views && views.buffer === heap.buffer && views.length === numSamples) {
+            return views;
+        }
+        
+        this.ioViews = {
+            buffer: heap.buffer,
+            length: numSamples,
+            input: heap.subarray(this.inputPtr >> 2, (this.inputPtr >> 2) + numSamples),
+            output: heap.subarray(this.outputPtr >> 2, (this.outputPtr >> 2) + numSamples)
+        };
+        return this.ioViews;
+    }
+    
     allocateBuffers(size) {
         if (size > this.bufferSize) {
+            const release = this.useFloat32 ? '_free_float_array' : '_free_double_array';
+            const allocate = this.useFloat32 ? '_allocate_float_array' : '_allocate_double_array';
+            
             // Free existing buffers
             if (this.inputPtr) {
-                this.wasmModule._free_double_array(this.inputPtr);
-                this.wasmModule._free_double_array(this.outputPtr);
+                this.wasmModule[release](this.inputPtr);
+                this.wasmModule[release](this.outputPtr);
             }
             
             // Allocate new buffers
-            this.inputPtr = this.wasmModule._allocate_double_array(size);
-            this.outputPtr = this.wasmModule._allocate_double_array(size);
+            this.inputPtr = this.wasmModule[allocate](size);
+            this.outputPtr = this.wasmModule[allocate](size);
             this.bufferSize = size;
         }
     }
     
     setParameter(param, value) {
-        if (!this.initialized) return;
-        
+        // Remembered so initializeModule applies it if the engine is not up yet
         this.parameters[param] = value;
+        if (!this.initialized) return;
         
         const paramMap = {
             'roomSize': 0,
@@ -101,7 +241,14 @@ class ConvolutionReverbWorklet extends AudioWorkletProcessor {
             'lowFreq': 4,
             'diffusion': 5,
             'mix': 6,
-            'earlyReflections': 7
+            'earlyReflections': 7,
+            'irTrimThreshold': 8,
+            'tailThreads': 9,
+            'hostBlockSize': 10,
+            'lateTailRate': 11,
+            'fdnCrossover': 12,
+            'modalEngine': 13,
+            'velvetDensity': 14
         };
         
         const paramId = paramMap[param];
@@ -110,9 +257,62 @@ class ConvolutionReverbWorklet extends AudioWorkletProcessor {
         }
     }
     
+    // Partition wisdom from the main thread (ConvolutionProcessor.exportWisdom)
+    loadWisdom(wisdom) {
+        // Remembered so initializeModule loads it if the engine is not up yet
+        this.wisdom = wisdom;
+        if (!wisdom || !this.wasmModule || typeof this.wasmModule._load_wisdom !== 'function') return;
+        if (wisdom.length > this.wasmModule._get_wisdom_capacity()) return;
+        
+        this.wasmModule.HEAPU8.set(wisdom, this.wasmModule._get_wisdom_buffer());
+        this.wasmModule._load_wisdom(wisdom.length);
+    }
+    
+    // Precomputed IR from the main thread (ConvolutionProcessor.exportIRCache).
+    // The engine turns it down if the settings have moved on since
+    loadIRCache(cache) {
+        this.irCache = cache;
+        if (!cache || !this.initialized || typeof this.wasmModule._load_ir_cache !== 'function') return;
+        
+        const ptr = this.wasmModule._reserve_ir_cache(cache.length);
+        if (!ptr) return;
+        this.wasmModule.HEAPU8.set(cache, ptr);
+        this.wasmModule._load_ir_cache(cache.length);
+    }
+    
+    // Sampled IR upload (see ConvolutionProcessor.beginImpulseResponse). The
+    // main thread replays it once the engine is up, so nothing is queued here
+    beginIR(frames, irSampleRate, channels) {
+        this.irUploadChannels = 0;
+        if (!this.initialized || typeof this.wasmModule._begin_ir_samples !== 'function') return;
+        if (this.wasmModule._begin_ir_samples(frames, irSampleRate, channels) === 0) {
+            this.irUploadChannels = channels;
+        }
+    }
+    
+    appendIR(samples) {
+        const channels = this.irUploadChannels;
+        if (!this.initialized || !channels) return;
+        
+        const chunk = Math.floor(this.wasmModule._get_ir_upload_capacity() / channels) * channels;
+        for (let offset = 0; offset < samples.length; offset += chunk) {
+            const piece = samples.subarray(offset, Math.min(offset + chunk, samples.length));
+            const ptr = this.wasmModule._get_ir_upload_buffer();
+            this.wasmModule.HEAPF32.set(piece, ptr >> 2);
+            if (this.wasmModule._append_ir_samples(ptr, piece.length / channels) < 0) break;
+        }
+    }
+    
     setIRType(irType) {
+        this.irType = irType;
         if (!this.initialized) return;
         
+        // ccall passes the string on the WASM stack - no malloc export needed
+        if (this.wasmModule.ccall) {
+            this.wasmModule.ccall('set_ir_type', null, ['string'], [irType]);
+            return;
+        }
+        
         const bufferSize = (irType.length + 1) * 4; // Rough estimate
         const irTypePtr = this.wasmModule._malloc(bufferSize);
         
@@ -124,34 +324,67 @@ class ConvolutionReverbWorklet extends AudioWorkletProcessor {
         }
     }
     
-    process(inputs, outputs, parameters) {
-        const input = inputs[0];
-        const output = outputs[0];
+    // Same gain law as the main-thread ScriptProcessor fallback
+    applyAGC(block) {
+        const agc = this.agc;
         
-        // Skip if not initialized or no input
-        if (!this.initialized || !input || !input.length || !input[0]) {
-            // Pass through silence
-            if (output && output[0]) {
-                for (let channel = 0; channel < output.length; channel++) {
-                    output[channel].fill(0);
-                }
+        let sum = 0;
+        for (let i = 0; i < block.length; i++) {
+            sum += block[i] * block[i];
+        }
+        const rms = Math.sqrt(sum / block.length);
+        
+        let gain = 1.0;
+        if (rms > agc.silenceThreshold && rms < agc.target) {
+            gain = Math.min(agc.target / rms, agc.maxGain);
+        } else if (rms < agc.silenceThreshold) {
+            gain = agc.silenceGain;
+        }
+        
+        if (gain !== 1.0) {
+            for (let i = 0; i < block.length; i++) {
+                block[i] *= gain;
             }
-            return true;
         }
+    }
+    
+    // Move one engine block from the input ring through the engine into the output ring
+    processBlock() {
+        const numSamples = this.blockSize;
         
-        const inputChannel = input[0];
-        const numSamples = inputChannel.length;
+        if (this.useIOBuffers) {
+            const inputView = this.getIOViews(numSamples).input;
+            this.inputRing.pull(inputView);
+            if (this.agc) this.applyAGC(inputView);
+            
+            this.wasmModule._process_io_buffers(numSamples, 1);
+            
+            // Fetch the view after processing - the heap may have grown
+            this.outputRing.push(this.getIOViews(numSamples).output);
+            return;
+        }
+        
+        const block = this.blockScratch;
+        this.inputRing.pull(block);
+        if (this.agc) this.applyAGC(block);
         
         // Allocate buffers if needed
         this.allocateBuffers(numSamples);
         
+        if (this.useFloat32) {
+            this.wasmModule.HEAPF32.set(block, this.inputPtr >> 2);
+            this.wasmModule._process_audio_f32(this.inputPtr, this.outputPtr, numSamples);
+            
+            const outputOffset = this.outputPtr >> 2;
+            this.outputRing.push(this.wasmModule.HEAPF32.subarray(outputOffset, outputOffset + numSamples));
+            return;
+        }
+        
         // Convert Float32 to Float64 for WASM processing
-        const heap64 = this.wasmModule.HEAPF64;
         const inputOffset = this.inputPtr / 8;
-        
-        // Copy input to WASM memory
+        let heap64 = this.wasmModule.HEAPF64;
         for (let i = 0; i < numSamples; i++) {
-            heap64[inputOffset + i] = inputChannel[i];
+            heap64[inputOffset + i] = block[i];
         }
         
         // Process audio
@@ -159,10 +392,92 @@ class ConvolutionReverbWorklet extends AudioWorkletProcessor {
         
         // Copy output from WASM memory
         const outputOffset = this.outputPtr / 8;
+        heap64 = this.wasmModule.HEAPF64;
+        for (let i = 0; i < numSamples; i++) {
+            block[i] = heap64[outputOffset + i];
+        }
+        this.outputRing.push(block);
+    }
+    
+    // Frames buffered between input and output is the latency actually added;
+    // posted when it changes, at most every LATENCY_REPORT_QUANTA quanta
+    reportLatency() {
+        this.quantaSinceReport++;
+        if (this.reportedLatency >= 0 && this.quantaSinceReport < LATENCY_REPORT_QUANTA) return;
+        
+        const frames = this.inputRing.availableRead() + this.outputRing.availableRead();
+        if (frames !== this.reportedLatency) {
+            this.reportedLatency = frames;
+            this.quantaSinceReport = 0;
+            this.port.postMessage({
+                type: 'latency',
+                frames: frames,
+                blockSize: this.blockSize,
+                underruns: this.underruns
+            });
+        }
+    }
+    
+    // Worker mode: the Worker consumes the input ring in whole blocks and
+    // refills the output ring; a late Worker shows up as an underrun here
+    processWithWorker(inputChannel, output) {
+        this.inputRing.push(inputChannel);
+        this.inputRing.notify();
+        
         const outputChannel = output[0];
+        const pulled = this.outputRing.pull(outputChannel);
+        if (pulled < outputChannel.length) {
+            outputChannel.fill(0, pulled);
+            this.underruns++;
+        }
         
-        for (let i = 0; i < numSamples; i++) {
-            outputChannel[i] = heap64[outputOffset + i];
+        for (let channel = 1; channel < output.length; channel++) {
+            output[channel].set(outputChannel);
+        }
+        
+        this.reportLatency();
+        return true;
+    }
+    
+    process(inputs, outputs, parameters) {
+        const input = inputs[0];
+        const output = outputs[0];
+        
+        if (this.workerMode && input && input.length && input[0] && output && output[0]) {
+            return this.processWithWorker(input[0], output);
+        }
+        
+        // Asynchronous start-up: one engine slice per quantum, silence out
+        if (this.initialized && this.preparing) {
+            const progress = this.wasmModule._continue_init();
+            if (progress < 0 || progress >= 100) {
+                this.preparing = false;
+                this.port.postMessage({ type: 'prepared' });
+            }
+        }
+        
+        // Skip if not initialized, still preparing or no input
+        if (!this.initialized || this.preparing || !input || !input.length || !input[0]) {
+            // Pass through silence
+            if (output && output[0]) {
+                for (let channel = 0; channel < output.length; channel++) {
+                    output[channel].fill(0);
+                }
+            }
+            return true;
+        }
+        
+        this.inputRing.push(input[0]);
+        
+        while (this.inputRing.availableRead() >= this.blockSize) {
+            this.processBlock();
+        }
+        
+        const outputChannel = output[0];
+        const pulled = this.outputRing.pull(outputChannel);
+        if (pulled < outputChannel.length) {
+            outputChannel.fill(0, pulled);
+            this.underruns++;
         }
         
         // Handle stereo output by copying to all channels
@@ -170,8 +485,9 @@ class ConvolutionReverbWorklet extends AudioWorkletProcessor {
             output[channel].set(outputChannel);
         }
         
+        this.reportLatency();
         return true;
     }
 }
 
-registerProcessor('convolution-reverb-worklet', ConvolutionReverbWorklet);
\ No newline at end of file
+registerProcessor('convolution-reverb-worklet', ConvolutionReverbWorklet);
@@ -0,0 +1,145 @@
+// sab-ring-buffer.js - Lock-free single-producer/single-consumer Float32 ring
+// backed by a SharedArrayBuffer, usable from the main thread, AudioWorklets and Workers
+
+// Header: read and write indices, stored with Atomics so producer and
+// consumer may live on different threads, and a sequence counter the
+// producer bumps to wake a consumer blocked in wait()
+const RING_READ_INDEX = 0;
+const RING_WRITE_INDEX = 1;
+const RING_SEQUENCE = 2;
+const RING_HEADER_INTS = 3;
+const RING_HEADER_BYTES = RING_HEADER_INTS * 4;
+
+class SABRingBuffer {
+    // Bytes needed for a ring holding capacity samples (one slot stays empty
+    // to tell a full ring from an empty one)
+    static bytesFor(capacity) {
+        return RING_HEADER_BYTES + (capacity + 1) * 4;
+    }
+
+    // Shared when the page is cross-origin isolated, a plain ArrayBuffer
+    // otherwise (Atomics.load/store work on both)
+    static create(capacity) {
+        const Storage = typeof SharedArrayBuffer !== 'undefined' ? SharedArrayBuffer : ArrayBuffer;
+        return new SABRingBuffer(new Storage(SABRingBuffer.bytesFor(capacity)));
+    }
+
+    // Wrap an existing buffer, e.g. one received through postMessage
+    constructor(buffer) {
+        this.buffer = buffer;
+        this.state = new Int32Array(buffer, 0, RING_HEADER_INTS);
+        this.data = new Float32Array(buffer, RING_HEADER_BYTES);
+        this.size = this.data.length;
+        this.capacity = this.size - 1;
+    }
+
+    get isShared() {
+        return typeof SharedArrayBuffer !== 'undefined' && this.buffer instanceof SharedArrayBuffer;
+    }
+
+    availableRead() {
+        const read = Atomics.load(this.state, RING_READ_INDEX);
+        const write = Atomics.load(this.state, RING_WRITE_INDEX);
+        return (write - read + this.size) % this.size;
+    }
+
+    availableWrite() {
+        return this.capacity - this.availableRead();
+    }
+
+    // Producer side: copy up to source.length samples in, returns the count written
+    push(source) {
+        const read = Atomics.load(this.state, RING_READ_INDEX);
+        const write = Atomics.load(this.state, RING_WRITE_INDEX);
+        const free = this.capacity - (write - read + this.size) % this.size;
+        const count = Math.min(source.length, free);
+        if (count === 0) return 0;
+
+        // At most two bulk copies: up to the end of the storage, then from the start
+        const first = Math.min(count, this.size - write);
+        this.data.set(source.subarray(0, first), write);
+        if (count > first) {
+            this.data.set(source.subarray(first, count), 0);
+        }
+
+        Atomics.store(this.state, RING_WRITE_INDEX, (write + count) % this.size);
+        return count;
+    }
+
+    // Producer side: append count zeros (used to prime a fixed latency)
+    pushSilence(count) {
+        const read = Atomics.load(this.state, RING_READ_INDEX);
+        const write = Atomics.load(this.state, RING_WRITE_INDEX);
+        const free = this.capacity - (write - read + this.size) % this.size;
+        count = Math.min(count, free);
+        if (count === 0) return 0;
+
+        const first = Math.min(count, this.size - write);
+        this.data.fill(0, write, write + first);
+        if (count > first) {
+            this.data.fill(0, 0, count - first);
+        }
+
+        Atomics.store(this.state, RING_WRITE_INDEX, (write + count) % this.size);
+        return count;
+    }
+
+    // Consumer side: fill up to target.length samples, returns the count read
+    pull(target) {
+        const read = Atomics.load(this.state, RING_READ_INDEX);
+        const write = Atomics.load(this.state, RING_WRITE_INDEX);
+        const count = Math.min(target.length, (write - read + this.size) % this.size);
+        if (count === 0) return 0;
+
+        const first = Math.min(count, this.size - read);
+        target.set(this.data.subarray(read, read + first));
+        if (count > first) {
+            target.set(this.data.subarray(0, count - first), first);
+        }
+
+        Atomics.store(this.state, RING_READ_INDEX, (read + count) % this.size);
+        return count;
+    }
+
+    // Producer side: wake consumers waiting for data. Never blocks, so it is
+    // safe on the audio rendering thread
+    notify() {
+        Atomics.add(this.state, RING_SEQUENCE, 1);
+        Atomics.notify(this.state, RING_SEQUENCE);
+    }
+
+    // Consumer side: read the sequence before draining, then wait on it -
+    // a notify() in between makes the wait return at once
+    sequence() {
+        return Atomics.load(this.state, RING_SEQUENCE);
+    }
+
+    // Blocking wait for a notify() after seen (Workers only, shared rings only).
+    // Returns 'ok', 'not-equal' or 'timed-out'
+    wait(seen, timeoutMs) {
+        return Atomics.wait(this.state, RING_SEQUENCE, seen, timeoutMs);
+    }
+
+    // Non-blocking variant: { async: false, value } or { async: true, value: Promise },
+    // null where Atomics.waitAsync is not available
+    waitAsync(seen, timeoutMs) {
+        if (typeof Atomics.waitAsync !== 'function') return null;
+        return Atomics.waitAsync(this.state, RING_SEQUENCE, seen, timeoutMs);
+    }
+
+    // Drop everything buffered. Only safe while neither side is running
+    clear() {
+        Atomics.store(this.state, RING_READ_INDEX, 0);
+        Atomics.store(this.state, RING_WRITE_INDEX, 0);
+    }
+}
+
+// AudioWorklet modules share one global scope - make the class visible to the
+// processor modules loaded after this one
+if (typeof globalThis !== 'undefined') {
+    globalThis.SABRingBuffer = SABRingBuffer;
+}
+
+if (typeof module !== 'undefined' && module.exports) {
+    module.exports = SABRingBuffer;
+}
@@ -18,10 +18,54 @@ let animationId = null;
 // Audio processing nodes (global for cleanup)
 window.isProcessingLive = false;
 window.micSource = null;
+window.reverbWorklet = null;
+window.dspWorker = null;
 window.scriptProcessor = null;
 window.inputGain = null;
 window.outputGain = null;
 
+// Engine block size on the AudioWorklet path. The engine partitions at 128
+// samples, so 128 adds no latency; larger blocks mean fewer WASM calls
+const LIVE_BLOCK_SIZE = 128;
+
+// DSP worker mode (?dsp=worker, needs a cross-origin isolated page): the engine
+// runs in a dedicated Worker on large blocks, trading latency for robustness
+const DSP_WORKER_MODE = new URLSearchParams(window.location.search).get('dsp') === 'worker';
+const DSP_WORKER_BLOCK_SIZE = 2048;
+
+// Partition layouts measured on this machine ("wisdom"), persisted in IndexedDB
+// per engine version and handed to every engine instance. Re-tuning waits
+// until IR changes settle
+let partitionWisdom = null;
+let tuningTimer = null;
+const TUNING_DELAY_MS = 1500;
+
+// Generated IR with its partition spectra for the current settings, restored
+// from or saved to IndexedDB (keyed by engine version and settings hash)
+let irCache = null;
+
+// Recorded IR in use instead of the generated type ({ frames, sampleRate,
+// channels, chunks }), kept so a live engine started later gets it too
+let sampledIR = null;
+
+// IR warmer (?warm=1): a background Worker generates the other IR types at the
+// current settings while the page is idle, so switching types is a blob load
+// instead of a synthesis. Blobs are kept here by type and settings, oldest
+// dropped past the budget, and stored in IndexedDB like any other IR
+const IR_WARMER_MODE = new URLSearchParams(window.location.search).get('warm') === '1';
+const IR_WARM_BUDGET_BYTES = 24 * 1024 * 1024;
+let irWarmer = null;
+const warmedIRs = new Map();
+let warmedBytes = 0;
+
+// Live input AGC, shared by the worklet and the ScriptProcessor fallback
+const AGC_SETTINGS = {
+    target: 0.1,            // Target RMS level
+    silenceThreshold: 0.001,
+    maxGain: 100.0,         // INFINITE AGC - up to 100x gain!
+    silenceGain: 20.0       // AMPLIFY THE VOID - Even silence becomes reverb!
+};
+
 // Wait for DOM to load
 document.addEventListener('DOMContentLoaded', () => {
     console.log('DOM loaded - setting up UI');
@@ -38,6 +82,10 @@ function setupUI() {
     });
     document.getElementById('resetButton').addEventListener('click', resetParameters);
     document.getElementById('loadPreloadedButton').addEventListener('click', loadPreloadedAudio);
+    const loadIRButton = document.getElementById('loadIRButton');
+    if (loadIRButton) {
+        loadIRButton.addEventListener('click', loadPreloadedIR);
+    }
     
     // Setup file input
     document.getElementById('audioFileInput').addEventListener('change', handleFileSelect);
@@ -94,9 +142,15 @@ async function initializeAudio() {
         document.getElementById('sampleRate').textContent = audioContext.sampleRate;
         document.getElementById('engineType').textContent = 'WebAssembly Convolution Engine v2.0';
         
-        // Initialize processor
+        // Initialize processor: buffers, FFT plans and the IR for the current
+        // settings are ready when this resolves
+        const irSelect = document.getElementById('impulseResponse');
         processor = new ConvolutionProcessor();
-        await processor.initialize('./', audioContext.sampleRate);
+        await processor.initialize('./', audioContext.sampleRate, {
+            parameters: getLiveParameters(),
+            irType: irSelect ? irSelect.value : null,
+            onProgress: (percent) => updateStatus('loading', `Preparing reverb... ${percent}%`)
+        });
         console.log('Processor initialized');
         
         // Check version
@@ -109,9 +163,17 @@ async function initializeAudio() {
         // Apply current parameter values
         applyParametersToProcessor();
         
+        // Stored IR for these settings (else synthesized now), then the measured
+        // partition layout for the live block size (stored, or measured now)
+        await settleImpulseResponse(liveEngineBlockSize());
+        
         // Setup parameter controls for real-time updates
         setupParameterControls();
         
+        if (IR_WARMER_MODE) {
+            startIRWarmer();
+        }
+        
         isInitialized = true;
         return true;
     } catch (error) {
@@ -161,7 +223,6 @@ async function handleLiveInputClick() {
         window.micSource = audioContext.createMediaStreamSource(micStream);
         window.inputGain = audioContext.createGain();
         window.compressor = audioContext.createDynamicsCompressor();
-        window.scriptProcessor = audioContext.createScriptProcessor(2048, 1, 1);
         window.outputGain = audioContext.createGain();
         
         // Create analyser for visualization
@@ -180,82 +241,18 @@ async function handleLiveInputClick() {
         window.inputGain.gain.value = 20.0;  // ASTRONOMICAL input gain
         window.outputGain.gain.value = 3.0;  // TRIPLE output - MAXIMUM IMPACT!
         
-        // Process audio through reverb with AGC
-        let silenceCount = 0;
-        const silenceThreshold = 0.001;
-        const agcTarget = 0.1; // Target RMS level
-        
-        window.scriptProcessor.onaudioprocess = (e) => {
-            if (!processor || !window.isProcessingLive) return;
-            
-            const input = e.inputBuffer.getChannelData(0);
-            const output = e.outputBuffer.getChannelData(0);
-            
-            try {
-                // Calculate input RMS for AGC
-                let sum = 0;
-                for (let i = 0; i < input.length; i++) {
-                    sum += input[i] * input[i];
-                }
-                const rms = Math.sqrt(sum / input.length);
-                
-                // Apply AGC gain with SINGULARITY MODE
-                let agcGain = 1.0;
-                if (rms > silenceThreshold && rms < agcTarget) {
-                    agcGain = agcTarget / rms;
-                    // INFINITE AGC - up to 100x gain!
-                    agcGain = Math.min(agcGain, 100.0);
-                } else if (rms < silenceThreshold) {
-                    // AMPLIFY THE VOID - Even silence becomes reverb!
-                    agcGain = 20.0;
-                }
-                
-                // ADD HARMONIC EXCITEMENT
-                if (agcGain > 10) {
-                    // When boosting quiet signals, add some harmonics for richness
-                    console.log(`🌟 QUANTUM BOOST ENGAGED: ${agcGain.toFixed(1)}x 🌟`);
-                }
-                
-                // Apply gain to input
-                const boostedInput = new Float32Array(input.length);
-                for (let i = 0; i < input.length; i++) {
-                    boostedInput[i] = input[i] * agcGain;
-                }
-                
-                // Process through the reverb engine
-                const processed = processor.processAudio(boostedInput);
-                
-                // Copy processed audio to output
-                for (let i = 0; i < output.length && i < processed.length; i++) {
-                    output[i] = processed[i];
-                }
-                
-                // Debug logging every 100 blocks
-                if (++silenceCount % 100 === 0) {
-                    console.log(`Input RMS: ${rms.toFixed(4)}, AGC Gain: ${agcGain.toFixed(1)}x`);
-                }
-            } catch (error) {
-                console.error('Processing error:', error);
-                // On error, pass through dry signal
-                output.set(input);
-            }
-        };
+        // AudioWorklet by default; ScriptProcessor only where worklets are unavailable
+        const reverbNode = await createWorkletReverbNode() || createScriptProcessorReverbNode();
         
         // Connect the audio graph:
-        // Mic -> Input Gain -> Compressor -> Script Processor -> Output Gain -> Analyser -> Speakers
+        // Mic -> Input Gain -> Compressor -> Reverb (worklet) -> Output Gain -> Analyser -> Speakers
         window.micSource.connect(window.inputGain);
         window.inputGain.connect(window.compressor);
-        window.compressor.connect(window.scriptProcessor);
-        window.scriptProcessor.connect(window.outputGain);
+        window.compressor.connect(reverbNode);
+        reverbNode.connect(window.outputGain);
         window.outputGain.connect(analyser);
         analyser.connect(audioContext.destination);
         
-        // Update technical details
-        const bufferSize = window.scriptProcessor.bufferSize;
-        const latencyMs = (bufferSize / audioContext.sampleRate) * 1000;
-        document.getElementById('processingType').textContent = 'ScriptProcessor (2048 samples)';
-        document.getElementById('latency').textContent = latencyMs.toFixed(1);
-        
         // Start visualization
         startLiveVisualization();
         
@@ -281,6 +278,403 @@ async function handleLiveInputClick() {
     }
 }
 
+// Live reverb on the audio rendering thread. The worklet hosts its own engine
+// instance; returns null when AudioWorklet is unsupported or fails to start
+async function createWorkletReverbNode() {
+    if (!audioContext.audioWorklet || typeof AudioWorkletNode === 'undefined') {
+        console.warn('AudioWorklet not supported - using ScriptProcessor fallback');
+        return null;
+    }
+    
+    try {
+        await audioContext.audioWorklet.addModule('sab-ring-buffer.js');
+        await audioContext.audioWorklet.addModule('convolution-worklet.js');
+        
+        const useDspWorker = DSP_WORKER_MODE && window.crossOriginIsolated;
+        if (DSP_WORKER_MODE && !useDspWorker) {
+            console.warn('DSP worker mode needs cross-origin isolation - running the engine in the worklet');
+        }
+        
+        const node = new AudioWorkletNode(audioContext, 'convolution-reverb-worklet', {
+            numberOfInputs: 1,
+            numberOfOutputs: 1,
+            outputChannelCount: [1],
+            processorOptions: useDspWorker
+                ? { blockSize: DSP_WORKER_BLOCK_SIZE, dspWorker: true }
+                : { blockSize: LIVE_BLOCK_SIZE, agc: AGC_SETTINGS }
+        });
+        
+        const ready = new Promise((resolve, reject) => {
+            node.port.onmessage = (event) => {
+                const message = event.data;
+                if (message.type === 'initialized') {
+                    resolve(message);
+                } else if (message.type === 'rings') {
+                    startDspWorker(message).then(resolve, reject);
+                } else if (message.type === 'error') {
+                    reject(new Error(message.error));
+                } else if (message.type === 'latency') {
+                    showWorkletLatency(message);
+                } else if (message.type === 'prepared') {
+                    console.log('🎛️ AudioWorklet engine prepared - reverb live');
+                }
+            };
+        });
+        
+        if (!useDspWorker) {
+            // Same parameters as the main-thread engine before the first block
+            getLiveParameters().forEach(({ param, value }) => {
+                node.port.postMessage({ type: 'setParameter', param, value });
+            });
+            const irSelect = document.getElementById('impulseResponse');
+            if (irSelect) {
+                node.port.postMessage({ type: 'setIRType', irType: irSelect.value });
+            }
+            
+            const sources = await ConvolutionProcessor.fetchEngineSources('./');
+            node.port.postMessage({ type: 'init', ...sources, wisdom: partitionWisdom, irCache: irCache },
+                                  [sources.wasmBinary]);
+        }
+        
+        const info = await ready;
+        console.log(`🎛️ AudioWorklet reverb ready: ${info.blockSize}-frame engine blocks` +
+                    (useDspWorker ? ' in the DSP worker' : ''));
+        
+        document.getElementById('processingType').textContent = useDspWorker
+            ? `AudioWorklet + DSP Worker (${info.blockSize}-sample blocks)`
+            : `AudioWorklet (${info.blockSize}-sample engine blocks)`;
+        showWorkletLatency({ frames: info.latencyFrames, underruns: 0 });
+        
+        window.reverbWorklet = node;
+        replaySampledIR();
+        return node;
+    } catch (error) {
+        console.error('AudioWorklet setup failed - using ScriptProcessor fallback:', error);
+        stopDspWorker();
+        return null;
+    }
+}
+
+// Start the Worker that hosts the engine in DSP worker mode, handing it the
+// rings the worklet created. Resolves once its engine is ready
+function startDspWorker(rings) {
+    return new Promise((resolve, reject) => {
+        const worker = new Worker('convolution-dsp-worker.js');
+        window.dspWorker = worker;
+        
+        worker.onmessage = (event) => {
+            const message = event.data;
+            if (message.type === 'initialized') {
+                // Ring priming: one block to collect input, one of slack
+                resolve({ blockSize: message.blockSize, latencyFrames: 2 * message.blockSize });
+            } else if (message.type === 'error') {
+                reject(new Error(message.error));
+            }
+        };
+        worker.onerror = (event) => reject(new Error(event.message));
+        
+        const irSelect = document.getElementById('impulseResponse');
+        worker.postMessage({
+            type: 'init',
+            inputRing: rings.inputRing,
+            outputRing: rings.outputRing,
+            blockSize: rings.blockSize,
+            sampleRate: audioContext.sampleRate,
+            wasmPath: './',
+            parameters: getLiveParameters(),
+            irType: irSelect ? irSelect.value : null,
+            wisdom: partitionWisdom,
+            irCache: irCache,
+            agc: AGC_SETTINGS
+        });
+    });
+}
+
+function stopDspWorker() {
+    if (window.dspWorker) {
+        window.dspWorker.postMessage({ type: 'stop' });
+        window.dspWorker.terminate();
+        window.dspWorker = null;
+    }
+}
+
+// Parameter and IR changes go to whichever thread hosts the live engine
+function postToLiveEngine(message) {
+    if (window.dspWorker) {
+        window.dspWorker.postMessage(message);
+    } else if (window.reverbWorklet) {
+        window.reverbWorklet.port.postMessage(message);
+    }
+}
+
+// Samples per engine call on the live path that will be used
+function liveEngineBlockSize() {
+    const workletPath = audioContext.audioWorklet && typeof AudioWorkletNode !== 'undefined';
+    if (!workletPath) return 2048;   // ScriptProcessor fallback
+    return DSP_WORKER_MODE && window.crossOriginIsolated ? DSP_WORKER_BLOCK_SIZE : LIVE_BLOCK_SIZE;
+}
+
+// Pick the partition layout for the current IR on the main-thread engine: the
+// persisted wisdom when it covers this IR length and block size, otherwise a
+// one-off measurement (blocks this thread briefly). New wisdom is stored and
+// passed on to the live engine
+async function tunePartitionLayout(blockSize) {
+    if (!processor || !processor.initialized || !processor.calibratePartitions) return;
+    
+    const storeKey = `partition-wisdom-${processor.getVersion()}`;
+    if (!partitionWisdom) {
+        const stored = await ConvolutionProcessor.loadStoredWisdom(storeKey);
+        if (stored && processor.importWisdom(stored) >= 0) {
+            partitionWisdom = stored;
+        }
+    }
+    
+    const known = processor.exportWisdom();
+    const tailBlock = processor.calibratePartitions(blockSize);
+    const wisdom = processor.exportWisdom();
+    if (!wisdom || (known && wisdom.length === known.length && wisdom.every((b, i) => b === known[i]))) {
+        return;
+    }
+    
+    console.log(`🧠 Partition layout for ${blockSize}-sample calls: ` +
+                (tailBlock > 0 ? `two-stage, ${tailBlock}-sample tail partitions` : 'uniform partitions'));
+    partitionWisdom = wisdom;
+    await ConvolutionProcessor.storeWisdom(storeKey, wisdom);
+    postToLiveEngine({ type: 'loadWisdom', wisdom: wisdom });
+    if (irWarmer) {
+        irWarmer.postMessage({ type: 'loadWisdom', wisdom: wisdom });
+    }
+}
+
+// IR changes may move the IR into another length class - tune once they settle
+function scheduleTuning() {
+    clearTimeout(tuningTimer);
+    tuningTimer = setTimeout(() => settleImpulseResponse(liveEngineBlockSize()), TUNING_DELAY_MS);
+}
+
+// Settings the IR was saved for before are restored without synthesis or
+// FFTs; new ones are generated, tuned and saved for next time
+async function settleImpulseResponse(blockSize) {
+    const restored = await restoreIRCache();
+    await tunePartitionLayout(blockSize);
+    if (!restored) {
+        await saveIRCache();
+    }
+    scheduleWarming();
+}
+
+// IndexedDB key of the stored IR with engine cache key, by default the one
+// for the current settings; null when there is none
+function irCacheStoreKey(key = processor.getIRCacheKey ? processor.getIRCacheKey() : null) {
+    return key === null ? null : `ir-cache-${processor.getVersion()}-${key.toString(16)}`;
+}
+
+// Load the stored IR for the current settings into this thread's engine and
+// the live one. Returns false when there is none (or a recording is in use)
+async function restoreIRCache() {
+    if (!processor || !processor.initialized || sampledIR) return false;
+    const storeKey = irCacheStoreKey();
+    if (!storeKey) return false;
+    
+    const stored = await ConvolutionProcessor.loadStoredIRCache(storeKey);
+    // Settings may have moved on while IndexedDB answered
+    if (!stored || sampledIR || irCacheStoreKey() !== storeKey || !processor.importIRCache(stored)) {
+        return false;
+    }
+    
+    console.log(`💾 Restored precomputed IR (${(stored.length / (1024 * 1024)).toFixed(2)} MB)`);
+    irCache = stored;
+    postToLiveEngine({ type: 'loadIRCache', cache: stored });
+    return true;
+}
+
+async function saveIRCache() {
+    if (!processor || !processor.initialized || sampledIR) return;
+    const storeKey = irCacheStoreKey();
+    const blob = storeKey ? processor.exportIRCache() : null;
+    if (!blob) return;
+    
+    irCache = blob;
+    await ConvolutionProcessor.storeIRCache(storeKey, blob);
+}
+
+// Start the IR warmer Worker; it hosts its own engine at the live block size
+function startIRWarmer() {
+    if (irWarmer || typeof Worker === 'undefined') return;
+    
+    irWarmer = new Worker('convolution-warm-worker.js');
+    irWarmer.onmessage = (event) => {
+        const message = event.data;
+        if (message.type === 'initialized') {
+            console.log('🔥 IR warmer ready');
+            scheduleWarming();
+        } else if (message.type === 'warmed') {
+            rememberWarmedIR(message);
+        } else if (message.type === 'error') {
+            console.error('IR warmer error:', message.error);
+            irWarmer.terminate();
+            irWarmer = null;
+        }
+    };
+    irWarmer.postMessage({
+        type: 'init',
+        sampleRate: audioContext.sampleRate,
+        wasmPath: './',
+        blockSize: liveEngineBlockSize(),
+        wisdom: partitionWisdom
+    });
+}
+
+// What a warmed IR was generated from, as its lookup key
+function warmedIRKey(irType, settings) {
+    return `${irType}|${settings}`;
+}
+
+function currentSettings() {
+    return JSON.stringify(getLiveParameters());
+}
+
+// Queue every IR type but the current one at the current settings, the
+// neighbours of the selection in the menu first. Replaces the queue the
+// warmer is working on, so stale settings are dropped
+function scheduleWarming() {
+    const irSelect = document.getElementById('impulseResponse');
+    if (!irWarmer || !irSelect) return;
+    
+    const settings = currentSettings();
+    const types = Array.from(irSelect.options, option => option.value);
+    const current = types.indexOf(irSelect.value);
+    const irTypes = [];
+    for (let distance = 1; distance < types.length; distance++) {
+        [current + distance, current - distance].forEach(index => {
+            if (index >= 0 && index < types.length && !irTypes.includes(types[index]) &&
+                !warmedIRs.has(warmedIRKey(types[index], settings))) {
+                irTypes.push(types[index]);
+            }
+        });
+    }
+    if (irTypes.length === 0) return;
+    
+    const post = () => irWarmer && irWarmer.postMessage({
+        type: 'warm',
+        parameters: getLiveParameters(),
+        settings: settings,
+        irTypes: irTypes
+    });
+    if (typeof requestIdleCallback === 'function') {
+        requestIdleCallback(post, { timeout: 2000 });
+    } else {
+        setTimeout(post, 0);
+    }
+}
+
+// Keep a warmed IR within the memory budget and store it for later sessions
+function rememberWarmedIR(message) {
+    const blob = message.cache;
+    if (!blob || blob.length > IR_WARM_BUDGET_BYTES) return;
+    
+    const key = warmedIRKey(message.irType, message.settings);
+    if (warmedIRs.has(key)) {
+        warmedBytes -= warmedIRs.get(key).length;
+        warmedIRs.delete(key);
+    }
+    warmedIRs.set(key, blob);
+    warmedBytes += blob.length;
+    while (warmedBytes > IR_WARM_BUDGET_BYTES) {
+        const [oldest, dropped] = warmedIRs.entries().next().value;
+        warmedIRs.delete(oldest);
+        warmedBytes -= dropped.length;
+    }
+    
+    console.log(`🔥 Warmed ${message.irType} IR (${(blob.length / (1024 * 1024)).toFixed(2)} MB, ` +
+                `${(warmedBytes / (1024 * 1024)).toFixed(1)} MB held)`);
+    if (processor && processor.getVersion) {
+        ConvolutionProcessor.storeIRCache(irCacheStoreKey(message.key), blob);
+    }
+}
+
+// Added latency as measured by the worklet (frames buffered in its rings)
+function showWorkletLatency(report) {
+    const latencyMs = (report.frames / audioContext.sampleRate) * 1000;
+    document.getElementById('latency').textContent = latencyMs.toFixed(1);
+    if (report.underruns > 0) {
+        console.warn(`AudioWorklet underruns: ${report.underruns}`);
+    }
+}
+
+// Fallback: main-thread processing with a 2048-sample ScriptProcessor
+function createScriptProcessorReverbNode() {
+    window.scriptProcessor = audioContext.createScriptProcessor(2048, 1, 1);
+    
+    // The main-thread engine now serves the live path - use its block size's layout
+    processor.setParameter('hostBlockSize', window.scriptProcessor.bufferSize);
+    
+    // Process audio through reverb with AGC
+    let silenceCount = 0;
+    
+    window.scriptProcessor.onaudioprocess = (e) => {
+        if (!processor || !window.isProcessingLive) return;
+        
+        const input = e.inputBuffer.getChannelData(0);
+        const output = e.outputBuffer.getChannelData(0);
+        
+        try {
+            // Calculate input RMS for AGC
+            let sum = 0;
+            for (let i = 0; i < input.length; i++) {
+                sum += input[i] * input[i];
+            }
+            const rms = Math.sqrt(sum / input.length);
+            
+            // Apply AGC gain with SINGULARITY MODE
+            let agcGain = 1.0;
+            if (rms > AGC_SETTINGS.silenceThreshold && rms < AGC_SETTINGS.target) {
+                agcGain = Math.min(AGC_SETTINGS.target / rms, AGC_SETTINGS.maxGain);
+            } else if (rms < AGC_SETTINGS.silenceThreshold) {
+                agcGain = AGC_SETTINGS.silenceGain;
+            }
+            
+            // ADD HARMONIC EXCITEMENT
+            if (agcGain > 10) {
+                // When boosting quiet signals, add some harmonics for richness
+                console.log(`🌟 QUANTUM BOOST ENGAGED: ${agcGain.toFixed(1)}x 🌟`);
+            }
+            
+            // Gain, process and write straight into the output buffer -
+            // nothing is allocated per callback
+            if (!processor.processInto(input, output, agcGain)) {
+                output.set(input);
+            }
+            
+            // Debug logging every 100 blocks
+            if (++silenceCount % 100 === 0) {
+                console.log(`Input RMS: ${rms.toFixed(4)}, AGC Gain: ${agcGain.toFixed(1)}x`);
+            }
+        } catch (error) {
+            console.error('Processing error:', error);
+            // On error, pass through dry signal
+            output.set(input);
+        }
+    };
+    
+    // Update technical details
+    const bufferSize = window.scriptProcessor.bufferSize;
+    const latencyMs = (bufferSize / audioContext.sampleRate) * 1000;
+    document.getElementById('processingType').textContent = 'ScriptProcessor (2048 samples)';
+    document.getElementById('latency').textContent = latencyMs.toFixed(1);
+    
+    return window.scriptProcessor;
+}
+
+// Current slider values as {param, value} pairs
+function getLiveParameters() {
+    const params = ['roomSize', 'decayTime', 'preDelay', 'damping', 'lowFreq', 'diffusion', 'mix', 'earlyReflections'];
+    return params
+        .map(param => ({ param, element: document.getElementById(param) }))
+        .filter(({ element }) => element)
+        .map(({ param, element }) => ({ param, value: parseFloat(element.value) }));
+}
+
 // Stop live input
 function stopLiveInput() {
     console.log('Stopping live input...');
@@ -300,6 +694,14 @@ function stopLiveInput() {
         window.outputGain = null;
     }
     
+    if (window.reverbWorklet) {
+        window.reverbWorklet.port.onmessage = null;
+        window.reverbWorklet.disconnect();
+        window.reverbWorklet = null;
+    }
+    
+    stopDspWorker();
+    
     if (window.scriptProcessor) {
         window.scriptProcessor.disconnect();
         window.scriptProcessor.onaudioprocess = null;
@@ -372,6 +774,9 @@ function setupParameterControls() {
                     console.log(`UI: Setting ${param} to ${val}`);
                     processor.setParameter(param, val);
                 }
+                postToLiveEngine({ type: 'setParameter', param, value: val });
+                // Every slider feeds the IR or its partition layout
+                scheduleTuning();
             });
         }
     });
@@ -380,9 +785,19 @@ function setupParameterControls() {
     if (irSelect) {
         irSelect.addEventListener('change', (e) => {
             console.log(`UI: Setting IR type to ${e.target.value}`);
+            sampledIR = null;
+            // A warmed IR is staged in both engines and taken by the switch
+            const warmed = warmedIRs.get(warmedIRKey(e.target.value, currentSettings()));
             if (processor && processor.initialized) {
+                if (warmed) processor.importIRCache(warmed);
                 processor.setImpulseResponseType(e.target.value);
             }
+            if (warmed) {
+                irCache = warmed;
+                postToLiveEngine({ type: 'loadIRCache', cache: warmed });
+            }
+            postToLiveEngine({ type: 'setIRType', irType: e.target.value });
+            scheduleTuning();
         });
     }
 }
@@ -450,22 +865,21 @@ async function processAudioFile() {
         
         // Process in chunks
         const chunkSize = 4096;
-        const output = new Float32Array(totalSamples);
+        const maxTailSamples = currentBuffer.sampleRate * 15;
+        
+        // One buffer for the whole render, with room for the longest tail;
+        // chunks are processed in place through subarray views
+        const rendered = new Float32Array(totalSamples + maxTailSamples + chunkSize);
         
         // Process some silence first to prime the reverb
         const silence = new Float32Array(chunkSize);
-        processor.processAudio(silence);
+        processor.processInto(silence, rendered.subarray(0, chunkSize));
         
         for (let i = 0; i < totalSamples; i += chunkSize) {
             const end = Math.min(i + chunkSize, totalSamples);
-            const chunk = input.slice(i, end);
-            
-            // Process this chunk
-            const processedChunk = processor.processAudio(chunk);
             
-            // Copy to output
-            for (let j = 0; j < processedChunk.length && i + j < totalSamples; j++) {
-                output[i + j] = processedChunk[j];
+            if (!processor.processInto(input.subarray(i, end), rendered.subarray(i, end))) {
+                rendered.set(input.subarray(i, end), i);
             }
             
             // Update progress occasionally
@@ -475,6 +889,21 @@ async function processAudioFile() {
             }
         }
         
+        // Let the reverb ring out - the engine reports how much tail is left
+        let tailLength = 0;
+        while (processor.getTailSamples() > 0 && tailLength < maxTailSamples) {
+            const offset = totalSamples + tailLength;
+            if (!processor.processInto(silence, rendered.subarray(offset, offset + chunkSize))) {
+                break;
+            }
+            tailLength += chunkSize;
+        }
+        
+        if (tailLength > 0) {
+            console.log(`Rendered ${tailLength} samples of reverb tail`);
+        }
+        const output = rendered.subarray(0, totalSamples + tailLength);
+        
         console.log('Processing complete, creating output buffer...');
         
         // Create output buffer
@@ -574,7 +1003,12 @@ function resetParameters() {
         if (processor && processor.initialized) {
             processor.setImpulseResponseType('hall');
         }
+        if (sampledIR) {
+            sampledIR = null;
+            postToLiveEngine({ type: 'setIRType', irType: 'hall' });
+        }
     }
+    scheduleTuning();
 }
 
 // Load list of preloaded audio files
@@ -599,6 +1033,10 @@ async function loadAudioList() {
             // Enable/disable load button based on selection
             select.addEventListener('change', (e) => {
                 document.getElementById('loadPreloadedButton').disabled = !e.target.value;
+                const loadIRButton = document.getElementById('loadIRButton');
+                if (loadIRButton) {
+                    loadIRButton.disabled = !e.target.value;
+                }
             });
             
             console.log(`Loaded ${files.length} preloaded audio files`);
@@ -643,6 +1081,97 @@ async function loadPreloadedAudio() {
     }
 }
 
+// Use the selected preloaded file as the reverb's IR. PCM and float WAV files
+// stream into the engines while they download, so the reverb is heard before
+// the whole file is in; other formats are decoded first
+async function loadPreloadedIR() {
+    const select = document.getElementById('preloadedSelect');
+    const filename = select.value;
+    if (!filename) return;
+    
+    // Initialize audio if needed
+    if (!isInitialized) {
+        const success = await initializeAudio();
+        if (!success) return;
+    }
+    
+    const upload = { frames: 0, sampleRate: 0, channels: 0, chunks: [] };
+    sampledIR = upload;
+    const sink = {
+        begin: (frames, sampleRate, channels) => {
+            Object.assign(upload, { frames, sampleRate, channels });
+            if (processor && processor.initialized) {
+                processor.beginImpulseResponse(frames, sampleRate, channels);
+            }
+            postToLiveEngine({ type: 'beginIR', frames, sampleRate, channels });
+        },
+        append: (samples) => {
+            // Another IR was picked meanwhile - stop downloading this one
+            if (sampledIR !== upload) throw new Error('IR load superseded');
+            upload.chunks.push(samples);
+            if (processor && processor.initialized) {
+                processor.appendImpulseResponse(samples);
+            }
+            postToLiveEngine({ type: 'appendIR', samples });
+        }
+    };
+    
+    try {
+        updateStatus('loading', `Loading IR ${filename}...`);
+        try {
+            await ConvolutionProcessor.streamImpulseResponse(`/audio/${filename}`, sink);
+        } catch (error) {
+            if (upload.frames > 0) throw error;
+            console.warn(`Streaming ${filename} failed (${error.message}) - decoding it instead`);
+            
+            const response = await fetch(`/audio/${filename}`);
+            if (!response.ok) throw new Error('Failed to load IR file');
+            const buffer = await audioContext.decodeAudioData(await response.arrayBuffer());
+            uploadDecodedIR(buffer, sink);
+        }
+        
+        updateStatus('ready', `IR: ${filename}`);
+        scheduleTuning();
+    } catch (error) {
+        if (sampledIR !== upload) return;
+        console.error('Error loading IR:', error);
+        updateStatus('error', 'Error loading IR file');
+    }
+}
+
+// Feed a decoded AudioBuffer to an IR sink in interleaved chunks
+function uploadDecodedIR(buffer, sink) {
+    const channels = buffer.numberOfChannels;
+    const channelData = [];
+    for (let c = 0; c < channels; c++) {
+        channelData.push(buffer.getChannelData(c));
+    }
+    
+    sink.begin(buffer.length, buffer.sampleRate, channels);
+    const chunkFrames = 4096;
+    for (let start = 0; start < buffer.length; start += chunkFrames) {
+        const count = Math.min(chunkFrames, buffer.length - start);
+        const samples = new Float32Array(count * channels);
+        for (let c = 0; c < channels; c++) {
+            for (let f = 0; f < count; f++) {
+                samples[f * channels + c] = channelData[c][start + f];
+            }
+        }
+        sink.append(samples);
+    }
+}
+
+// Hand the recorded IR to a live engine that started after it was loaded
+function replaySampledIR() {
+    if (!sampledIR || !sampledIR.frames) return;
+    
+    const { frames, sampleRate, channels } = sampledIR;
+    postToLiveEngine({ type: 'beginIR', frames, sampleRate, channels });
+    sampledIR.chunks.forEach((samples) => {
+        postToLiveEngine({ type: 'appendIR', samples });
+    });
+}
+
 // Update status
 function updateStatus(type, message) {
     const status = document.getElementById('status');